@@ -0,0 +1,60 @@
+#version 330 core
+// One level of Graphics::DepthPyramid: min and max window depth. The source is read at its base level, which the
+// pyramid points at the level below the one being written.
+uniform sampler2D source;
+// A multisampled depth copy, on a unit of its own since samplers of different types cannot share one.
+uniform sampler2DMS sourceSamples;
+// Depth textures hold one value that is both the minimum and the maximum.
+uniform bool depthSource;
+// Folds every sample of sourceSamples, so the pyramid stays conservative whichever sample a resolve would keep.
+uniform bool multisampledSource;
+uniform int sampleCount;
+// Where the region being reduced starts in the source; a depth copy keeps the viewport's offset.
+uniform ivec2 sourceOrigin;
+// Folds 2x2 texels, and the leftover row or column of an odd source into the last texel; otherwise copies.
+uniform bool halve;
+
+out vec2 minMax;
+
+vec2 Fetch(ivec2 texel) {
+    texel += sourceOrigin;
+    if (multisampledSource) {
+        vec2 result = vec2(1.0, 0.0);
+        for (int i = 0; i < sampleCount; i++) {
+            float depth = texelFetch(sourceSamples, texel, i).r;
+            result = vec2(min(result.x, depth), max(result.y, depth));
+        }
+        return result;
+    }
+    vec4 value = texelFetch(source, texel, 0);
+    return depthSource ? value.rr : value.rg;
+}
+
+ivec2 SourceSize() {
+    return (multisampledSource ? textureSize(sourceSamples) : textureSize(source, 0)) - sourceOrigin;
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    if (!halve) {
+        minMax = Fetch(texel);
+        return;
+    }
+
+    ivec2 sourceSize = SourceSize();
+    ivec2 size = max(sourceSize / 2, ivec2(1));
+    ivec2 first = texel * 2;
+    ivec2 last = min(first + 1, sourceSize - 1);
+    if (texel.x == size.x - 1)
+        last.x = sourceSize.x - 1;
+    if (texel.y == size.y - 1)
+        last.y = sourceSize.y - 1;
+    vec2 result = vec2(1.0, 0.0);
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            vec2 value = Fetch(ivec2(x, y));
+            result = vec2(min(result.x, value.x), max(result.y, value.y));
+        }
+    }
+    minMax = result;
+}
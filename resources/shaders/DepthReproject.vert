@@ -0,0 +1,20 @@
+#version 330 core
+// Draws every texel of a captured depth level as a quad at its farthest depth, moved to the current camera.
+// Texels where nothing was drawn, and the cracks between quads that part, stay at the far plane and hide nothing.
+uniform sampler2D source;
+// Current view-projection times the inverse of the captured one.
+uniform mat4 reprojection;
+
+void main() {
+    ivec2 size = textureSize(source, 0);
+    ivec2 texel = ivec2(gl_InstanceID % size.x, gl_InstanceID / size.x);
+    float depth = texelFetch(source, texel, 0).g;
+    if (depth >= 1.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    ivec2 corner = ivec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 position = vec2(texel + corner) / vec2(size);
+    gl_Position = reprojection * vec4(vec3(position, depth) * 2.0 - 1.0, 1.0);
+}
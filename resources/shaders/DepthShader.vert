@@ -1,10 +1,11 @@
 #version 420 core
-layout (location = 0) in vec3 aPos;
+#include "include/PackedVertex.glsl"
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool perDrawModel = false;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    gl_Position = lightSpaceMatrix * (perDrawModel ? inDrawModel : model) * vec4(DecodePosition(), 1.0);
+}
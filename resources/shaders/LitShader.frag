@@ -1,10 +1,20 @@
 #version 420 core
+#if MATERIAL_TEXTURES == 2
+#extension GL_ARB_bindless_texture : require
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_NV_gpu_shader5 : require
+#endif
 
 in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+#if SHADOWS
     vec4 FragPosLightSpace;
+#endif
+#if MATERIAL_TEXTURES
+    flat uint MaterialIndex;
+#endif
 } fs_in;
 
 struct Material {
@@ -16,7 +26,6 @@ struct Material {
 
     //    sampler2D diffuse;
     //    sampler2D specular;
-    float shininess;
 };
 
 struct PointLight {
@@ -54,15 +63,41 @@ struct SpotLight {
     vec3 specular;
 };
 
-#define MAX_POINT_LIGHTS 128
-uniform int pointLightCount = 0;
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform DirectionalLight dirLight;
-uniform SpotLight spotLight;
+// Mirrored by the blocks in Graphics/UniformBlocks.hpp.
+layout (std140, binding = 1) uniform Frame {
+    vec3 cameraPos;
+    DirectionalLight dirLight;
+    SpotLight spotLight;
+};
+
+#if POINT_LIGHT_COUNT > 0
+layout (std140, binding = 2) uniform Lights {
+    PointLight pointLights[POINT_LIGHT_COUNT];
+};
+#endif
+
+#if MATERIAL_TEXTURES
+#include "include/MaterialTextures.glsl"
+
+float shininess;
+
+vec4 MaterialDiffuse(vec2 uv) {
+    return MaterialDiffuse(fs_in.MaterialIndex, uv);
+}
+#else
+layout (std140, binding = 3) uniform MaterialParameters {
+    float shininess;
+};
 
 uniform Material material;
+
+vec4 MaterialDiffuse(vec2 uv) {
+    return texture(material.texture_diffuse1, uv);
+}
+#endif
+#if SHADOWS
 uniform sampler2D shadowMap;
-uniform vec3 cameraPos;
+#endif
 
 out vec4 FragOutColor;
 
@@ -72,9 +107,9 @@ vec4 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shado
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
 
-    vec4 texelAlpha = texture(material.texture_diffuse1, fs_in.TexCoords);
+    vec4 texelAlpha = MaterialDiffuse(fs_in.TexCoords);
     vec3 texelNoAlpha = texelAlpha.rgb;
 
     vec3 ambient = light.ambient * texelNoAlpha;
@@ -83,19 +118,20 @@ vec4 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shado
     return vec4(ambient + (1.0 - shadow) * (diffuse + specular), texelAlpha.a);
 }
 
+#if POINT_LIGHT_COUNT > 0
 vec4 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(light.position - fragPos);
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
 
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
     //    float attenuation = 1.0 / distance;
 
-    vec4 texelAlpha = texture(material.texture_diffuse1, fs_in.TexCoords);
+    vec4 texelAlpha = MaterialDiffuse(fs_in.TexCoords);
     vec3 texelNoAlpha = texelAlpha.rgb;
 
     vec3 ambient = light.ambient * texelNoAlpha;
@@ -109,6 +145,9 @@ vec4 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, f
     return vec4(ambient + (1.0 - shadow) * (diffuse + specular), texelAlpha.a);
 }
 
+#endif
+
+#if SPOT_LIGHT
 vec4 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(light.position - fragPos);
@@ -116,7 +155,7 @@ vec4 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, flo
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
 
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
@@ -126,7 +165,7 @@ vec4 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, flo
     float epsilon = light.cutOff - light.outerCutOff;
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
 
-    vec4 texelAlpha = texture(material.texture_diffuse1, fs_in.TexCoords);
+    vec4 texelAlpha = MaterialDiffuse(fs_in.TexCoords);
     vec3 texelNoAlpha = texelAlpha.rgb;
 
     vec3 ambient = light.ambient * texelNoAlpha;
@@ -139,7 +178,9 @@ vec4 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, flo
 
     return vec4(ambient + (1.0 - shadow) * (diffuse + specular), texelAlpha.a);
 }
+#endif
 
+#if SHADOWS
 float ShadowCalculation(vec4 fragPosLightSpace, DirectionalLight dirLight, vec3 normal)
 {
     // perform perspective divide
@@ -173,29 +214,39 @@ float ShadowCalculation(vec4 fragPosLightSpace, DirectionalLight dirLight, vec3
 
     return shadow;
 }
+#endif
 
 void main() {
-    vec4 texColor = texture(material.texture_diffuse1, fs_in.TexCoords);
+#if MATERIAL_TEXTURES
+    shininess = MaterialShininess(fs_in.MaterialIndex);
+#endif
+#if ALPHA_TEST
+    vec4 texColor = MaterialDiffuse(fs_in.TexCoords);
     if (texColor.a < 0.1) {
         discard;
     }
+#endif
 
     vec4 fragOutput = vec4(0);
     vec3 norm = normalize(fs_in.Normal);
     vec3 viewDir = normalize(cameraPos - fs_in.FragPos);
 
+#if SHADOWS
     float shadow = ShadowCalculation(fs_in.FragPosLightSpace, dirLight, fs_in.Normal);
+#else
+    float shadow = 0.0;
+#endif
 
     fragOutput += CalcDirLight(dirLight, fs_in.Normal, viewDir, shadow);
-    if (pointLightCount > 0) {
-        for (int i = 0; i < pointLightCount; i++) {
-            fragOutput += CalcPointLight(pointLights[i], fs_in.Normal, fs_in.FragPos, viewDir, shadow);
-        }
+#if POINT_LIGHT_COUNT > 0
+    for (int i = 0; i < POINT_LIGHT_COUNT; i++) {
+        fragOutput += CalcPointLight(pointLights[i], fs_in.Normal, fs_in.FragPos, viewDir, shadow);
     }
+#endif
 
-    if (length(spotLight.direction) > 0) {
-        fragOutput += CalcSpotLight(spotLight, fs_in.Normal, fs_in.FragPos, viewDir, shadow);
-    }
+#if SPOT_LIGHT
+    fragOutput += CalcSpotLight(spotLight, fs_in.Normal, fs_in.FragPos, viewDir, shadow);
+#endif
 
     float gamma = 2.2;
     FragOutColor.rgb = pow(fragOutput.rgb, vec3(1.0 / gamma));
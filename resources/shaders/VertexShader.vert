@@ -1,27 +1,47 @@
 #version 420 core
-layout (location = 0) in vec3 inPos;
-layout (location = 1) in vec2 inTexCoords;
-layout (location = 2) in vec3 inNormal;
+#include "include/PackedVertex.glsl"
 
 layout (std140, binding = 0) uniform Matrices {
     mat4 view;
     mat4 projection;
 };
 
+#if !INSTANCED
 uniform mat4 model;
+// Set while a model draws indirectly; the transform then comes from the per-draw record.
+uniform bool perDrawModel = false;
+#endif
+#if SHADOWS
 uniform mat4 lightSpaceMatrix;
+#endif
 
 out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+#if SHADOWS
     vec4 FragPosLightSpace;
+#endif
+#if MATERIAL_TEXTURES
+    flat uint MaterialIndex;
+#endif
 } vs_out;
 
 void main() {
-    gl_Position = projection * view * model * vec4(inPos, 1.0);
-    vs_out.FragPos = vec3(model * vec4(inPos, 1.0));
-    vs_out.Normal = normalize(mat3(transpose(inverse(model))) * inNormal);
+#if INSTANCED
+    mat4 world = inDrawModel;
+#else
+    mat4 world = perDrawModel ? inDrawModel : model;
+#endif
+    vec3 position = DecodePosition();
+    gl_Position = projection * view * world * vec4(position, 1.0);
+    vs_out.FragPos = vec3(world * vec4(position, 1.0));
+    vs_out.Normal = normalize(mat3(transpose(inverse(world))) * DecodeNormal());
     vs_out.TexCoords = inTexCoords;
+#if MATERIAL_TEXTURES
+    vs_out.MaterialIndex = inDrawMaterial;
+#endif
+#if SHADOWS
     vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
-}
\ No newline at end of file
+#endif
+}
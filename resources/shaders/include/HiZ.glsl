@@ -0,0 +1,44 @@
+// Occlusion test against Graphics::DepthPyramid, whose texels hold the min and max window depth below them.
+uniform sampler2D hiZ;
+uniform mat4 hiZViewProjection;
+uniform int hiZLevels;
+uniform bool hiZEnabled;
+
+// Whether any part of an object-space box may show past the depth in the pyramid. The box's screen rectangle is
+// read at the level where it spans at most 2x2 texels and compared with its nearest corner; boxes crossing the near
+// plane count as visible.
+bool HiZVisible(vec3 boundsMin, vec3 boundsMax, mat4 model) {
+    if (!hiZEnabled)
+        return true;
+
+    mat4 matrix = hiZViewProjection * model;
+    vec2 screenMin = vec2(1.0);
+    vec2 screenMax = vec2(0.0);
+    float nearest = 1.0;
+    for (int corner = 0; corner < 8; corner++) {
+        vec3 point = mix(boundsMin, boundsMax, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+        vec4 clip = matrix * vec4(point, 1.0);
+        if (clip.w <= 0.0 || clip.z < -clip.w)
+            return true;
+        vec3 window = clip.xyz / clip.w * 0.5 + 0.5;
+        screenMin = min(screenMin, window.xy);
+        screenMax = max(screenMax, window.xy);
+        nearest = min(nearest, window.z);
+    }
+
+    // Only the part on screen can show.
+    ivec2 size = textureSize(hiZ, 0);
+    ivec2 first = min(ivec2(clamp(screenMin, 0.0, 1.0) * vec2(size)), size - 1);
+    ivec2 last = min(ivec2(clamp(screenMax, 0.0, 1.0) * vec2(size)), size - 1);
+    int level = 0;
+    while (level + 1 < hiZLevels && any(greaterThan((last >> level) - (first >> level), ivec2(1))))
+        level++;
+
+    // The last texel of each level also covers the leftover of an odd level below.
+    ivec2 levelLast = max(size >> level, ivec2(1)) - 1;
+    ivec2 a = min(first >> level, levelLast);
+    ivec2 b = min(last >> level, levelLast);
+    float farthest = max(max(texelFetch(hiZ, a, level).g, texelFetch(hiZ, ivec2(b.x, a.y), level).g),
+                         max(texelFetch(hiZ, ivec2(a.x, b.y), level).g, texelFetch(hiZ, b, level).g));
+    return nearest <= farthest;
+}
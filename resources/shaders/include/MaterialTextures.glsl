@@ -0,0 +1,43 @@
+// Material lookup by the per-draw material index (see Graphics/MaterialTable.hpp). Each entry is the diffuse
+// texture in xy, as a bindless handle or as array << 16 | layer, and the shininess bits in z.
+#if MATERIAL_TEXTURES == 2
+layout (std430, binding = 0) readonly buffer MaterialTable {
+    uvec4 materialEntries[];
+};
+#else
+layout (std140, binding = 4) uniform MaterialTable {
+    uvec4 materialEntries[256];
+};
+
+uniform sampler2DArray materialArrays[6];
+#endif
+
+const uint NoMaterialTexture = 0xFFFFFFFFu;
+
+float MaterialShininess(uint index) {
+    return uintBitsToFloat(materialEntries[index].z);
+}
+
+vec4 MaterialDiffuse(uint index, vec2 uv) {
+    uvec4 entry = materialEntries[index];
+#if MATERIAL_TEXTURES == 2
+    if (entry.x == 0u && entry.y == 0u)
+        return vec4(1.0);
+    // The handle differs between the draws of a multi-draw; NV_gpu_shader5 makes that defined, and
+    // Graphics::MaterialTable only picks this mode where the driver has it.
+    return texture(sampler2D(entry.xy), uv);
+#else
+    if (entry.x == NoMaterialTexture)
+        return vec4(1.0);
+    // Sampler arrays take only dynamically uniform indices, which a multi-draw's material index is not.
+    vec3 coords = vec3(uv, float(entry.x & 0xFFFFu));
+    switch (entry.x >> 16) {
+        case 0u: return texture(materialArrays[0], coords);
+        case 1u: return texture(materialArrays[1], coords);
+        case 2u: return texture(materialArrays[2], coords);
+        case 3u: return texture(materialArrays[3], coords);
+        case 4u: return texture(materialArrays[4], coords);
+        default: return texture(materialArrays[5], coords);
+    }
+#endif
+}
@@ -0,0 +1,22 @@
+layout (location = 0) in vec4 inPos;
+layout (location = 1) in vec2 inTexCoords;
+layout (location = 2) in vec3 inNormal;
+// The per-draw record of an indirect draw, or the per-instance matrix of an instanced one.
+layout (location = 3) in mat4 inDrawModel;
+layout (location = 8) in vec3 inBoundsMin;
+layout (location = 9) in vec3 inBoundsExtent;
+layout (location = 10) in uint inDrawMaterial;
+
+// Packed meshes store w = 0, positions as unorm16 inside the bounds and octahedral normals.
+vec3 DecodePosition() {
+    return inPos.w == 0.0 ? inBoundsMin + inPos.xyz * inBoundsExtent : inPos.xyz;
+}
+
+vec3 DecodeNormal() {
+    if (inPos.w != 0.0)
+        return inNormal;
+    vec3 n = vec3(inNormal.xy, 1.0 - abs(inNormal.x) - abs(inNormal.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
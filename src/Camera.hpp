@@ -20,6 +20,8 @@ const float SENSITIVITY = 0.1f;
 
 class Camera {
 public:
+	static constexpr float FieldOfView = 45.0f;
+
 	glm::vec3 Position{};
 	glm::vec3 Front;
 	glm::vec3 Up{};
@@ -61,7 +63,7 @@ public:
 
 	[[nodiscard]] static glm::mat4 GetProjectionMatrix() {
 		return glm::perspective(
-			glm::radians(45.0f),
+			glm::radians(FieldOfView),
 			(float)16 / 9,
 			0.1f,
 			5000.0f
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <limits>
+
+namespace Core {
+    // Axis-aligned box; the default is empty, so Grow from it yields the box of what was added.
+    struct Bounds {
+        glm::vec3 Min{std::numeric_limits<float>::max()};
+        glm::vec3 Max{std::numeric_limits<float>::lowest()};
+
+        [[nodiscard]] bool Empty() const {
+            return Min.x > Max.x;
+        }
+
+        [[nodiscard]] glm::vec3 Center() const {
+            return (Min + Max) * 0.5f;
+        }
+
+        [[nodiscard]] glm::vec3 Extent() const {
+            return (Max - Min) * 0.5f;
+        }
+
+        [[nodiscard]] float SurfaceArea() const {
+            if (Empty())
+                return 0.0f;
+            const auto size = Max - Min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        void Grow(glm::vec3 point) {
+            Min = glm::min(Min, point);
+            Max = glm::max(Max, point);
+        }
+
+        void Grow(const Bounds &other) {
+            Min = glm::min(Min, other.Min);
+            Max = glm::max(Max, other.Max);
+        }
+
+        [[nodiscard]] bool Overlaps(const Bounds &other) const {
+            return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::lessThanEqual(other.Min, Max));
+        }
+
+        bool operator==(const Bounds &) const = default;
+
+        // The box around this one after an affine transform, from the transformed center and the extent projected
+        // onto each axis through the absolute matrix.
+        [[nodiscard]] Bounds Transformed(const glm::mat4 &matrix) const {
+            const auto center = glm::vec3(matrix * glm::vec4(Center(), 1.0f));
+            const auto linear = glm::mat3(matrix);
+            const auto absolute = glm::mat3(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+            const auto extent = absolute * Extent();
+            return {center - extent, center + extent};
+        }
+    };
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Frustum.hpp"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Core {
+    struct CullStats {
+        std::uint64_t Visible{};
+        std::uint64_t Culled{};
+
+        CullStats &operator+=(const CullStats &other) {
+            Visible += other.Visible;
+            Culled += other.Culled;
+            return *this;
+        }
+    };
+
+    // Axis-aligned boxes stored as centers and half extents in structure-of-arrays form, so frustum tests run
+    // eight boxes per iteration with AVX and four with SSE2. Storage is padded to whole batches with boxes that
+    // are never reported, so batches never read past the end.
+    class BoundsSet {
+    public:
+        static constexpr std::size_t BatchSize = 8;
+
+        void Clear() {
+            for (auto *lane: Lanes())
+                lane->clear();
+            _size = 0;
+        }
+
+        void Add(glm::vec3 boundsMin, glm::vec3 boundsMax) {
+            const auto center = (boundsMin + boundsMax) * 0.5f;
+            const auto extent = (boundsMax - boundsMin) * 0.5f;
+            if (_size % BatchSize == 0) {
+                for (auto *lane: Lanes())
+                    lane->resize(_size + BatchSize, 0.0f);
+            }
+            _centerX[_size] = center.x;
+            _centerY[_size] = center.y;
+            _centerZ[_size] = center.z;
+            _extentX[_size] = extent.x;
+            _extentY[_size] = extent.y;
+            _extentZ[_size] = extent.z;
+            _size++;
+        }
+
+        [[nodiscard]] std::size_t Size() const {
+            return _size;
+        }
+
+        // Writes 1 for every box at least partly inside the frustum and 0 for the rest. A box is outside when its
+        // center lies further behind a plane than its projected radius along that plane's normal, which is the
+        // nearest-corner test without the per-axis selects.
+        CullStats Cull(const Frustum &frustum, std::vector<std::uint8_t> &visible) const {
+            visible.resize(_size);
+            for (std::size_t first = 0; first < _size; first += BatchSize) {
+                const auto mask = CullBatch(frustum, first);
+                const auto count = std::min(BatchSize, _size - first);
+                for (std::size_t i = 0; i < count; i++)
+                    visible[first + i] = static_cast<std::uint8_t>(mask >> i & 1u);
+            }
+
+            CullStats stats;
+            for (const auto flag: visible)
+                stats.Visible += flag;
+            stats.Culled = _size - stats.Visible;
+            return stats;
+        }
+
+    private:
+        std::vector<float> _centerX, _centerY, _centerZ;
+        std::vector<float> _extentX, _extentY, _extentZ;
+        std::size_t _size{};
+
+        std::array<std::vector<float> *, 6> Lanes() {
+            return {&_centerX, &_centerY, &_centerZ, &_extentX, &_extentY, &_extentZ};
+        }
+
+        // Bit i is set when box first + i is visible.
+        [[nodiscard]] std::uint32_t CullBatch(const Frustum &frustum, std::size_t first) const {
+#if defined(__AVX__)
+            const auto cx = _mm256_loadu_ps(&_centerX[first]);
+            const auto cy = _mm256_loadu_ps(&_centerY[first]);
+            const auto cz = _mm256_loadu_ps(&_centerZ[first]);
+            const auto ex = _mm256_loadu_ps(&_extentX[first]);
+            const auto ey = _mm256_loadu_ps(&_extentY[first]);
+            const auto ez = _mm256_loadu_ps(&_extentZ[first]);
+            auto outside = _mm256_setzero_ps();
+            for (const auto &plane: frustum.Planes) {
+                const auto distance = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)),
+                                      _mm256_mul_ps(cy, _mm256_set1_ps(plane.y))),
+                        _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+                const auto radius = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(std::abs(plane.x))),
+                                      _mm256_mul_ps(ey, _mm256_set1_ps(std::abs(plane.y)))),
+                        _mm256_mul_ps(ez, _mm256_set1_ps(std::abs(plane.z))));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius),
+                                                              _mm256_setzero_ps(), _CMP_LT_OQ));
+            }
+            return ~static_cast<std::uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+#elif defined(__SSE2__) || defined(_M_X64)
+            std::uint32_t mask = 0;
+            for (std::size_t half = 0; half < BatchSize; half += 4) {
+                const auto at = first + half;
+                const auto cx = _mm_loadu_ps(&_centerX[at]);
+                const auto cy = _mm_loadu_ps(&_centerY[at]);
+                const auto cz = _mm_loadu_ps(&_centerZ[at]);
+                const auto ex = _mm_loadu_ps(&_extentX[at]);
+                const auto ey = _mm_loadu_ps(&_extentY[at]);
+                const auto ez = _mm_loadu_ps(&_extentZ[at]);
+                auto outside = _mm_setzero_ps();
+                for (const auto &plane: frustum.Planes) {
+                    const auto distance = _mm_add_ps(
+                            _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                            _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                    const auto radius = _mm_add_ps(
+                            _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::abs(plane.x))),
+                                       _mm_mul_ps(ey, _mm_set1_ps(std::abs(plane.y)))),
+                            _mm_mul_ps(ez, _mm_set1_ps(std::abs(plane.z))));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+                }
+                mask |= (~static_cast<std::uint32_t>(_mm_movemask_ps(outside)) & 0xFu) << half;
+            }
+            return mask;
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < BatchSize; i++) {
+                const auto at = first + i;
+                bool inside = true;
+                for (const auto &plane: frustum.Planes) {
+                    const float distance = plane.x * _centerX[at] + plane.y * _centerY[at] +
+                                           plane.z * _centerZ[at] + plane.w;
+                    const float radius = std::abs(plane.x) * _extentX[at] + std::abs(plane.y) * _extentY[at] +
+                                         std::abs(plane.z) * _extentZ[at];
+                    inside &= distance + radius >= 0.0f;
+                }
+                mask |= static_cast<std::uint32_t>(inside) << i;
+            }
+            return mask;
+#endif
+        }
+    };
+}
@@ -0,0 +1,401 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Core {
+    struct Ray {
+        glm::vec3 Origin{};
+        glm::vec3 Direction{0.0f, 0.0f, -1.0f};
+
+        // Through a point of the screen in normalized device coordinates, for picking.
+        static Ray FromScreen(const glm::mat4 &inverseViewProjection, glm::vec2 ndc) {
+            const auto nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+            const auto farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+            const auto origin = glm::vec3(nearPoint) / nearPoint.w;
+            return {origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin)};
+        }
+    };
+
+    // Bounding volume hierarchy over boxes the caller identifies by the id Add returns. Build splits by the
+    // surface area heuristic over binned centroids; Update only records moves, and Refit grows or shrinks the
+    // ancestors of moved boxes without changing the tree, which stays correct but loosens as objects travel far
+    // from where they were built. Call Build again after adding boxes or when Cost() has grown well past the cost
+    // right after the last build.
+    class Bvh {
+    public:
+        struct Hit {
+            std::uint32_t Proxy;
+            float Distance;
+        };
+
+        std::uint32_t Add(const Bounds &bounds) {
+            _proxies.push_back(bounds);
+            _leafOf.push_back(Invalid);
+            _built = false;
+            return static_cast<std::uint32_t>(_proxies.size() - 1);
+        }
+
+        void Update(std::uint32_t proxy, const Bounds &bounds) {
+            if (_proxies[proxy] == bounds)
+                return;
+            _proxies[proxy] = bounds;
+            if (_built)
+                _moved.push_back(proxy);
+        }
+
+        void Clear() {
+            _proxies.clear();
+            _leafOf.clear();
+            _nodes.clear();
+            _order.clear();
+            _moved.clear();
+            _built = false;
+        }
+
+        [[nodiscard]] std::size_t Size() const {
+            return _proxies.size();
+        }
+
+        [[nodiscard]] const Bounds &ProxyBounds(std::uint32_t proxy) const {
+            return _proxies[proxy];
+        }
+
+        // Brings the tree up to date: builds it if boxes were added since the last build, else refits the moved.
+        void Refit() {
+            if (!_built) {
+                Build();
+                return;
+            }
+            for (const auto proxy: _moved) {
+                auto index = _leafOf[proxy];
+                auto bounds = LeafBounds(_nodes[index]);
+                while (true) {
+                    auto &node = _nodes[index];
+                    if (node.Box == bounds)
+                        break;
+                    node.Box = bounds;
+                    if (node.Parent == Invalid)
+                        break;
+                    index = node.Parent;
+                    const auto &parent = _nodes[index];
+                    bounds = _nodes[parent.First].Box;
+                    bounds.Grow(_nodes[parent.First + 1].Box);
+                }
+            }
+            _moved.clear();
+        }
+
+        void Build() {
+            _nodes.clear();
+            _moved.clear();
+            _order.resize(_proxies.size());
+            for (std::uint32_t i = 0; i < _order.size(); i++)
+                _order[i] = i;
+            _built = true;
+            if (_proxies.empty())
+                return;
+
+            _nodes.push_back({{}, 0, static_cast<std::uint32_t>(_proxies.size()), Invalid});
+            std::vector<std::uint32_t> pending{0};
+            while (!pending.empty()) {
+                const auto index = pending.back();
+                pending.pop_back();
+                _nodes[index].Box = LeafBounds(_nodes[index]);
+                if (const auto split = Split(_nodes[index]); split != 0) {
+                    const auto children = static_cast<std::uint32_t>(_nodes.size());
+                    const auto first = _nodes[index].First;
+                    const auto count = _nodes[index].Count;
+                    _nodes.push_back({{}, first, split, index});
+                    _nodes.push_back({{}, first + split, count - split, index});
+                    _nodes[index].First = children;
+                    _nodes[index].Count = 0;
+                    pending.push_back(children);
+                    pending.push_back(children + 1);
+                    continue;
+                }
+                for (auto i = _nodes[index].First; i < _nodes[index].First + _nodes[index].Count; i++)
+                    _leafOf[_order[i]] = index;
+            }
+
+            // Children were pushed after their parent, so a reverse sweep sees every child before its parent.
+            for (auto index = _nodes.size(); index-- > 0;) {
+                auto &node = _nodes[index];
+                if (node.Count != 0)
+                    continue;
+                node.Box = _nodes[node.First].Box;
+                node.Box.Grow(_nodes[node.First + 1].Box);
+            }
+        }
+
+        // Expected cost of a random query relative to the root, by the surface area heuristic.
+        [[nodiscard]] float Cost() const {
+            if (_nodes.empty())
+                return 0.0f;
+            const auto rootArea = std::max(_nodes.front().Box.SurfaceArea(), std::numeric_limits<float>::min());
+            float cost = 0.0f;
+            for (const auto &node: _nodes)
+                cost += node.Box.SurfaceArea() / rootArea * (node.Count != 0 ? node.Count * IntersectCost : 1.0f);
+            return cost;
+        }
+
+        // Appends every proxy whose box is at least partly inside the frustum. Subtrees entirely inside are taken
+        // without testing their boxes.
+        void Query(const Frustum &frustum, std::vector<std::uint32_t> &proxies) const {
+            if (_nodes.empty())
+                return;
+            std::vector<std::uint32_t> stack{0};
+            while (!stack.empty()) {
+                const auto &node = _nodes[stack.back()];
+                stack.pop_back();
+                const auto side = Classify(frustum, node.Box);
+                if (side == Side::Outside)
+                    continue;
+                if (side == Side::Inside) {
+                    Collect(node, proxies);
+                    continue;
+                }
+                if (node.Count == 0) {
+                    stack.push_back(node.First);
+                    stack.push_back(node.First + 1);
+                    continue;
+                }
+                for (auto i = node.First; i < node.First + node.Count; i++) {
+                    if (Classify(frustum, _proxies[_order[i]]) != Side::Outside)
+                        proxies.push_back(_order[i]);
+                }
+            }
+        }
+
+        // Appends every proxy whose box overlaps bounds.
+        void Query(const Bounds &bounds, std::vector<std::uint32_t> &proxies) const {
+            if (_nodes.empty())
+                return;
+            std::vector<std::uint32_t> stack{0};
+            while (!stack.empty()) {
+                const auto &node = _nodes[stack.back()];
+                stack.pop_back();
+                if (!node.Box.Overlaps(bounds))
+                    continue;
+                if (node.Count == 0) {
+                    stack.push_back(node.First);
+                    stack.push_back(node.First + 1);
+                    continue;
+                }
+                for (auto i = node.First; i < node.First + node.Count; i++) {
+                    if (_proxies[_order[i]].Overlaps(bounds))
+                        proxies.push_back(_order[i]);
+                }
+            }
+        }
+
+        // Nearest proxy whose box the ray enters within maxDistance.
+        [[nodiscard]] std::optional<Hit> Raycast(const Ray &ray,
+                                                 float maxDistance = std::numeric_limits<float>::max()) const {
+            return Raycast(ray, maxDistance, [](std::uint32_t, float boxDistance) -> std::optional<float> {
+                return boxDistance;
+            });
+        }
+
+        // Nearest proxy for which intersect(proxy, boxDistance) returns a distance within maxDistance, for exact
+        // tests against the geometry inside a box. Children are visited nearest first, and boxes further than the
+        // closest hit so far are skipped.
+        template<typename Intersect>
+        [[nodiscard]] std::optional<Hit> Raycast(const Ray &ray, float maxDistance, Intersect intersect) const {
+            if (_nodes.empty())
+                return std::nullopt;
+            const auto inverse = 1.0f / ray.Direction;
+            std::optional<Hit> closest;
+            std::vector<std::uint32_t> stack{0};
+            while (!stack.empty()) {
+                const auto &node = _nodes[stack.back()];
+                stack.pop_back();
+                const auto entry = EntryDistance(ray, inverse, node.Box, maxDistance);
+                if (!entry)
+                    continue;
+                if (node.Count == 0) {
+                    const auto nearDistance = EntryDistance(ray, inverse, _nodes[node.First].Box, maxDistance);
+                    const auto farDistance = EntryDistance(ray, inverse, _nodes[node.First + 1].Box, maxDistance);
+                    const bool leftFirst = nearDistance.value_or(maxDistance) <= farDistance.value_or(maxDistance);
+                    stack.push_back(leftFirst ? node.First + 1 : node.First);
+                    stack.push_back(leftFirst ? node.First : node.First + 1);
+                    continue;
+                }
+                for (auto i = node.First; i < node.First + node.Count; i++) {
+                    const auto proxy = _order[i];
+                    const auto boxDistance = EntryDistance(ray, inverse, _proxies[proxy], maxDistance);
+                    if (!boxDistance)
+                        continue;
+                    if (const auto distance = intersect(proxy, *boxDistance); distance && *distance <= maxDistance) {
+                        maxDistance = *distance;
+                        closest = Hit{proxy, *distance};
+                    }
+                }
+            }
+            return closest;
+        }
+
+    private:
+        static constexpr std::uint32_t Invalid = ~0u;
+        static constexpr std::size_t BinCount = 16;
+        static constexpr std::uint32_t MaxLeafSize = 4;
+        // Box test cost relative to one traversal step.
+        static constexpr float IntersectCost = 1.0f;
+
+        enum class Side {
+            Outside,
+            Intersecting,
+            Inside
+        };
+
+        // Leaves hold Count proxies from _order[First]; interior nodes have Count 0 and children First, First + 1.
+        struct Node {
+            Bounds Box;
+            std::uint32_t First;
+            std::uint32_t Count;
+            std::uint32_t Parent;
+        };
+
+        std::vector<Bounds> _proxies;
+        std::vector<std::uint32_t> _leafOf;
+        std::vector<Node> _nodes;
+        std::vector<std::uint32_t> _order;
+        std::vector<std::uint32_t> _moved;
+        bool _built = false;
+
+        [[nodiscard]] Bounds LeafBounds(const Node &node) const {
+            if (node.Count == 0) {
+                auto bounds = _nodes[node.First].Box;
+                bounds.Grow(_nodes[node.First + 1].Box);
+                return bounds;
+            }
+            Bounds bounds;
+            for (auto i = node.First; i < node.First + node.Count; i++)
+                bounds.Grow(_proxies[_order[i]]);
+            return bounds;
+        }
+
+        // Partitions the node's proxies along the best binned plane and returns how many went left, or 0 when a
+        // leaf is cheaper than any split.
+        std::uint32_t Split(const Node &node) {
+            if (node.Count <= 1)
+                return 0;
+
+            Bounds centroids;
+            for (auto i = node.First; i < node.First + node.Count; i++)
+                centroids.Grow(_proxies[_order[i]].Center());
+            const auto size = centroids.Max - centroids.Min;
+            const int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+            if (size[axis] <= 0.0f)
+                return node.Count <= MaxLeafSize ? 0 : node.Count / 2;
+
+            struct Bin {
+                Bounds Box;
+                std::uint32_t Count{};
+            };
+            std::array<Bin, BinCount> bins{};
+            const float scale = BinCount / size[axis];
+            const auto binOf = [&](std::uint32_t proxy) {
+                const auto bin = static_cast<std::size_t>((_proxies[proxy].Center()[axis] - centroids.Min[axis]) * scale);
+                return std::min(bin, BinCount - 1);
+            };
+            for (auto i = node.First; i < node.First + node.Count; i++) {
+                auto &bin = bins[binOf(_order[i])];
+                bin.Box.Grow(_proxies[_order[i]]);
+                bin.Count++;
+            }
+
+            // Sweep from the right to know the cost of each right side, then from the left to pick the plane.
+            std::array<float, BinCount> rightCost{};
+            Bounds right;
+            std::uint32_t rightCount = 0;
+            for (auto i = BinCount - 1; i > 0; i--) {
+                right.Grow(bins[i].Box);
+                rightCount += bins[i].Count;
+                rightCost[i] = right.SurfaceArea() * static_cast<float>(rightCount);
+            }
+            Bounds left;
+            std::uint32_t leftCount = 0;
+            float bestCost = std::numeric_limits<float>::max();
+            std::size_t bestPlane = 0;
+            for (std::size_t i = 0; i + 1 < BinCount; i++) {
+                left.Grow(bins[i].Box);
+                leftCount += bins[i].Count;
+                if (leftCount == 0 || leftCount == node.Count)
+                    continue;
+                const auto cost = left.SurfaceArea() * static_cast<float>(leftCount) + rightCost[i + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestPlane = i + 1;
+                }
+            }
+
+            const auto leafCost = node.Box.SurfaceArea() * static_cast<float>(node.Count) * IntersectCost;
+            const auto splitCost = node.Box.SurfaceArea() + bestCost * IntersectCost;
+            if (bestPlane == 0)
+                return node.Count <= MaxLeafSize ? 0 : node.Count / 2;
+            if (node.Count <= MaxLeafSize && leafCost <= splitCost)
+                return 0;
+
+            const auto begin = _order.begin() + node.First;
+            const auto middle = std::partition(begin, begin + node.Count, [&](std::uint32_t proxy) {
+                return binOf(proxy) < bestPlane;
+            });
+            return static_cast<std::uint32_t>(middle - begin);
+        }
+
+        void Collect(const Node &root, std::vector<std::uint32_t> &proxies) const {
+            std::vector<const Node *> stack{&root};
+            while (!stack.empty()) {
+                const auto &node = *stack.back();
+                stack.pop_back();
+                if (node.Count == 0) {
+                    stack.push_back(&_nodes[node.First]);
+                    stack.push_back(&_nodes[node.First + 1]);
+                    continue;
+                }
+                for (auto i = node.First; i < node.First + node.Count; i++)
+                    proxies.push_back(_order[i]);
+            }
+        }
+
+        static Side Classify(const Frustum &frustum, const Bounds &bounds) {
+            const auto center = bounds.Center();
+            const auto extent = bounds.Extent();
+            auto side = Side::Inside;
+            for (const auto &plane: frustum.Planes) {
+                const auto normal = glm::vec3(plane);
+                const float distance = glm::dot(normal, center) + plane.w;
+                const float radius = glm::dot(glm::abs(normal), extent);
+                if (distance + radius < 0.0f)
+                    return Side::Outside;
+                if (distance - radius < 0.0f)
+                    side = Side::Intersecting;
+            }
+            return side;
+        }
+
+        // Slab test; the distance is 0 when the ray starts inside the box.
+        static std::optional<float> EntryDistance(const Ray &ray, glm::vec3 inverse, const Bounds &bounds,
+                                                  float maxDistance) {
+            const auto t0 = (bounds.Min - ray.Origin) * inverse;
+            const auto t1 = (bounds.Max - ray.Origin) * inverse;
+            const auto nearT = glm::min(t0, t1);
+            const auto farT = glm::max(t0, t1);
+            const float entry = std::max({nearT.x, nearT.y, nearT.z, 0.0f});
+            const float exit = std::min({farT.x, farT.y, farT.z, maxDistance});
+            if (entry > exit)
+                return std::nullopt;
+            return entry;
+        }
+    };
+}
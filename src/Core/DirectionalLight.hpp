@@ -2,6 +2,7 @@
 
 #include "Entity.hpp"
 #include "Light.hpp"
+#include "Graphics/UniformBlocks.hpp"
 #include "imgui.h"
 
 namespace Core {
@@ -27,6 +28,10 @@ namespace Core {
             Specular = props.Specular;
         }
 
+        [[nodiscard]] Graphics::DirectionalLightData Data() const {
+            return {Direction, Ambient, Diffuse, Specular};
+        }
+
         void UIRender() override {
             if (!ImGui::Begin("Light Settings")) {
                 ImGui::End();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Bounds.hpp"
 #include "glm/glm.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "Graphics/Shader.hpp"
@@ -12,6 +13,8 @@ namespace Core {
         glm::vec3 Rotation = glm::vec3(0, 0, 0);
         glm::vec3 Scale = glm::vec3(1, 1, 1);
         glm::mat4 Model = glm::mat4(1);
+        // Object-space box of what Render draws; the default fits the unit cube most entities are built from.
+        Bounds LocalBounds = {glm::vec3(-0.5f), glm::vec3(0.5f)};
 
     protected:
         explicit Entity(
@@ -32,6 +35,11 @@ namespace Core {
             Model = scale(Model, Scale);
         }
 
+        // As of the last Update.
+        [[nodiscard]] Bounds WorldBounds() const {
+            return LocalBounds.Transformed(Model);
+        }
+
         virtual void Render(Graphics::Shader &shader) {
         }
 
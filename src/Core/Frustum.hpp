@@ -0,0 +1,65 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <array>
+
+namespace Core {
+    // Six inward-facing planes (xyz normal, w distance), normalized so plane tests return true distances.
+    struct Frustum {
+        std::array<glm::vec4, 6> Planes{};
+
+        // Gribb-Hartmann extraction; the planes are in the space the matrix transforms from.
+        static Frustum FromMatrix(const glm::mat4 &matrix) {
+            const auto row0 = glm::vec4(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+            const auto row1 = glm::vec4(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+            const auto row2 = glm::vec4(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+            const auto row3 = glm::vec4(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+            Frustum frustum;
+            frustum.Planes = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+            frustum.Normalize();
+            return frustum;
+        }
+
+        // The same frustum expressed in the object space of a model matrix.
+        [[nodiscard]] Frustum Transformed(const glm::mat4 &model) const {
+            Frustum frustum;
+            const auto transposed = glm::transpose(model);
+            for (std::size_t i = 0; i < Planes.size(); i++)
+                frustum.Planes[i] = transposed * Planes[i];
+            frustum.Normalize();
+            return frustum;
+        }
+
+        [[nodiscard]] bool IntersectsSphere(glm::vec3 center, float radius) const {
+            for (const auto &plane: Planes) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                    return false;
+            }
+            return true;
+        }
+
+        // Tests the box corner furthest along each plane normal.
+        [[nodiscard]] bool IntersectsBox(glm::vec3 boundsMin, glm::vec3 boundsMax) const {
+            for (const auto &plane: Planes) {
+                const glm::vec3 corner(
+                        plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                        plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                        plane.z >= 0.0f ? boundsMax.z : boundsMin.z
+                );
+                if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        void Normalize() {
+            for (auto &plane: Planes) {
+                const float length = glm::length(glm::vec3(plane));
+                if (length > 0.0f)
+                    plane /= length;
+            }
+        }
+    };
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace Core::Hash {
+    constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+    constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+    constexpr std::uint64_t Fnv1a(std::string_view data, std::uint64_t hash = FnvOffsetBasis) {
+        for (const char c: data) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= FnvPrime;
+        }
+        return hash;
+    }
+
+    inline std::uint64_t Fnv1a(std::span<const std::byte> data, std::uint64_t hash = FnvOffsetBasis) {
+        for (const std::byte b: data) {
+            hash ^= static_cast<std::uint8_t>(b);
+            hash *= FnvPrime;
+        }
+        return hash;
+    }
+
+    constexpr std::uint64_t Combine(std::uint64_t seed, std::uint64_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
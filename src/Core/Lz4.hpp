@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+// LZ4 block format: sequences of a token, literals, a 16-bit offset and a match length. Blocks written here
+// decode with any LZ4 implementation; the compressor is a single-probe greedy one, tuned for pack build time.
+namespace Core::Lz4 {
+    namespace Detail {
+        constexpr std::size_t MinMatch = 4;
+        // The last match must start this far from the end and leave LastLiterals bytes as literals.
+        constexpr std::size_t MatchLimit = 12;
+        constexpr std::size_t LastLiterals = 5;
+        constexpr std::size_t MaxOffset = 65535;
+        constexpr int HashBits = 16;
+
+        inline std::uint32_t Read32(const std::byte *p) {
+            std::uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline std::uint32_t Hash(std::uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - HashBits);
+        }
+
+        inline void WriteLength(std::vector<std::byte> &out, std::size_t length) {
+            for (; length >= 255; length -= 255)
+                out.push_back(std::byte{255});
+            out.push_back(static_cast<std::byte>(length));
+        }
+
+        inline void WriteSequence(std::vector<std::byte> &out, std::span<const std::byte> literals,
+                                  std::size_t offset, std::size_t matchLength) {
+            const auto literalToken = std::min<std::size_t>(literals.size(), 15);
+            const auto matchToken = matchLength ? std::min<std::size_t>(matchLength - MinMatch, 15) : 0;
+            out.push_back(static_cast<std::byte>(literalToken << 4 | matchToken));
+            if (literals.size() >= 15)
+                WriteLength(out, literals.size() - 15);
+            out.insert(out.end(), literals.begin(), literals.end());
+            if (!matchLength)
+                return;
+            out.push_back(static_cast<std::byte>(offset & 0xff));
+            out.push_back(static_cast<std::byte>(offset >> 8));
+            if (matchLength - MinMatch >= 15)
+                WriteLength(out, matchLength - MinMatch - 15);
+        }
+    }
+
+    inline std::vector<std::byte> Compress(std::span<const std::byte> input) {
+        using namespace Detail;
+        std::vector<std::byte> out;
+        out.reserve(input.size() / 2 + 16);
+        std::vector<std::int64_t> table(std::size_t{1} << HashBits, -1);
+
+        const auto size = input.size();
+        const auto *data = input.data();
+        std::size_t anchor = 0;
+        std::size_t i = 0;
+        while (size > MatchLimit && i < size - MatchLimit) {
+            const auto sequence = Read32(data + i);
+            auto &slot = table[Hash(sequence)];
+            const auto candidate = slot;
+            slot = static_cast<std::int64_t>(i);
+            if (candidate < 0 || i - candidate > MaxOffset || Read32(data + candidate) != sequence) {
+                i++;
+                continue;
+            }
+
+            auto length = MinMatch;
+            while (i + length < size - LastLiterals && data[candidate + length] == data[i + length])
+                length++;
+            WriteSequence(out, input.subspan(anchor, i - anchor), i - candidate, length);
+            i += length;
+            anchor = i;
+        }
+        WriteSequence(out, input.subspan(anchor), 0, 0);
+        return out;
+    }
+
+    // output must be exactly the decompressed size; returns false on malformed or truncated input.
+    inline bool Decompress(std::span<const std::byte> input, std::span<std::byte> output) {
+        using namespace Detail;
+        std::size_t in = 0;
+        std::size_t out = 0;
+        const auto readLength = [&](std::size_t &length) {
+            std::uint8_t extra;
+            do {
+                if (in >= input.size())
+                    return false;
+                extra = static_cast<std::uint8_t>(input[in++]);
+                length += extra;
+            } while (extra == 255);
+            return true;
+        };
+
+        while (in < input.size()) {
+            const auto token = static_cast<std::uint8_t>(input[in++]);
+            std::size_t literals = token >> 4;
+            if (literals == 15 && !readLength(literals))
+                return false;
+            if (literals > input.size() - in || literals > output.size() - out)
+                return false;
+            std::memcpy(output.data() + out, input.data() + in, literals);
+            in += literals;
+            out += literals;
+            if (in == input.size())
+                break;
+
+            if (input.size() - in < 2)
+                return false;
+            const auto offset = static_cast<std::size_t>(input[in]) | static_cast<std::size_t>(input[in + 1]) << 8;
+            in += 2;
+            std::size_t length = (token & 15u) + MinMatch;
+            if ((token & 15u) == 15 && !readLength(length))
+                return false;
+            if (offset == 0 || offset > out || length > output.size() - out)
+                return false;
+            // Overlapping copies repeat the last offset bytes, so copy forward one byte at a time.
+            for (std::size_t k = 0; k < length; k++, out++)
+                output[out] = output[out - offset];
+        }
+        return out == output.size();
+    }
+}
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include "ThreadPool.hpp"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <span>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Core {
+    // Low-resolution depth of a few occluders, rasterized on the CPU to cull boxes before submission, in the spirit
+    // of masked occlusion culling. Each pixel keeps 1/w of the nearest occluder covering its center, which
+    // interpolates linearly in screen space and is 0 where nothing was drawn. Rasterization runs eight pixels per
+    // iteration with AVX and four with SSE2, in bands of rows spread over ThreadPool::Frame; a band is only ever
+    // written by one thread, so the result does not depend on the thread count. Needs no GL context.
+    class OcclusionBuffer {
+    public:
+        static constexpr int BandHeight = 8;
+        static constexpr int LaneCount = 8;
+
+        explicit OcclusionBuffer(int width = 320, int height = 180)
+                : _width(width), _height(height), _stride((width + LaneCount - 1) / LaneCount * LaneCount) {
+            _depth.assign(static_cast<std::size_t>(_stride) * static_cast<std::size_t>(_height), 0.0f);
+            _bins.resize(static_cast<std::size_t>((_height + BandHeight - 1) / BandHeight));
+        }
+
+        [[nodiscard]] int Width() const {
+            return _width;
+        }
+
+        [[nodiscard]] int Height() const {
+            return _height;
+        }
+
+        // Starts a frame seen through viewProjection, dropping the depth and occluders of the last one.
+        void Begin(const glm::mat4 &viewProjection) {
+            _viewProjection = viewProjection;
+            std::fill(_depth.begin(), _depth.end(), 0.0f);
+            _triangles.clear();
+            for (auto &bin: _bins)
+                bin.clear();
+        }
+
+        // Queues the triangles of an indexed mesh placed by model; Vertex needs a glm::vec3 Position. Both faces
+        // occlude, and parts in front of the near plane are clipped away.
+        template<typename Vertex>
+        void AddOccluder(std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+                         const glm::mat4 &model) {
+            const auto matrix = _viewProjection * model;
+            for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+                AddTriangle({
+                        matrix * glm::vec4(vertices[indices[i]].Position, 1.0f),
+                        matrix * glm::vec4(vertices[indices[i + 1]].Position, 1.0f),
+                        matrix * glm::vec4(vertices[indices[i + 2]].Position, 1.0f)
+                });
+            }
+        }
+
+        // Rasterizes the queued occluders; without a pool every band runs on the calling thread, which also takes a
+        // share of the bands otherwise. Must not be called from a worker of the pool.
+        void Rasterize(ThreadPool *pool = &ThreadPool::Frame()) {
+            const int bandCount = static_cast<int>(_bins.size());
+            const int jobCount = pool && _triangles.size() >= MinParallelTriangles
+                                 ? std::min(bandCount, static_cast<int>(pool->GetThreadCount()) + 1) : 1;
+            // Bands are interleaved so a crowded horizon is shared out rather than landing on one job.
+            const auto rasterizeJob = [this, bandCount, jobCount](int job) {
+                for (int band = job; band < bandCount; band += jobCount)
+                    RasterizeBand(band);
+            };
+
+            std::vector<std::future<void>> jobs;
+            jobs.reserve(static_cast<std::size_t>(jobCount));
+            for (int job = 1; job < jobCount; job++)
+                jobs.push_back(pool->Submit([rasterizeJob, job] { rasterizeJob(job); }));
+            rasterizeJob(0);
+            for (auto &job: jobs)
+                job.get();
+        }
+
+        // Whether any part of a world-space box may be seen past the occluders. Boxes crossing the near plane are
+        // always visible and boxes entirely off screen never are.
+        [[nodiscard]] bool IsVisible(const Bounds &bounds) const {
+            if (bounds.Empty())
+                return false;
+
+            glm::vec2 screenMin(std::numeric_limits<float>::max());
+            glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+            float nearest = 0.0f;
+            for (int corner = 0; corner < 8; corner++) {
+                const glm::vec3 point(corner & 1 ? bounds.Max.x : bounds.Min.x,
+                                      corner & 2 ? bounds.Max.y : bounds.Min.y,
+                                      corner & 4 ? bounds.Max.z : bounds.Min.z);
+                const auto clip = _viewProjection * glm::vec4(point, 1.0f);
+                if (clip.z < -clip.w || clip.w <= 0.0f)
+                    return true;
+                const auto screen = ToScreen(clip);
+                screenMin = glm::min(screenMin, glm::vec2(screen));
+                screenMax = glm::max(screenMax, glm::vec2(screen));
+                nearest = std::max(nearest, screen.z);
+            }
+
+            // Every pixel the box's screen rectangle touches, since the box may cover any part of them.
+            const int minX = std::max(0, static_cast<int>(std::floor(screenMin.x)));
+            const int minY = std::max(0, static_cast<int>(std::floor(screenMin.y)));
+            const int maxX = std::min(_width - 1, static_cast<int>(std::floor(screenMax.x)));
+            const int maxY = std::min(_height - 1, static_cast<int>(std::floor(screenMax.y)));
+            if (minX > maxX || minY > maxY)
+                return false;
+
+            for (int y = minY; y <= maxY; y++) {
+                const float *row = &_depth[static_cast<std::size_t>(y) * static_cast<std::size_t>(_stride)];
+                for (int x = minX / LaneCount * LaneCount; x <= maxX; x += LaneCount) {
+                    if (NotBehind(row + x, nearest) & LaneRange(x, minX, maxX))
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        // 1/w of the nearest occluder at a pixel, 0 where none was drawn; row 0 is the bottom of the screen.
+        [[nodiscard]] float Depth(int x, int y) const {
+            return _depth[static_cast<std::size_t>(y) * static_cast<std::size_t>(_stride) + static_cast<std::size_t>(x)];
+        }
+
+    private:
+        static constexpr std::size_t MinParallelTriangles = 256;
+
+        // Edge functions and the 1/w plane as a * x + b * y + c over pixel coordinates, and the pixels whose
+        // centers the triangle may cover.
+        struct Triangle {
+            std::array<glm::vec3, 3> Edges;
+            glm::vec3 Depth;
+            int MinX, MinY, MaxX, MaxY;
+        };
+
+        int _width;
+        int _height;
+        int _stride;
+        glm::mat4 _viewProjection{1.0f};
+        std::vector<float> _depth;
+        std::vector<Triangle> _triangles;
+        std::vector<std::vector<std::uint32_t>> _bins;
+
+        // Pixel coordinates and 1/w of a clip-space point in front of the camera.
+        [[nodiscard]] glm::vec3 ToScreen(glm::vec4 clip) const {
+            const float inverseW = 1.0f / clip.w;
+            return {(clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(_width),
+                    (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(_height),
+                    inverseW};
+        }
+
+        void AddTriangle(const std::array<glm::vec4, 3> &clip) {
+            // Sutherland-Hodgman against the near plane z = -w leaves at most four vertices.
+            std::array<glm::vec4, 4> polygon;
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < 3; i++) {
+                const auto &current = clip[i];
+                const auto &next = clip[(i + 1) % 3];
+                const float currentDistance = current.z + current.w;
+                const float nextDistance = next.z + next.w;
+                if (currentDistance >= 0.0f)
+                    polygon[count++] = current;
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                    polygon[count++] = glm::mix(current, next, currentDistance / (currentDistance - nextDistance));
+            }
+            for (std::size_t i = 2; i < count; i++) {
+                if (polygon[0].w > 0.0f && polygon[i - 1].w > 0.0f && polygon[i].w > 0.0f)
+                    SetupTriangle(ToScreen(polygon[0]), ToScreen(polygon[i - 1]), ToScreen(polygon[i]));
+            }
+        }
+
+        void SetupTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2) {
+            float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+            if (area == 0.0f || !std::isfinite(area))
+                return;
+            if (area < 0.0f) {
+                std::swap(v1, v2);
+                area = -area;
+            }
+
+            Triangle triangle{};
+            // Pixels whose centers x + 0.5 fall inside the triangle's bounds.
+            triangle.MinX = std::max(0, static_cast<int>(std::ceil(std::min({v0.x, v1.x, v2.x}) - 0.5f)));
+            triangle.MinY = std::max(0, static_cast<int>(std::ceil(std::min({v0.y, v1.y, v2.y}) - 0.5f)));
+            triangle.MaxX = std::min(_width - 1, static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}) - 0.5f)));
+            triangle.MaxY = std::min(_height - 1, static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}) - 0.5f)));
+            if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+                return;
+
+            // Counter-clockwise, so every edge function is non-negative inside.
+            const std::array<glm::vec3, 3> vertices = {v0, v1, v2};
+            for (std::size_t i = 0; i < 3; i++) {
+                const auto &from = vertices[i];
+                const auto &to = vertices[(i + 1) % 3];
+                const float a = from.y - to.y;
+                const float b = to.x - from.x;
+                triangle.Edges[i] = {a, b, -(a * from.x + b * from.y)};
+            }
+            const float depthX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+            const float depthY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+            triangle.Depth = {depthX, depthY, v0.z - depthX * v0.x - depthY * v0.y};
+
+            const auto index = static_cast<std::uint32_t>(_triangles.size());
+            _triangles.push_back(triangle);
+            for (int band = triangle.MinY / BandHeight; band <= triangle.MaxY / BandHeight; band++)
+                _bins[static_cast<std::size_t>(band)].push_back(index);
+        }
+
+        void RasterizeBand(int band) {
+            const int bandMinY = band * BandHeight;
+            const int bandMaxY = std::min(_height, bandMinY + BandHeight) - 1;
+            for (const auto index: _bins[static_cast<std::size_t>(band)]) {
+                const auto &triangle = _triangles[index];
+                const int minY = std::max(triangle.MinY, bandMinY);
+                const int maxY = std::min(triangle.MaxY, bandMaxY);
+                for (int y = minY; y <= maxY; y++) {
+                    float *row = &_depth[static_cast<std::size_t>(y) * static_cast<std::size_t>(_stride)];
+                    for (int x = triangle.MinX / LaneCount * LaneCount; x <= triangle.MaxX; x += LaneCount)
+                        RasterizeLanes(triangle, row + x, x, y);
+                }
+            }
+        }
+
+        // Pixels x to x + LaneCount - 1 of a row, keeping the nearer depth where the triangle covers the center.
+        static void RasterizeLanes(const Triangle &triangle, float *pixels, int x, int y) {
+            const float centerY = static_cast<float>(y) + 0.5f;
+#if defined(__AVX__)
+            const auto centerX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x) + 0.5f),
+                                               _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+            auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto &edge: triangle.Edges) {
+                const auto distance = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(edge.x)),
+                                                    _mm256_set1_ps(edge.y * centerY + edge.z));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            const auto depth = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(triangle.Depth.x)),
+                                             _mm256_set1_ps(triangle.Depth.y * centerY + triangle.Depth.z));
+            const auto current = _mm256_loadu_ps(pixels);
+            _mm256_storeu_ps(pixels, _mm256_blendv_ps(current, _mm256_max_ps(current, depth), inside));
+#elif defined(__SSE2__) || defined(_M_X64)
+            for (int half = 0; half < LaneCount; half += 4) {
+                const auto centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x + half) + 0.5f),
+                                                _mm_setr_ps(0, 1, 2, 3));
+                auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (const auto &edge: triangle.Edges) {
+                    const auto distance = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(edge.x)),
+                                                     _mm_set1_ps(edge.y * centerY + edge.z));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+                }
+                const auto depth = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(triangle.Depth.x)),
+                                              _mm_set1_ps(triangle.Depth.y * centerY + triangle.Depth.z));
+                const auto current = _mm_loadu_ps(pixels + half);
+                const auto nearer = _mm_max_ps(current, depth);
+                _mm_storeu_ps(pixels + half, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int lane = 0; lane < LaneCount; lane++) {
+                const float centerX = static_cast<float>(x + lane) + 0.5f;
+                bool inside = true;
+                for (const auto &edge: triangle.Edges)
+                    inside &= edge.x * centerX + (edge.y * centerY + edge.z) >= 0.0f;
+                const float depth = triangle.Depth.x * centerX + (triangle.Depth.y * centerY + triangle.Depth.z);
+                if (inside)
+                    pixels[lane] = std::max(pixels[lane], depth);
+            }
+#endif
+        }
+
+        // Bit i is set when pixel i holds no occluder nearer than depth.
+        static std::uint32_t NotBehind(const float *pixels, float depth) {
+#if defined(__AVX__)
+            return static_cast<std::uint32_t>(_mm256_movemask_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(pixels), _mm256_set1_ps(depth), _CMP_LE_OQ)));
+#elif defined(__SSE2__) || defined(_M_X64)
+            const auto threshold = _mm_set1_ps(depth);
+            return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(pixels), threshold))) |
+                   static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(pixels + 4), threshold))) << 4;
+#else
+            std::uint32_t mask = 0;
+            for (int lane = 0; lane < LaneCount; lane++)
+                mask |= static_cast<std::uint32_t>(pixels[lane] <= depth) << lane;
+            return mask;
+#endif
+        }
+
+        // Bits of the lanes starting at x that lie within minX to maxX.
+        static std::uint32_t LaneRange(int x, int minX, int maxX) {
+            const int first = std::max(0, minX - x);
+            const int last = std::min(LaneCount - 1, maxX - x);
+            return ((1u << (last + 1)) - 1u) & ~((1u << first) - 1u);
+        }
+    };
+}
@@ -2,6 +2,7 @@
 
 #include "Entity.hpp"
 #include "Light.hpp"
+#include "Graphics/UniformBlocks.hpp"
 #include "imgui.h"
 
 namespace Core {
@@ -32,6 +33,10 @@ namespace Core {
             Quadratic = props.Quadratic;
         }
 
+        [[nodiscard]] Graphics::PointLightData Data() const {
+            return {Position, Constant, Linear, Quadratic, Ambient, Diffuse, Specular};
+        }
+
         void UIRender() override {
             if (!ImGui::Begin("Light Settings")) {
                 ImGui::End();
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Core {
+    // Stable LSD radix sort of items by a 64-bit key, one byte per pass. Passes over a byte every key shares are
+    // skipped, so keys that only use their high and low bits cost few passes. scratch is resized and reused.
+    template<typename T, typename KeyOf>
+    void RadixSort(std::vector<T> &items, std::vector<T> &scratch, KeyOf keyOf) {
+        constexpr std::size_t Passes = sizeof(std::uint64_t);
+        std::array<std::array<std::uint32_t, 256>, Passes> counts{};
+        for (const auto &item: items) {
+            const std::uint64_t key = keyOf(item);
+            for (std::size_t pass = 0; pass < Passes; pass++)
+                counts[pass][key >> pass * 8 & 0xFF]++;
+        }
+
+        scratch.resize(items.size());
+        auto *source = &items;
+        auto *target = &scratch;
+        for (std::size_t pass = 0; pass < Passes; pass++) {
+            auto &histogram = counts[pass];
+            const auto shift = pass * 8;
+            if (items.empty() || histogram[(keyOf(items.front()) >> shift) & 0xFF] == items.size())
+                continue;
+
+            std::uint32_t offset = 0;
+            for (auto &count: histogram)
+                offset += std::exchange(count, offset);
+            for (const auto &item: *source)
+                (*target)[histogram[(keyOf(item) >> shift) & 0xFF]++] = item;
+            std::swap(source, target);
+        }
+        if (source != &items)
+            items.swap(scratch);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+
+namespace Core {
+    // First-fit suballocator over an abstract [0, capacity) range; neighbouring free blocks are coalesced.
+    class RangeAllocator {
+    public:
+        static constexpr std::size_t Invalid = ~static_cast<std::size_t>(0);
+
+        explicit RangeAllocator(std::size_t capacity = 0) {
+            Grow(capacity);
+        }
+
+        // Returns the offset of the block, or Invalid when no free block is large enough.
+        std::size_t Allocate(std::size_t size, std::size_t alignment = 1) {
+            for (auto it = _free.begin(); it != _free.end(); ++it) {
+                const auto [offset, length] = *it;
+                const auto aligned = (offset + alignment - 1) / alignment * alignment;
+                if (aligned + size > offset + length)
+                    continue;
+
+                _free.erase(it);
+                if (aligned > offset)
+                    _free.emplace(offset, aligned - offset);
+                if (aligned + size < offset + length)
+                    _free.emplace(aligned + size, offset + length - aligned - size);
+                return aligned;
+            }
+            return Invalid;
+        }
+
+        void Free(std::size_t offset, std::size_t size) {
+            if (size == 0)
+                return;
+            auto it = _free.emplace(offset, size).first;
+            if (const auto next = std::next(it); next != _free.end() && offset + size == next->first) {
+                it->second += next->second;
+                _free.erase(next);
+            }
+            if (it != _free.begin()) {
+                const auto previous = std::prev(it);
+                if (previous->first + previous->second == offset) {
+                    previous->second += it->second;
+                    _free.erase(it);
+                }
+            }
+        }
+
+        // Extends the range; the new tail becomes free.
+        void Grow(std::size_t capacity) {
+            if (capacity <= _capacity)
+                return;
+            const auto previous = _capacity;
+            _capacity = capacity;
+            Free(previous, capacity - previous);
+        }
+
+        [[nodiscard]] std::size_t Capacity() const {
+            return _capacity;
+        }
+
+    private:
+        std::map<std::size_t, std::size_t> _free;
+        std::size_t _capacity = 0;
+    };
+}
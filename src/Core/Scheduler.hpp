@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+
+namespace Core {
+
+    enum class LoadMode {
+        Blocking,
+        Async
+    };
+
+    // Hops coroutines between the worker pool and the GL thread. The main loop drains GL-thread work with Pump().
+    class Scheduler {
+    public:
+        struct WorkerAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const {
+                ThreadPool::Shared().Submit([handle] { handle.resume(); });
+            }
+
+            void await_resume() const noexcept {
+            }
+        };
+
+        struct MainThreadAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const {
+                std::lock_guard lock(_mutex);
+                _mainThreadQueue.push_back(handle);
+            }
+
+            void await_resume() const noexcept {
+            }
+        };
+
+        static WorkerAwaiter WorkerThread() {
+            return {};
+        }
+
+        static MainThreadAwaiter MainThread() {
+            return {};
+        }
+
+        // Resumes queued GL-thread work until the budget is spent, so streaming never stalls a frame for long.
+        static void Pump(std::chrono::microseconds budget = std::chrono::milliseconds(4)) {
+            const auto deadline = std::chrono::steady_clock::now() + budget;
+            do {
+                std::coroutine_handle<> handle;
+                {
+                    std::lock_guard lock(_mutex);
+                    if (_mainThreadQueue.empty())
+                        return;
+                    handle = _mainThreadQueue.front();
+                    _mainThreadQueue.pop_front();
+                }
+                handle.resume();
+            } while (std::chrono::steady_clock::now() < deadline);
+        }
+
+        static bool HasPendingWork() {
+            std::lock_guard lock(_mutex);
+            return !_mainThreadQueue.empty();
+        }
+
+    private:
+        static inline std::mutex _mutex;
+        static inline std::deque<std::coroutine_handle<>> _mainThreadQueue;
+    };
+}
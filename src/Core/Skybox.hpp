@@ -1,10 +1,15 @@
 #pragma once
 
 #include "glad/glad.h"
-#include "stb_image.h"
 #include "Log.hpp"
+#include "Core/Scheduler.hpp"
+#include "Core/Task.hpp"
+#include "Core/ThreadPool.hpp"
+#include "Graphics/Image.hpp"
+#include "Graphics/RenderState.hpp"
 #include "Graphics/Shader.hpp"
 #include "Camera.hpp"
+#include <future>
 #include <string>
 #include <utility>
 #include <vector>
@@ -18,40 +23,49 @@ namespace Core {
                 "Skybox.frag"
         );
 
-        explicit Skybox(std::vector<std::string> faces) {
-            SkyboxTexture = LoadCubemap(std::move(faces));
+        explicit Skybox(std::vector<std::string> faces, LoadMode mode = LoadMode::Blocking) {
+            if (mode == LoadMode::Async) {
+                SkyboxTexture = CreatePlaceholderCubemap();
+                _loading = StreamCubemap(SkyboxTexture, std::move(faces));
+            } else {
+                SkyboxTexture = LoadCubemap(std::move(faces));
+            }
 
             glGenVertexArrays(1, &SkyboxVAO);
-            glBindVertexArray(SkyboxVAO);
+            Graphics::RenderState::Shared().BindVertexArray(SkyboxVAO);
 
             glGenBuffers(1, &SkyboxVBO);
-            glBindBuffer(GL_ARRAY_BUFFER, SkyboxVBO);
+            Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, SkyboxVBO);
             glBufferData(GL_ARRAY_BUFFER, sizeof(_skyboxVertices), &_skyboxVertices[0], GL_STATIC_DRAW);
 
             glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
             glEnableVertexAttribArray(0);
-            glBindVertexArray(0);
+            Graphics::RenderState::Shared().BindVertexArray(0);
 
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-            glBindVertexArray(0);
         }
 
         void Render() const {
-            glBindVertexArray(SkyboxVAO);
-            glDepthFunc(GL_LEQUAL);
+            auto &state = Graphics::RenderState::Shared();
+            state.DepthFunc(GL_LEQUAL);
             SkyboxShader.Use();
-            glBindVertexArray(SkyboxVAO);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, SkyboxTexture);
+            state.BindVertexArray(SkyboxVAO);
+            state.BindTexture(0, GL_TEXTURE_CUBE_MAP, SkyboxTexture);
             glDrawArrays(GL_TRIANGLES, 0, 36);
-            glDepthFunc(GL_LESS);
-            glBindVertexArray(0);
+            state.DepthFunc(GL_LESS);
+        }
+
+        bool IsResident() const {
+            return _loading.IsReady();
         }
 
     private:
+        Task<void> _loading;
+
         float _skyboxVertices[108] = {
                 -1.0f, 1.0f, -1.0f,
                 -1.0f, -1.0f, -1.0f,
@@ -96,38 +110,73 @@ namespace Core {
                 1.0f, -1.0f, 1.0f
         };
 
-        static unsigned int LoadCubemap(std::vector<std::string> faces) {
-            stbi_set_flip_vertically_on_load(false);
-            unsigned int textureID;
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-            int width, height, nrChannels;
-            for (unsigned int i = 0; i < faces.size(); i++) {
-                unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-                if (data) {
-                    GLenum format;
-                    if (nrChannels == 1)
-                        format = GL_RED;
-                    else if (nrChannels == 3)
-                        format = GL_RGB;
-                    else if (nrChannels == 4)
-                        format = GL_RGBA;
-
-                    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                                 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data
-                    );
-                    stbi_image_free(data);
-                } else {
-                    Log::Error("Cubemap tex failed to load at path: {}", faces[i]);
-                    stbi_image_free(data);
-                }
-            }
+        static void SetCubemapParameters() {
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        }
+
+        static void UploadFace(unsigned int face, const Graphics::Image &image, const std::string &path) {
+            if (image.IsValid()) {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+                             0, image.DataFormat(), image.Width, image.Height, 0, image.DataFormat(),
+                             GL_UNSIGNED_BYTE, image.Pixels()
+                );
+            } else {
+                Log::Error("Cubemap tex failed to load at path: {}", path);
+            }
+        }
+
+        static unsigned int CreatePlaceholderCubemap() {
+            static constexpr unsigned char placeholder[4] = {128, 128, 128, 255};
+
+            unsigned int textureID;
+            glGenTextures(1, &textureID);
+            Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+            for (unsigned int i = 0; i < 6; i++) {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                             placeholder);
+            }
+            SetCubemapParameters();
+            return textureID;
+        }
+
+        // Faces are swapped in together so the cube never mixes placeholder and real sizes, which would leave it incomplete.
+        static Task<void> StreamCubemap(unsigned int textureID, std::vector<std::string> faces) {
+            std::vector<Task<Graphics::Image>> decoded;
+            decoded.reserve(faces.size());
+            for (const auto &face: faces)
+                decoded.push_back(Graphics::Image::DecodeAsync(face, false));
+
+            std::vector<Graphics::Image> images;
+            images.reserve(faces.size());
+            for (auto &face: decoded)
+                images.push_back(co_await face);
+
+            co_await Scheduler::MainThread();
+            Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+            for (unsigned int i = 0; i < images.size(); i++)
+                UploadFace(i, images[i], faces[i]);
+        }
+
+        static unsigned int LoadCubemap(std::vector<std::string> faces) {
+            std::vector<std::future<Graphics::Image>> decoded;
+            decoded.reserve(faces.size());
+            for (const auto &face: faces) {
+                decoded.push_back(Core::ThreadPool::Shared().Submit([face] {
+                    return Graphics::Image::Decode(face, false);
+                }));
+            }
+
+            unsigned int textureID;
+            glGenTextures(1, &textureID);
+            Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+
+            for (unsigned int i = 0; i < faces.size(); i++)
+                UploadFace(i, decoded[i].get(), faces[i]);
+            SetCubemapParameters();
 
             return textureID;
         }
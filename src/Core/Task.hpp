@@ -0,0 +1,159 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Core {
+
+    template<typename T = void>
+    class Task;
+
+    namespace Detail {
+        template<typename T>
+        struct TaskState {
+            using Storage = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+            std::mutex Mutex;
+            bool Ready = false;
+            std::optional<Storage> Value;
+            std::exception_ptr Exception;
+            std::vector<std::coroutine_handle<>> Continuations;
+
+            void Complete() {
+                std::vector<std::coroutine_handle<>> continuations;
+                {
+                    std::lock_guard lock(Mutex);
+                    Ready = true;
+                    continuations.swap(Continuations);
+                }
+                for (auto continuation: continuations)
+                    continuation.resume();
+            }
+        };
+
+        template<typename T>
+        struct TaskPromiseBase {
+            std::shared_ptr<TaskState<T>> State = std::make_shared<TaskState<T>>();
+
+            // Tasks start eagerly; the frame destroys itself on completion and only the shared state outlives it.
+            std::suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            auto final_suspend() noexcept {
+                struct FinalAwaiter {
+                    bool await_ready() noexcept {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<> handle) noexcept {
+                        auto state = std::move(_state);
+                        handle.destroy();
+                        state->Complete();
+                    }
+
+                    void await_resume() noexcept {
+                    }
+
+                    std::shared_ptr<TaskState<T>> _state;
+                };
+                return FinalAwaiter{State};
+            }
+
+            void unhandled_exception() {
+                State->Exception = std::current_exception();
+            }
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase<T> {
+            Task<T> get_return_object();
+
+            template<typename U>
+            void return_value(U &&value) {
+                this->State->Value.emplace(std::forward<U>(value));
+            }
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase<void> {
+            Task<void> get_return_object();
+
+            void return_void() {
+                State->Value.emplace();
+            }
+        };
+    }
+
+    // Eagerly started coroutine whose completion can be polled with IsReady() or co_awaited from any thread.
+    // Awaiters are resumed on the thread that finishes the task; hop with Scheduler::MainThread() before touching GL.
+    template<typename T>
+    class Task {
+    public:
+        using promise_type = Detail::TaskPromise<T>;
+
+        Task() = default;
+
+        [[nodiscard]] bool IsReady() const {
+            if (!_state)
+                return true;
+            std::lock_guard lock(_state->Mutex);
+            return _state->Ready;
+        }
+
+        auto operator co_await() const {
+            struct Awaiter {
+                std::shared_ptr<Detail::TaskState<T>> State;
+
+                bool await_ready() {
+                    if (!State)
+                        return true;
+                    std::lock_guard lock(State->Mutex);
+                    return State->Ready;
+                }
+
+                bool await_suspend(std::coroutine_handle<> handle) {
+                    std::lock_guard lock(State->Mutex);
+                    if (State->Ready)
+                        return false;
+                    State->Continuations.push_back(handle);
+                    return true;
+                }
+
+                decltype(auto) await_resume() {
+                    if (State && State->Exception)
+                        std::rethrow_exception(State->Exception);
+                    if constexpr (!std::is_void_v<T>)
+                        return std::move(*State->Value);
+                }
+            };
+            return Awaiter{_state};
+        }
+
+    private:
+        friend struct Detail::TaskPromise<T>;
+
+        std::shared_ptr<Detail::TaskState<T>> _state;
+
+        explicit Task(std::shared_ptr<Detail::TaskState<T>> state) : _state(std::move(state)) {
+        }
+    };
+
+    namespace Detail {
+        template<typename T>
+        Task<T> TaskPromise<T>::get_return_object() {
+            return Task<T>(this->State);
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() {
+            return Task<void>(State);
+        }
+    }
+}
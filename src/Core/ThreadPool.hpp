@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Core {
+
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned int threadCount = DefaultThreadCount()) {
+            _workers.reserve(threadCount);
+            for (unsigned int i = 0; i < threadCount; i++)
+                _workers.emplace_back([this](const std::stop_token &stop) { WorkerLoop(stop); });
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            for (auto &worker: _workers)
+                worker.request_stop();
+            _workers.clear();
+        }
+
+        template<typename F>
+        auto Submit(F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            auto future = packaged->get_future();
+            {
+                std::lock_guard lock(_mutex);
+                _tasks.emplace_back([packaged] { (*packaged)(); });
+            }
+            _condition.notify_one();
+            return future;
+        }
+
+        [[nodiscard]] unsigned int GetThreadCount() const {
+            return static_cast<unsigned int>(_workers.size());
+        }
+
+        static ThreadPool &Shared() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        // For work the frame waits on, which must not queue behind the decode and cook jobs of Shared.
+        static ThreadPool &Frame() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        static unsigned int DefaultThreadCount() {
+            return std::max(2u, std::thread::hardware_concurrency()) - 1;
+        }
+
+    private:
+        std::vector<std::jthread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable_any _condition;
+
+        void WorkerLoop(const std::stop_token &stop) {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(_mutex);
+                    if (!_condition.wait(lock, stop, [this] { return !_tasks.empty(); }))
+                        return;
+                    task = std::move(_tasks.front());
+                    _tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+}
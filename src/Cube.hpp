@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Core/Entity.hpp"
+#include "Graphics/Mesh.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderState.hpp"
 #include "Graphics/Shader.hpp"
 #include "glm/ext/matrix_transform.hpp"
 
@@ -13,22 +16,15 @@ public:
                   glm::vec3 scale = glm::vec3(1, 1, 1)
     ) : Entity(position, rotation, scale) {
         glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(Cube::Vertices), Cube::Vertices, GL_DYNAMIC_DRAW);
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), nullptr);
-        glEnableVertexAttribArray(0);
+        Graphics::StandardLayout::Apply();
 
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (5 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
     }
 
     void Render(Graphics::Shader &shader) override {
@@ -36,11 +32,13 @@ public:
         shader.Use();
         shader.SetMat4("model", Model);
 
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
+    }
 
-        glBindVertexArray(0);
+    [[nodiscard]] Graphics::DrawPacket Packet() const {
+        return {.VertexArray = VAO, .Count = 36, .Transform = Model};
     }
 
     constexpr const static float Vertices[288] = {
@@ -1,18 +1,80 @@
-#include <sstream>
 #include "File.hpp"
-#include <Log.hpp>
-
-std::string File::GetAllLines(const std::string &path) {
-    std::ifstream file(path);
-    std::string content;
-
-    if (file.is_open()) {
-        std::stringstream stream;
-        stream << file.rdbuf();
-        content = stream.str();
-        file.close();
-    } else {
-        Log::Information("FILE::LOAD_FAILED");
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path) {
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        return;
     }
-    return content;
-}
\ No newline at end of file
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+        return;
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping)
+        return;
+
+    _data = static_cast<const std::byte *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data)
+        _size = static_cast<std::size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file)
+        CloseHandle(_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+    _fd = open(path.c_str(), O_RDONLY);
+    if (_fd < 0)
+        return;
+
+    struct stat info{};
+    if (fstat(_fd, &info) != 0 || info.st_size == 0)
+        return;
+
+    void *data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (data == MAP_FAILED)
+        return;
+
+    _data = static_cast<const std::byte *>(data);
+    _size = static_cast<std::size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile() {
+    if (_data)
+        munmap(const_cast<std::byte *>(_data), _size);
+    if (_fd >= 0)
+        close(_fd);
+}
+
+#endif
+
+bool MappedFile::IsOpen() const {
+    return _data != nullptr;
+}
+
+std::span<const std::byte> MappedFile::Data() const {
+    return {_data, _size};
+}
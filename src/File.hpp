@@ -1,10 +1,32 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <string>
 #include <iostream>
 #include <fstream>
 
-class File {
+class MappedFile {
 public:
-    static std::string GetAllLines(const std::string &path);
-};
\ No newline at end of file
+    explicit MappedFile(const std::string &path);
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    [[nodiscard]] bool IsOpen() const;
+
+    [[nodiscard]] std::span<const std::byte> Data() const;
+
+private:
+    const std::byte *_data{};
+    std::size_t _size{};
+#ifdef _WIN32
+    void *_file{};
+    void *_mapping{};
+#else
+    int _fd = -1;
+#endif
+};
@@ -0,0 +1,101 @@
+#include "FileSystem.hpp"
+#include "File.hpp"
+#include "Log.hpp"
+#include <filesystem>
+#include <mutex>
+
+FileView::FileView(std::shared_ptr<const void> owner, std::span<const std::byte> data)
+        : _owner(std::move(owner)), _data(data) {
+}
+
+FileView FileView::Map(const std::string &path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    if (!file->IsOpen())
+        return {};
+    const auto data = file->Data();
+    return {std::move(file), data};
+}
+
+bool FileView::IsOpen() const {
+    return _owner != nullptr;
+}
+
+std::span<const std::byte> FileView::Data() const {
+    return _data;
+}
+
+std::string_view FileView::Text() const {
+    return {reinterpret_cast<const char *>(_data.data()), _data.size()};
+}
+
+FileView FileView::Slice(std::size_t offset, std::size_t size) const {
+    return {_owner, _data.subspan(offset, size)};
+}
+
+DirectorySource::DirectorySource(std::string directory) : _directory(std::move(directory)) {
+    if (!_directory.empty() && _directory.back() != '/')
+        _directory += '/';
+}
+
+FileView DirectorySource::Open(const std::string &path) const {
+    return FileView::Map(_directory + path);
+}
+
+bool DirectorySource::Exists(const std::string &path) const {
+    std::error_code error;
+    return std::filesystem::is_regular_file(_directory + path, error);
+}
+
+FileSystem::FileSystem() {
+    _mounts.push_back({"", std::make_shared<const DirectorySource>("")});
+}
+
+FileSystem &FileSystem::Shared() {
+    static FileSystem fileSystem;
+    return fileSystem;
+}
+
+void FileSystem::Mount(std::string prefix, std::shared_ptr<const FileSource> source) {
+    std::unique_lock lock(_mutex);
+    _mounts.push_back({std::move(prefix), std::move(source)});
+}
+
+FileView FileSystem::Open(const std::string &path) const {
+    auto view = Find(path);
+    if (!view.IsOpen())
+        Log::Error("FILE_SYSTEM::NOT_FOUND {}", path);
+    return view;
+}
+
+FileView FileSystem::Find(const std::string &path) const {
+    const auto normalized = NormalizePath(path);
+    std::shared_lock lock(_mutex);
+    for (auto it = _mounts.rbegin(); it != _mounts.rend(); ++it) {
+        if (!normalized.starts_with(it->Prefix))
+            continue;
+        if (auto view = it->Source->Open(normalized.substr(it->Prefix.size())); view.IsOpen())
+            return view;
+    }
+    return {};
+}
+
+bool FileSystem::Exists(const std::string &path) const {
+    const auto normalized = NormalizePath(path);
+    std::shared_lock lock(_mutex);
+    for (auto it = _mounts.rbegin(); it != _mounts.rend(); ++it) {
+        if (normalized.starts_with(it->Prefix) && it->Source->Exists(normalized.substr(it->Prefix.size())))
+            return true;
+    }
+    return false;
+}
+
+std::string FileSystem::CachePath(const std::string &path) {
+    return "cache/" + NormalizePath(path);
+}
+
+std::string FileSystem::NormalizePath(const std::string &path) {
+    auto normalized = std::filesystem::path(path).lexically_normal().generic_string();
+    if (normalized.starts_with("./"))
+        normalized.erase(0, 2);
+    return normalized;
+}
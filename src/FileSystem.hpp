@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Zero-copy, read-only bytes of a file; copies share whatever keeps the bytes alive (a mapping or a buffer).
+class FileView {
+public:
+    FileView() = default;
+
+    FileView(std::shared_ptr<const void> owner, std::span<const std::byte> data);
+
+    // Maps a file on disk; closed when the file is missing, empty or can not be mapped.
+    static FileView Map(const std::string &path);
+
+    [[nodiscard]] bool IsOpen() const;
+
+    [[nodiscard]] std::span<const std::byte> Data() const;
+
+    [[nodiscard]] std::string_view Text() const;
+
+    // A range of this view that keeps the same backing alive.
+    [[nodiscard]] FileView Slice(std::size_t offset, std::size_t size) const;
+
+private:
+    std::shared_ptr<const void> _owner;
+    std::span<const std::byte> _data;
+};
+
+// A tree of read-only files behind a mount point. Paths are relative to the mount point, with forward slashes.
+class FileSource {
+public:
+    virtual ~FileSource() = default;
+
+    [[nodiscard]] virtual FileView Open(const std::string &path) const = 0;
+
+    [[nodiscard]] virtual bool Exists(const std::string &path) const = 0;
+};
+
+class DirectorySource final : public FileSource {
+public:
+    explicit DirectorySource(std::string directory);
+
+    [[nodiscard]] FileView Open(const std::string &path) const override;
+
+    [[nodiscard]] bool Exists(const std::string &path) const override;
+
+private:
+    std::string _directory;
+};
+
+// Resolves engine paths such as "resources/shaders/Skybox.vert" through mount points. Mounts are searched newest
+// first and a source that lacks the file falls through to the next, so loose directories can overlay packs.
+class FileSystem {
+public:
+    static FileSystem &Shared();
+
+    // prefix is empty or ends with '/'; the working directory is mounted at "" from the start.
+    void Mount(std::string prefix, std::shared_ptr<const FileSource> source);
+
+    // Logs FILE_SYSTEM::NOT_FOUND when no mount holds the file.
+    [[nodiscard]] FileView Open(const std::string &path) const;
+
+    // For optional files such as caches: returns a closed view without logging.
+    [[nodiscard]] FileView Find(const std::string &path) const;
+
+    [[nodiscard]] bool Exists(const std::string &path) const;
+
+    static std::string NormalizePath(const std::string &path);
+
+    // Where a file derived from path, such as a cooked mesh, is written: under "cache/" in the working directory,
+    // as the resources may be a read-only pack. Callers create the directories when they write.
+    static std::string CachePath(const std::string &path);
+
+private:
+    struct MountPoint {
+        std::string Prefix;
+        std::shared_ptr<const FileSource> Source;
+    };
+
+    std::vector<MountPoint> _mounts;
+    mutable std::shared_mutex _mutex;
+
+    FileSystem();
+};
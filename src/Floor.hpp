@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Core/Entity.hpp"
+#include "Graphics/Mesh.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderState.hpp"
 #include "Graphics/Shader.hpp"
 #include "glm/ext/matrix_transform.hpp"
 
@@ -12,34 +15,31 @@ public:
                    glm::vec3 rotation = glm::vec3(0, 0, 0),
                    glm::vec3 scale = glm::vec3(10, 1, 10)
     ) : Entity(position, rotation, scale) {
+        LocalBounds = {{-5.0f, -0.5f, -5.0f}, {5.0f, -0.5f, 5.0f}};
+
         glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(Floor::Vertices), Floor::Vertices, GL_DYNAMIC_DRAW);
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), nullptr);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+        Graphics::StandardLayout::Apply();
 
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (5 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
     }
 
     void Render(Graphics::Shader &shader) override {
         shader.Use();
         shader.SetMat4("model", Model);
 
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
 
-        glBindVertexArray(0);
+    [[nodiscard]] Graphics::DrawPacket Packet() const {
+        return {.VertexArray = VAO, .Count = 6, .Transform = Model};
     }
 
     constexpr const static float Vertices[48] = {
@@ -0,0 +1,149 @@
+#include "CompressedTexture.hpp"
+#include "Log.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::uint32_t Magic = 0x58544343; // "CCTX"
+        constexpr std::size_t Alignment = 16;
+
+        struct Header {
+            std::uint32_t Magic;
+            std::uint32_t Version;
+            std::uint64_t SourceHash;
+            std::uint64_t SettingsHash;
+            std::uint32_t Format;
+            std::uint32_t Channels;
+            std::uint32_t Width;
+            std::uint32_t Height;
+            std::uint32_t LevelCount;
+            std::uint32_t Reserved;
+        };
+
+        struct LevelRecord {
+            std::uint64_t Offset;
+            std::uint64_t Size;
+            std::uint32_t Width;
+            std::uint32_t Height;
+        };
+
+        constexpr std::uint64_t Align(std::uint64_t offset) {
+            return (offset + Alignment - 1) & ~static_cast<std::uint64_t>(Alignment - 1);
+        }
+    }
+
+    std::string CompressedTexture::PathFor(const std::string &sourcePath, std::uint64_t settingsHash) {
+        const auto name = fmt::format("{}.{:08x}.ctex", sourcePath, static_cast<std::uint32_t>(settingsHash));
+        return FileSystem::CachePath(name);
+    }
+
+    std::unique_ptr<CompressedTexture> CompressedTexture::Open(const std::string &sourcePath,
+                                                               std::uint64_t sourceHash,
+                                                               std::uint64_t settingsHash) {
+        std::unique_ptr<CompressedTexture> texture(new CompressedTexture());
+        texture->_file = FileSystem::Shared().Find(PathFor(sourcePath, settingsHash));
+        if (!texture->_file.IsOpen())
+            return nullptr;
+
+        if (!texture->Parse(texture->_file.Data(), sourceHash, settingsHash)) {
+            Log::Information(fmt::format("TEXTURE_CACHE::STALE {}", sourcePath));
+            return nullptr;
+        }
+        return texture;
+    }
+
+    std::unique_ptr<CompressedTexture> CompressedTexture::Cook(const std::string &sourcePath,
+                                                               std::uint64_t sourceHash,
+                                                               std::uint64_t settingsHash, const Image &image,
+                                                               TextureCompression format, bool srgb) {
+        const auto mips = TextureCompressor::BuildMipChain(image, srgb);
+
+        Header header{};
+        header.Magic = Magic;
+        header.Version = Version;
+        header.SourceHash = sourceHash;
+        header.SettingsHash = settingsHash;
+        header.Format = TextureCompressor::GLFormat(format, srgb);
+        header.Channels = static_cast<std::uint32_t>(image.Channels);
+        header.Width = static_cast<std::uint32_t>(image.Width);
+        header.Height = static_cast<std::uint32_t>(image.Height);
+        header.LevelCount = static_cast<std::uint32_t>(mips.size());
+
+        std::vector<LevelRecord> records(mips.size());
+        auto offset = Align(sizeof(Header) + records.size() * sizeof(LevelRecord));
+        for (std::size_t i = 0; i < mips.size(); i++) {
+            records[i] = {offset, TextureCompressor::LevelBytes(format, mips[i].Width, mips[i].Height),
+                          static_cast<std::uint32_t>(mips[i].Width), static_cast<std::uint32_t>(mips[i].Height)};
+            offset = Align(offset + records[i].Size);
+        }
+
+        std::unique_ptr<CompressedTexture> texture(new CompressedTexture());
+        auto &bytes = texture->_bytes;
+        bytes.resize(offset);
+        std::memcpy(bytes.data(), &header, sizeof(Header));
+        std::memcpy(bytes.data() + sizeof(Header), records.data(), records.size() * sizeof(LevelRecord));
+        for (std::size_t i = 0; i < mips.size(); i++) {
+            const auto encoded = TextureCompressor::Encode(mips[i], format);
+            std::memcpy(bytes.data() + records[i].Offset, encoded.data(), encoded.size());
+        }
+
+        const auto cookedPath = PathFor(sourcePath, settingsHash);
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cookedPath).parent_path(), error);
+        std::ofstream file(cookedPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file.good())
+            Log::Error("TEXTURE_CACHE::WRITE_FAILED {}", cookedPath);
+
+        texture->Parse(bytes, sourceHash, settingsHash);
+        return texture;
+    }
+
+    bool CompressedTexture::Parse(std::span<const std::byte> bytes, std::uint64_t sourceHash,
+                                  std::uint64_t settingsHash) {
+        if (bytes.size() < sizeof(Header))
+            return false;
+
+        Header header{};
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.Magic != Magic || header.Version != Version || header.SourceHash != sourceHash ||
+            header.SettingsHash != settingsHash || header.LevelCount == 0 ||
+            header.LevelCount > (bytes.size() - sizeof(Header)) / sizeof(LevelRecord))
+            return false;
+
+        Format = header.Format;
+        Channels = static_cast<int>(header.Channels);
+        Levels.clear();
+        Levels.reserve(header.LevelCount);
+        for (std::uint32_t i = 0; i < header.LevelCount; i++) {
+            LevelRecord record{};
+            std::memcpy(&record, bytes.data() + sizeof(Header) + i * sizeof(LevelRecord), sizeof(LevelRecord));
+            if (record.Offset > bytes.size() || record.Size > bytes.size() - record.Offset)
+                return false;
+            Levels.push_back({static_cast<int>(record.Width), static_cast<int>(record.Height),
+                              bytes.subspan(record.Offset, record.Size)});
+        }
+        return true;
+    }
+
+    int CompressedTexture::Width() const {
+        return Levels.front().Width;
+    }
+
+    int CompressedTexture::Height() const {
+        return Levels.front().Height;
+    }
+
+    void CompressedTexture::Upload() const {
+        for (std::size_t i = 0; i < Levels.size(); i++) {
+            const auto &level = Levels[i];
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), Format, level.Width, level.Height, 0,
+                                   static_cast<GLsizei>(level.Data.size()), level.Data.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(Levels.size()) - 1);
+    }
+}
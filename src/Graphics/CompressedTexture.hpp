@@ -0,0 +1,57 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "FileSystem.hpp"
+#include "Image.hpp"
+#include "TextureCompressor.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Graphics {
+    struct CompressedLevel {
+        int Width{};
+        int Height{};
+        std::span<const std::byte> Data;
+    };
+
+    // Cooked block-compressed mip chain stored next to its source, laid out like KTX2: a header, a level index of
+    // offsets and sizes, then every level 16-byte aligned. Levels are mapped and uploaded without decoding.
+    class CompressedTexture {
+    public:
+        static constexpr std::uint32_t Version = 1;
+
+        GLenum Format{};
+        int Channels{};
+        std::vector<CompressedLevel> Levels;
+
+        // One file per settings combination, so a source sampled both as colour and as data does not thrash.
+        static std::string PathFor(const std::string &sourcePath, std::uint64_t settingsHash);
+
+        // settingsHash covers everything that changes the cooked output besides the source bytes.
+        static std::unique_ptr<CompressedTexture> Open(const std::string &sourcePath, std::uint64_t sourceHash,
+                                                       std::uint64_t settingsHash);
+
+        // Encodes every level of the image, writes the cooked file and returns it, even if writing failed.
+        static std::unique_ptr<CompressedTexture> Cook(const std::string &sourcePath, std::uint64_t sourceHash,
+                                                       std::uint64_t settingsHash, const Image &image,
+                                                       TextureCompression format, bool srgb);
+
+        [[nodiscard]] int Width() const;
+
+        [[nodiscard]] int Height() const;
+
+        // Uploads every level into the texture bound to GL_TEXTURE_2D.
+        void Upload() const;
+
+    private:
+        FileView _file;
+        std::vector<std::byte> _bytes;
+
+        CompressedTexture() = default;
+
+        bool Parse(std::span<const std::byte> bytes, std::uint64_t sourceHash, std::uint64_t settingsHash);
+    };
+}
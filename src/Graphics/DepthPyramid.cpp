@@ -0,0 +1,408 @@
+#include "DepthPyramid.hpp"
+#include "RenderState.hpp"
+#include "Log.hpp"
+#include <algorithm>
+
+namespace Graphics {
+
+    namespace {
+        // Limits sampling to levels base to max of a texture on unit 0, so a pass can write a level outside them.
+        void SetLevels(GLuint texture, int base, int max) {
+            auto &state = RenderState::Shared();
+            state.ActiveTexture(GL_TEXTURE0);
+            state.BindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, base);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max);
+        }
+
+        void AllocateDepth(GLuint texture, glm::ivec2 size, GLint internalFormat, GLenum format, GLenum type) {
+            auto &state = RenderState::Shared();
+            state.ActiveTexture(GL_TEXTURE0);
+            state.BindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.x, size.y, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        }
+
+        // Min and max depth per texel, every level down to 1x1 so the chain is complete under mipmap filtering.
+        void AllocateChain(GLuint texture, glm::ivec2 size, int levelCount) {
+            auto &state = RenderState::Shared();
+            state.ActiveTexture(GL_TEXTURE0);
+            state.BindTexture(GL_TEXTURE_2D, texture);
+            for (int level = 0; level < levelCount; level++) {
+                const auto levelSize = glm::max(size >> level, glm::ivec2(1));
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RG32F, levelSize.x, levelSize.y, 0, GL_RG, GL_FLOAT, nullptr);
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        }
+
+        void CheckFramebuffer(GLenum target) {
+            const GLenum status = glCheckFramebufferStatus(target);
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+                Log::Error("DEPTH_PYRAMID::FRAMEBUFFER_INCOMPLETE {}", status);
+        }
+    }
+
+    DepthPyramid::DepthPyramid() {
+        glGenVertexArrays(1, &_vertexArray);
+        glGenFramebuffers(1, &_copyFramebuffer);
+        glGenFramebuffers(1, &_reprojectFramebuffer);
+        glGenFramebuffers(1, &_reduceFramebuffer);
+        glGenTextures(1, &_depthTexture);
+        glGenTextures(1, &_multisampledDepth);
+        glGenTextures(1, &_history);
+        glGenTextures(1, &_reprojected);
+        glGenTextures(1, &_pyramid);
+        for (auto &readback: _readbacks)
+            glGenBuffers(1, &readback.Buffer);
+    }
+
+    DepthPyramid::~DepthPyramid() {
+        auto &state = RenderState::Shared();
+        for (auto &readback: _readbacks) {
+            if (readback.Fence)
+                glDeleteSync(readback.Fence);
+            state.DeleteBuffer(readback.Buffer);
+        }
+        state.DeleteTexture(_pyramid);
+        state.DeleteTexture(_reprojected);
+        state.DeleteTexture(_history);
+        state.DeleteTexture(_multisampledDepth);
+        state.DeleteTexture(_depthTexture);
+        state.DeleteFramebuffer(_reduceFramebuffer);
+        state.DeleteFramebuffer(_reprojectFramebuffer);
+        state.DeleteFramebuffer(_copyFramebuffer);
+        state.DeleteVertexArray(_vertexArray);
+    }
+
+    void DepthPyramid::Capture(const glm::mat4 &viewProjection) {
+        GLint viewport[4]{};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        if (viewport[2] <= 0 || viewport[3] <= 0)
+            return;
+        const glm::ivec2 origin(viewport[0], viewport[1]);
+        if (viewport[2] != _width || viewport[3] != _height || origin != _origin)
+            Allocate(origin, viewport[2], viewport[3]);
+        if (_depthFormat.InternalFormat == 0)
+            return;
+
+        // A multisampled copy keeps every sample rather than the one a resolving blit would pick, so the reduction
+        // can stay conservative.
+        auto &state = RenderState::Shared();
+        state.BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, _copyFramebuffer);
+        glBlitFramebuffer(origin.x, origin.y, origin.x + _width, origin.y + _height,
+                          origin.x, origin.y, origin.x + _width, origin.y + _height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        state.Disable(GL_DEPTH_TEST);
+        state.Disable(GL_BLEND);
+        if (_depthFormat.Samples > 0)
+            ReducePass(_multisampledDepth, ReduceSource::MultisampledDepth, origin, true, _history, 0, _historySize);
+        else
+            ReducePass(_depthTexture, ReduceSource::Depth, origin, true, _history, 0, _historySize);
+        ReduceChain(_history, _historyLevels, _historySize);
+        StartReadback(viewProjection);
+
+        state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        state.Enable(GL_DEPTH_TEST);
+        state.Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        _capturedViewProjection = viewProjection;
+        _captured = true;
+    }
+
+    bool DepthPyramid::Reproject(const glm::mat4 &viewProjection) {
+        _ready = false;
+        if (!_captured)
+            return false;
+
+        GLint viewport[4]{};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        const bool cullFace = glIsEnabled(GL_CULL_FACE);
+        const auto size = LevelSize(_historySize, _reprojectedLevel);
+        auto &state = RenderState::Shared();
+        state.BindFramebuffer(GL_FRAMEBUFFER, _reprojectFramebuffer);
+        state.Viewport(0, 0, size.x, size.y);
+        state.Enable(GL_DEPTH_TEST);
+        state.DepthFunc(GL_LESS);
+        state.DepthMask(true);
+        state.Disable(GL_CULL_FACE);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        SetLevels(_history, _reprojectedLevel, _reprojectedLevel);
+        const auto &program = ReprojectProgram();
+        program.Use();
+        program.SetInt("source", 0);
+        program.SetMat4("reprojection", viewProjection * glm::inverse(_capturedViewProjection));
+        state.BindVertexArray(_vertexArray);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, size.x * size.y);
+
+        state.Disable(GL_DEPTH_TEST);
+        ReducePass(_reprojected, ReduceSource::Depth, {}, false, _pyramid, 0, size);
+        ReduceChain(_pyramid, _pyramidLevels, size);
+
+        state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        state.Enable(GL_DEPTH_TEST);
+        state.SetEnabled(GL_CULL_FACE, cullFace);
+        state.Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        _viewProjection = viewProjection;
+        _ready = true;
+        return true;
+    }
+
+    bool DepthPyramid::ReprojectInto(Core::OcclusionBuffer &occlusion, const glm::mat4 &viewProjection) {
+        ConsumeReadback();
+        if (!_hasOccluders)
+            return false;
+
+        occlusion.Begin(viewProjection);
+        occlusion.AddOccluder(std::span<const DepthVertex>(_vertices), std::span<const unsigned int>(_indices),
+                              _occluderModel);
+        occlusion.Rasterize();
+        return true;
+    }
+
+    void DepthPyramid::Bind(const Shader &shader, GLuint unit) const {
+        if (!_ready) {
+            shader.SetBool("hiZEnabled", false);
+            return;
+        }
+        RenderState::Shared().BindTexture(unit, GL_TEXTURE_2D, _pyramid);
+        shader.SetInt("hiZ", static_cast<int>(unit));
+        shader.SetMat4("hiZViewProjection", _viewProjection);
+        shader.SetInt("hiZLevels", _pyramidLevels);
+        shader.SetBool("hiZEnabled", true);
+    }
+
+    void DepthPyramid::Allocate(glm::ivec2 origin, int width, int height) {
+        _origin = origin;
+        _width = width;
+        _height = height;
+        _depthFormat = DefaultDepthFormat();
+        _historySize = LevelSize({width, height}, 1);
+        _historyLevels = LevelCount(_historySize);
+        _reprojectedLevel = LevelFor(_historySize, ReprojectedWidth);
+        _readbackLevel = LevelFor(_historySize, ReadbackWidth);
+        const auto pyramidSize = LevelSize(_historySize, _reprojectedLevel);
+        _pyramidLevels = LevelCount(pyramidSize);
+        _captured = false;
+        _ready = false;
+
+        AllocateChain(_history, _historySize, _historyLevels);
+        AllocateDepth(_reprojected, pyramidSize, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+        AllocateChain(_pyramid, pyramidSize, _pyramidLevels);
+
+        auto &state = RenderState::Shared();
+        if (_depthFormat.InternalFormat == 0) {
+            Log::Error("DEPTH_PYRAMID::NO_DEPTH_BUFFER");
+        } else {
+            const auto &format = _depthFormat;
+            const auto copySize = origin + glm::ivec2(width, height);
+            GLenum target = GL_TEXTURE_2D;
+            GLuint copy = _depthTexture;
+            if (format.Samples > 0) {
+                target = GL_TEXTURE_2D_MULTISAMPLE;
+                copy = _multisampledDepth;
+                state.BindTexture(0, target, copy);
+                glTexImage2DMultisample(target, format.Samples, static_cast<GLenum>(format.InternalFormat),
+                                        copySize.x, copySize.y, GL_TRUE);
+            } else {
+                AllocateDepth(copy, copySize, format.InternalFormat, format.Format, format.Type);
+            }
+
+            state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, _copyFramebuffer);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, format.Attachment, target, copy, 0);
+            glDrawBuffer(GL_NONE);
+            CheckFramebuffer(GL_DRAW_FRAMEBUFFER);
+        }
+        state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, _reprojectFramebuffer);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _reprojected, 0);
+        glDrawBuffer(GL_NONE);
+        CheckFramebuffer(GL_DRAW_FRAMEBUFFER);
+        state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    }
+
+    void DepthPyramid::ReducePass(GLuint source, ReduceSource kind, glm::ivec2 origin, bool halve, GLuint target,
+                                  int level, glm::ivec2 size) const {
+        auto &state = RenderState::Shared();
+        if (source == target)
+            SetLevels(source, level - 1, level - 1);
+        else if (kind == ReduceSource::MultisampledDepth)
+            state.BindTexture(1, GL_TEXTURE_2D_MULTISAMPLE, source);
+        else
+            state.BindTexture(0, GL_TEXTURE_2D, source);
+
+        state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, _reduceFramebuffer);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, level);
+        const auto levelSize = LevelSize(size, level);
+        state.Viewport(0, 0, levelSize.x, levelSize.y);
+
+        const auto &program = ReduceProgram();
+        program.Use();
+        program.SetInt("source", 0);
+        program.SetInt("sourceSamples", 1);
+        program.SetBool("depthSource", kind != ReduceSource::Level);
+        program.SetBool("multisampledSource", kind == ReduceSource::MultisampledDepth);
+        program.SetInt("sampleCount", _depthFormat.Samples);
+        program.SetIVec2("sourceOrigin", origin.x, origin.y);
+        program.SetBool("halve", halve);
+        state.BindVertexArray(_vertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    void DepthPyramid::ReduceChain(GLuint texture, int levelCount, glm::ivec2 size) const {
+        for (int level = 1; level < levelCount; level++)
+            ReducePass(texture, ReduceSource::Level, {}, true, texture, level, size);
+        SetLevels(texture, 0, levelCount - 1);
+    }
+
+    void DepthPyramid::StartReadback(const glm::mat4 &viewProjection) {
+        // A slot the GPU has not finished copying into yet is left alone rather than waited on.
+        auto &readback = _readbacks[_nextReadback];
+        if (readback.Fence) {
+            if (glClientWaitSync(readback.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                return;
+            glDeleteSync(readback.Fence);
+            readback.Fence = nullptr;
+        }
+
+        const auto size = LevelSize(_historySize, _readbackLevel);
+        auto &state = RenderState::Shared();
+        state.BindFramebuffer(GL_READ_FRAMEBUFFER, _reduceFramebuffer);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _history, _readbackLevel);
+        state.BindBuffer(GL_PIXEL_PACK_BUFFER, readback.Buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size.x * size.y * sizeof(glm::vec2)), nullptr,
+                     GL_STREAM_READ);
+        glReadPixels(0, 0, size.x, size.y, GL_RG, GL_FLOAT, nullptr);
+        state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.Capture = ++_captureCount;
+        readback.ViewProjection = viewProjection;
+        readback.Width = size.x;
+        readback.Height = size.y;
+        _nextReadback = (_nextReadback + 1) % ReadbackCount;
+    }
+
+    void DepthPyramid::ConsumeReadback() {
+        Readback *newest = nullptr;
+        for (auto &readback: _readbacks) {
+            if (!readback.Fence)
+                continue;
+            const auto status = glClientWaitSync(readback.Fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                continue;
+            glDeleteSync(readback.Fence);
+            readback.Fence = nullptr;
+            if (status != GL_WAIT_FAILED && (!newest || readback.Capture > newest->Capture))
+                newest = &readback;
+        }
+        if (!newest)
+            return;
+
+        const auto width = newest->Width;
+        const auto height = newest->Height;
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_PIXEL_PACK_BUFFER, newest->Buffer);
+        const auto *texels = static_cast<const glm::vec2 *>(glMapBufferRange(
+                GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(width * height * sizeof(glm::vec2)), GL_MAP_READ_BIT));
+        if (texels) {
+            // One quad per texel at its farthest depth; texels at the far plane occlude nothing and are left out.
+            _vertices.clear();
+            _indices.clear();
+            const auto scale = 2.0f / glm::vec2(width, height);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    const float depth = texels[y * width + x].y;
+                    if (depth >= 1.0f)
+                        continue;
+                    const auto first = static_cast<unsigned int>(_vertices.size());
+                    for (int corner = 0; corner < 4; corner++) {
+                        const auto position = glm::vec2(x + (corner & 1), y + (corner >> 1)) * scale - 1.0f;
+                        _vertices.push_back({glm::vec3(position, depth * 2.0f - 1.0f)});
+                    }
+                    _indices.insert(_indices.end(), {first, first + 1, first + 2, first + 2, first + 1, first + 3});
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            _occluderModel = glm::inverse(newest->ViewProjection);
+            _hasOccluders = true;
+        }
+        state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // Core profiles only describe the default framebuffer's depth through its bit depths and component type.
+    DepthPyramid::DepthFormat DepthPyramid::DefaultDepthFormat() {
+        auto &state = RenderState::Shared();
+        state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLint objectType = GL_NONE;
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE,
+                                              &objectType);
+        if (objectType == GL_NONE)
+            return {};
+
+        GLint depthBits = 0;
+        GLint stencilBits = 0;
+        GLint componentType = 0;
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE,
+                                              &depthBits);
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE,
+                                              &stencilBits);
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE,
+                                              &componentType);
+
+        DepthFormat format;
+        glGetIntegerv(GL_SAMPLES, &format.Samples);
+        format.Attachment = stencilBits > 0 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        if (componentType == GL_FLOAT) {
+            format.InternalFormat = stencilBits > 0 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+            format.Format = stencilBits > 0 ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT;
+            format.Type = stencilBits > 0 ? GL_FLOAT_32_UNSIGNED_INT_24_8_REV : GL_FLOAT;
+        } else if (stencilBits > 0) {
+            format.InternalFormat = GL_DEPTH24_STENCIL8;
+            format.Format = GL_DEPTH_STENCIL;
+            format.Type = GL_UNSIGNED_INT_24_8;
+        } else {
+            format.InternalFormat = depthBits <= 16 ? GL_DEPTH_COMPONENT16
+                                                    : depthBits <= 24 ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT32;
+            format.Format = GL_DEPTH_COMPONENT;
+            format.Type = depthBits <= 16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        }
+        return format;
+    }
+
+    Shader &DepthPyramid::ReduceProgram() {
+        static Shader program("FullscreenTriangle.vert", "DepthReduce.frag");
+        return program;
+    }
+
+    Shader &DepthPyramid::ReprojectProgram() {
+        static Shader program("DepthReproject.vert", "DepthReproject.frag");
+        return program;
+    }
+
+    int DepthPyramid::LevelCount(glm::ivec2 size) {
+        int count = 1;
+        for (int extent = std::max(size.x, size.y); extent > 1; extent >>= 1)
+            count++;
+        return count;
+    }
+
+    glm::ivec2 DepthPyramid::LevelSize(glm::ivec2 size, int level) {
+        return glm::max(size >> level, glm::ivec2(1));
+    }
+
+    int DepthPyramid::LevelFor(glm::ivec2 size, int maxWidth) {
+        const int count = LevelCount(size);
+        int level = 0;
+        while (level + 1 < count && LevelSize(size, level).x > maxWidth)
+            level++;
+        return level;
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Shader.hpp"
+#include "Core/OcclusionBuffer.hpp"
+#include "glm/glm.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Graphics {
+    // Min and max window depth of the last frame's opaque pass in a mip chain, for occlusion tests in the next
+    // frame. Capture copies the depth buffer, sample for sample when it is multisampled, and reduces it level by
+    // level with a fragment pass that folds every sample into the min and max; Reproject draws a
+    // level of that history as one quad per texel seen from the current camera and reduces the result again into
+    // the pyramid HiZ.glsl samples. Capture also reads a small level back without stalling, one or two frames late,
+    // for the CPU tests of OcclusionBuffer. Texels nothing was drawn into, and the gaps disocclusion opens between
+    // reprojected quads, stay at the far plane, so the tests err towards drawing. GL thread only.
+    class DepthPyramid {
+    public:
+        // Width of the history level reprojected each frame, and of the one read back.
+        static constexpr int ReprojectedWidth = 320;
+        static constexpr int ReadbackWidth = 160;
+
+        DepthPyramid();
+
+        DepthPyramid(const DepthPyramid &) = delete;
+
+        DepthPyramid &operator=(const DepthPyramid &) = delete;
+
+        ~DepthPyramid();
+
+        // Keeps the depth the default framebuffer holds, drawn through viewProjection, for the next frame. Call it
+        // once the static opaque geometry is drawn and before anything that moves, whose depth would be stale by the
+        // time it is tested. Restores the default framebuffer and the viewport.
+        void Capture(const glm::mat4 &viewProjection);
+
+        // Builds the pyramid for a camera about to draw; false until something was captured. Restores the default
+        // framebuffer and the viewport.
+        bool Reproject(const glm::mat4 &viewProjection);
+
+        // Rasterizes the newest finished readback into occlusion as seen through viewProjection; false while none
+        // has arrived.
+        bool ReprojectInto(Core::OcclusionBuffer &occlusion, const glm::mat4 &viewProjection);
+
+        // Sets the uniforms of HiZ.glsl on the program in use, turning the test off until Reproject succeeded.
+        void Bind(const Shader &shader, GLuint unit) const;
+
+    private:
+        static constexpr std::size_t ReadbackCount = 2;
+
+        struct Readback {
+            GLuint Buffer{};
+            GLsync Fence{};
+            std::uint64_t Capture{};
+            glm::mat4 ViewProjection{};
+            int Width{};
+            int Height{};
+        };
+
+        struct DepthVertex {
+            glm::vec3 Position;
+        };
+
+        // Depth of the default framebuffer, which the copy has to match for the blit; Samples is 0 when it is not
+        // multisampled and InternalFormat 0 when it has no depth.
+        struct DepthFormat {
+            GLint InternalFormat{};
+            GLenum Format{};
+            GLenum Type{};
+            GLenum Attachment{};
+            GLint Samples{};
+        };
+
+        enum class ReduceSource {
+            Level,
+            Depth,
+            MultisampledDepth
+        };
+
+        GLuint _vertexArray{};
+        GLuint _copyFramebuffer{};
+        GLuint _reprojectFramebuffer{};
+        GLuint _reduceFramebuffer{};
+        GLuint _depthTexture{};
+        GLuint _multisampledDepth{};
+        GLuint _history{};
+        GLuint _reprojected{};
+        GLuint _pyramid{};
+        int _width{};
+        int _height{};
+        // A multisampled blit cannot move pixels, so the copy keeps the viewport's offset.
+        glm::ivec2 _origin{};
+        DepthFormat _depthFormat{};
+        // History level 0 is half the viewport.
+        glm::ivec2 _historySize{};
+        int _historyLevels{};
+        int _reprojectedLevel{};
+        int _readbackLevel{};
+        int _pyramidLevels{};
+        bool _captured = false;
+        bool _ready = false;
+        glm::mat4 _capturedViewProjection{};
+        glm::mat4 _viewProjection{};
+        std::array<Readback, ReadbackCount> _readbacks{};
+        std::size_t _nextReadback = 0;
+        std::uint64_t _captureCount = 0;
+        // The last readback that arrived, as quads in its normalized device coordinates.
+        std::vector<DepthVertex> _vertices;
+        std::vector<unsigned int> _indices;
+        glm::mat4 _occluderModel{};
+        bool _hasOccluders = false;
+
+        // Sizes every texture for a viewport and the default framebuffer's depth, dropping the history.
+        void Allocate(glm::ivec2 origin, int width, int height);
+
+        // Draws level of target from source, a depth texture or the level below in target, halved or copied.
+        // origin is where the region starts in source.
+        void ReducePass(GLuint source, ReduceSource kind, glm::ivec2 origin, bool halve, GLuint target, int level,
+                        glm::ivec2 size) const;
+
+        // Halves levels 1 to levelCount - 1 of a chain whose level 0 is already written, then opens every level to
+        // sampling again.
+        void ReduceChain(GLuint texture, int levelCount, glm::ivec2 size) const;
+
+        void StartReadback(const glm::mat4 &viewProjection);
+
+        // Turns the newest finished readback into occluder quads and frees every finished slot.
+        void ConsumeReadback();
+
+        static DepthFormat DefaultDepthFormat();
+
+        static Shader &ReduceProgram();
+
+        static Shader &ReprojectProgram();
+
+        static int LevelCount(glm::ivec2 size);
+
+        static glm::ivec2 LevelSize(glm::ivec2 size, int level);
+
+        // The first level of a chain whose level 0 is size that is at most maxWidth wide.
+        static int LevelFor(glm::ivec2 size, int maxWidth);
+    };
+}
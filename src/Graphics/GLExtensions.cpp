@@ -0,0 +1,101 @@
+#include "GLExtensions.hpp"
+#include "Log.hpp"
+
+namespace Graphics {
+
+    void GLExtensions::Load(GLADloadproc load) {
+        glGetIntegerv(GL_MAJOR_VERSION, &MajorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &MinorVersion);
+
+        TextureCompressionS3TC = Has("GL_EXT_texture_compression_s3tc");
+        TextureCompressionBPTC = IsVersionAtLeast(4, 2) || Has("GL_ARB_texture_compression_bptc");
+
+        const auto driverString = [](GLenum name) {
+            const auto value = reinterpret_cast<const char *>(glGetString(name));
+            return std::string(value ? value : "");
+        };
+        Driver = driverString(GL_VENDOR) + '|' + driverString(GL_RENDERER) + '|' + driverString(GL_VERSION);
+
+        // Indirect draws read baseInstance only from GL 4.2 on, and the per-draw records depend on it.
+        if (IsVersionAtLeast(4, 2) || Has("GL_ARB_base_instance")) {
+            DrawElementsInstancedBaseVertexBaseInstance =
+                    reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC>(
+                            load("glDrawElementsInstancedBaseVertexBaseInstance"));
+            if (IsVersionAtLeast(4, 0) || Has("GL_ARB_draw_indirect"))
+                DrawElementsIndirect = reinterpret_cast<PFNGLDRAWELEMENTSINDIRECTPROC>(load("glDrawElementsIndirect"));
+            if (IsVersionAtLeast(4, 3) || Has("GL_ARB_multi_draw_indirect")) {
+                MultiDrawElementsIndirect = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>(
+                        load("glMultiDrawElementsIndirect"));
+            }
+        }
+
+        GLint binaryFormats = 0;
+        if (IsVersionAtLeast(4, 1) || Has("GL_ARB_get_program_binary"))
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+        if (binaryFormats > 0) {
+            GetProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+            ProgramBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(load("glProgramBinary"));
+            ProgramParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+        }
+
+        if (IsVersionAtLeast(4, 4) || Has("GL_ARB_multi_bind"))
+            BindTextures = reinterpret_cast<PFNGLBINDTEXTURESPROC>(load("glBindTextures"));
+        if (IsVersionAtLeast(4, 2) || Has("GL_ARB_texture_storage"))
+            TexStorage3D = reinterpret_cast<PFNGLTEXSTORAGE3DPROC>(load("glTexStorage3D"));
+        if (IsVersionAtLeast(4, 3) || Has("GL_ARB_copy_image"))
+            CopyImageSubData = reinterpret_cast<PFNGLCOPYIMAGESUBDATAPROC>(load("glCopyImageSubData"));
+        ShaderStorageBuffers = IsVersionAtLeast(4, 3) || Has("GL_ARB_shader_storage_buffer_object");
+        NonUniformSamplers = Has("GL_NV_gpu_shader5");
+        if (IsVersionAtLeast(4, 3) || Has("GL_ARB_compute_shader")) {
+            DispatchCompute = reinterpret_cast<PFNGLDISPATCHCOMPUTEPROC>(load("glDispatchCompute"));
+            Barrier = reinterpret_cast<PFNGLMEMORYBARRIERPROC>(load("glMemoryBarrier"));
+            if (!DispatchCompute || !Barrier) {
+                DispatchCompute = nullptr;
+                Barrier = nullptr;
+            }
+        }
+        if (IsVersionAtLeast(4, 6)) {
+            MultiDrawElementsIndirectCount = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC>(
+                    load("glMultiDrawElementsIndirectCount"));
+        } else if (Has("GL_ARB_indirect_parameters")) {
+            MultiDrawElementsIndirectCount = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC>(
+                    load("glMultiDrawElementsIndirectCountARB"));
+        }
+        if (Has("GL_ARB_bindless_texture")) {
+            GetTextureHandle = reinterpret_cast<PFNGLGETTEXTUREHANDLEARBPROC>(load("glGetTextureHandleARB"));
+            MakeTextureHandleResident = reinterpret_cast<PFNGLMAKETEXTUREHANDLERESIDENTARBPROC>(
+                    load("glMakeTextureHandleResidentARB"));
+            MakeTextureHandleNonResident = reinterpret_cast<PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC>(
+                    load("glMakeTextureHandleNonResidentARB"));
+            if (!GetTextureHandle || !MakeTextureHandleResident || !MakeTextureHandleNonResident) {
+                GetTextureHandle = nullptr;
+                MakeTextureHandleResident = nullptr;
+                MakeTextureHandleNonResident = nullptr;
+            }
+        }
+
+        Log::Information(fmt::format(
+                "GL {}.{} S3TC:{} BPTC:{} BaseInstance:{} Indirect:{} MultiDrawIndirect:{} ProgramBinary:{} "
+                "MultiBind:{} CopyImage:{} SSBO:{} Bindless:{} NonUniformSamplers:{} Compute:{} IndirectCount:{}",
+                MajorVersion, MinorVersion, TextureCompressionS3TC, TextureCompressionBPTC,
+                DrawElementsInstancedBaseVertexBaseInstance != nullptr, DrawElementsIndirect != nullptr,
+                MultiDrawElementsIndirect != nullptr, ProgramBinary != nullptr, BindTextures != nullptr,
+                CopyImageSubData != nullptr, ShaderStorageBuffers, GetTextureHandle != nullptr, NonUniformSamplers,
+                DispatchCompute != nullptr, MultiDrawElementsIndirectCount != nullptr));
+    }
+
+    bool GLExtensions::Has(std::string_view name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const auto extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && name == extension)
+                return true;
+        }
+        return false;
+    }
+
+    bool GLExtensions::IsVersionAtLeast(int major, int minor) {
+        return MajorVersion > major || (MajorVersion == major && MinorVersion >= minor);
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <string>
+#include <string_view>
+
+// glad is generated for GL 3.3 core without extensions; tokens from later versions and extensions live here.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)(GLenum mode, GLsizei count, GLenum type,
+                                                                               const void *indices,
+                                                                               GLsizei instancecount, GLint basevertex,
+                                                                               GLuint baseinstance);
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect,
+                                                             GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                                    GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary,
+                                                 GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLBINDTEXTURESPROC)(GLuint first, GLsizei count, const GLuint *textures);
+typedef void (APIENTRYP PFNGLTEXSTORAGE3DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width,
+                                               GLsizei height, GLsizei depth);
+typedef void (APIENTRYP PFNGLCOPYIMAGESUBDATAPROC)(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX,
+                                                   GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget,
+                                                   GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                                                   GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void *indirect,
+                                                                  GLintptr drawcount, GLsizei maxdrawcount,
+                                                                  GLsizei stride);
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+
+namespace Graphics {
+
+    // Loaded once on the GL thread right after glad; the flags are read-only afterwards and safe to read from workers.
+    class GLExtensions {
+    public:
+        static inline int MajorVersion = 0;
+        static inline int MinorVersion = 0;
+        static inline bool TextureCompressionS3TC = false;
+        static inline bool TextureCompressionBPTC = false;
+        // GL 4.3 or ARB_shader_storage_buffer_object.
+        static inline bool ShaderStorageBuffers = false;
+        // NV_gpu_shader5: samplers, bindless ones included, may come from values that are not dynamically uniform.
+        static inline bool NonUniformSamplers = false;
+
+        // Vendor, renderer and version strings; program binaries are only valid for the driver that made them.
+        static inline std::string Driver;
+
+        // Entry points past GL 3.3; null when the context does not provide them.
+        static inline PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC DrawElementsInstancedBaseVertexBaseInstance =
+                nullptr;
+        static inline PFNGLDRAWELEMENTSINDIRECTPROC DrawElementsIndirect = nullptr;
+        static inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+        // Set only when the driver also reports at least one binary format.
+        static inline PFNGLGETPROGRAMBINARYPROC GetProgramBinary = nullptr;
+        static inline PFNGLPROGRAMBINARYPROC ProgramBinary = nullptr;
+        static inline PFNGLPROGRAMPARAMETERIPROC ProgramParameteri = nullptr;
+        static inline PFNGLBINDTEXTURESPROC BindTextures = nullptr;
+        static inline PFNGLTEXSTORAGE3DPROC TexStorage3D = nullptr;
+        static inline PFNGLCOPYIMAGESUBDATAPROC CopyImageSubData = nullptr;
+        // GL 4.3 or ARB_compute_shader. Barrier is glMemoryBarrier, named apart from the Windows macro.
+        static inline PFNGLDISPATCHCOMPUTEPROC DispatchCompute = nullptr;
+        static inline PFNGLMEMORYBARRIERPROC Barrier = nullptr;
+        // GL 4.6 or ARB_indirect_parameters: the draw count is read from GL_PARAMETER_BUFFER.
+        static inline PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC MultiDrawElementsIndirectCount = nullptr;
+        // ARB_bindless_texture; all three or none.
+        static inline PFNGLGETTEXTUREHANDLEARBPROC GetTextureHandle = nullptr;
+        static inline PFNGLMAKETEXTUREHANDLERESIDENTARBPROC MakeTextureHandleResident = nullptr;
+        static inline PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC MakeTextureHandleNonResident = nullptr;
+
+        static void Load(GLADloadproc load);
+
+        static bool Has(std::string_view name);
+
+        static bool IsVersionAtLeast(int major, int minor);
+    };
+}
@@ -0,0 +1,112 @@
+#include "GeometryBuffer.hpp"
+#include "Mesh.hpp"
+#include "RenderState.hpp"
+#include <algorithm>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::size_t IndexAlignment = sizeof(std::uint32_t);
+    }
+
+    GeometryBuffer &GeometryBuffer::Shared(VertexFormat format) {
+        if (format == VertexFormat::Packed) {
+            static GeometryBuffer packed(VertexFormat::Packed, sizeof(PackedVertex));
+            return packed;
+        }
+        static GeometryBuffer standard(VertexFormat::Standard, sizeof(Vertex));
+        return standard;
+    }
+
+    GeometryBuffer::GeometryBuffer(VertexFormat format, std::size_t stride) : _format(format), _stride(stride) {
+        glGenVertexArrays(1, &_vertexArray);
+    }
+
+    GeometryBuffer::Handle GeometryBuffer::Allocate(const void *vertices, std::size_t vertexCount,
+                                                    const void *indices, std::size_t indexBytes) {
+        auto vertexOffset = _vertices.Allocate(vertexCount);
+        if (vertexOffset == Core::RangeAllocator::Invalid) {
+            GrowVertices(vertexCount);
+            vertexOffset = _vertices.Allocate(vertexCount);
+        }
+        auto indexOffset = _indices.Allocate(indexBytes, IndexAlignment);
+        if (indexOffset == Core::RangeAllocator::Invalid) {
+            GrowIndices(indexBytes);
+            indexOffset = _indices.Allocate(indexBytes, IndexAlignment);
+        }
+
+        // The copy targets leave the element binding of whatever VAO is bound untouched.
+        RenderState::Shared().BindBuffer(GL_COPY_WRITE_BUFFER, _vertexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertexOffset * _stride),
+                        static_cast<GLsizeiptr>(vertexCount * _stride), vertices);
+        RenderState::Shared().BindBuffer(GL_COPY_WRITE_BUFFER, _indexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexOffset), static_cast<GLsizeiptr>(indexBytes),
+                        indices);
+
+        return {new GeometryRange{static_cast<GLint>(vertexOffset), vertexCount, indexOffset, indexBytes},
+                [this](GeometryRange *range) { Release(range); }};
+    }
+
+    void GeometryBuffer::Release(GeometryRange *range) {
+        _vertices.Free(static_cast<std::size_t>(range->BaseVertex), range->VertexCount);
+        _indices.Free(range->IndexOffset, range->IndexBytes);
+        delete range;
+    }
+
+    void GeometryBuffer::Bind() const {
+        RenderState::Shared().BindVertexArray(_vertexArray);
+    }
+
+    void GeometryBuffer::ApplyLayout() const {
+        RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+        if (_format == VertexFormat::Packed)
+            PackedLayout::Apply();
+        else
+            StandardLayout::Apply();
+        RenderState::Shared().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+    }
+
+    std::uint64_t GeometryBuffer::Generation() const {
+        return _generation;
+    }
+
+    GLuint GeometryBuffer::VertexArray() const {
+        return _vertexArray;
+    }
+
+    void GeometryBuffer::GrowVertices(std::size_t vertexCount) {
+        const auto capacity = _vertices.Capacity();
+        const auto grown = std::max({capacity * 2, capacity + vertexCount, MinVertices});
+        Resize(_vertexBuffer, capacity * _stride, grown * _stride);
+        _vertices.Grow(grown);
+        _generation++;
+
+        RenderState::Shared().BindVertexArray(_vertexArray);
+        ApplyLayout();
+    }
+
+    void GeometryBuffer::GrowIndices(std::size_t indexBytes) {
+        const auto capacity = _indices.Capacity();
+        const auto grown = std::max({capacity * 2, capacity + indexBytes + IndexAlignment, MinIndexBytes});
+        Resize(_indexBuffer, capacity, grown);
+        _indices.Grow(grown);
+        _generation++;
+
+        RenderState::Shared().BindVertexArray(_vertexArray);
+        ApplyLayout();
+    }
+
+    void GeometryBuffer::Resize(GLuint &buffer, std::size_t oldBytes, std::size_t newBytes) {
+        GLuint resized{};
+        glGenBuffers(1, &resized);
+        RenderState::Shared().BindBuffer(GL_COPY_WRITE_BUFFER, resized);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newBytes), nullptr, GL_STATIC_DRAW);
+        if (buffer && oldBytes > 0) {
+            RenderState::Shared().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldBytes));
+        }
+        if (buffer)
+            RenderState::Shared().DeleteBuffer(buffer);
+        buffer = resized;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Core/RangeAllocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Graphics {
+    enum class VertexFormat;
+
+    // A mesh's slice of the shared buffers. BaseVertex counts vertices, IndexOffset counts bytes and is 4-aligned,
+    // so 16- and 32-bit indices can live side by side.
+    struct GeometryRange {
+        GLint BaseVertex{};
+        std::size_t VertexCount{};
+        std::size_t IndexOffset{};
+        std::size_t IndexBytes{};
+    };
+
+    // One vertex buffer, one index buffer and one VAO per vertex format, suballocated by every static mesh so
+    // draws of different meshes need no buffer or VAO switches. Buffers double when full. GL thread only.
+    class GeometryBuffer {
+    public:
+        using Handle = std::shared_ptr<const GeometryRange>;
+
+        GeometryBuffer(const GeometryBuffer &) = delete;
+
+        GeometryBuffer &operator=(const GeometryBuffer &) = delete;
+
+        static GeometryBuffer &Shared(VertexFormat format);
+
+        // Copies vertexCount vertices and indexBytes of indices in; the range is freed with the last handle.
+        Handle Allocate(const void *vertices, std::size_t vertexCount, const void *indices, std::size_t indexBytes);
+
+        // Binds the shared VAO, for per-mesh draws.
+        void Bind() const;
+
+        // Points the bound VAO at the shared buffers, for VAOs that add their own instanced streams.
+        void ApplyLayout() const;
+
+        // Bumped whenever a buffer is reallocated; VAOs set up with ApplyLayout must apply it again.
+        [[nodiscard]] std::uint64_t Generation() const;
+
+        [[nodiscard]] GLuint VertexArray() const;
+
+    private:
+        static constexpr std::size_t MinVertices = 1 << 16;
+        static constexpr std::size_t MinIndexBytes = 1 << 20;
+
+        VertexFormat _format;
+        std::size_t _stride;
+        GLuint _vertexArray{};
+        GLuint _vertexBuffer{};
+        GLuint _indexBuffer{};
+        Core::RangeAllocator _vertices;
+        Core::RangeAllocator _indices;
+        std::uint64_t _generation{};
+
+        GeometryBuffer(VertexFormat format, std::size_t stride);
+
+        void Release(GeometryRange *range);
+
+        void GrowVertices(std::size_t vertexCount);
+
+        void GrowIndices(std::size_t indexBytes);
+
+        // Reallocates buffer at the new size and copies the old contents over.
+        static void Resize(GLuint &buffer, std::size_t oldBytes, std::size_t newBytes);
+    };
+}
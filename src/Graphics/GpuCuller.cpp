@@ -0,0 +1,297 @@
+#include "GpuCuller.hpp"
+#include "DepthPyramid.hpp"
+#include "GLExtensions.hpp"
+#include "IndirectDrawList.hpp"
+#include "RenderState.hpp"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::array<UniformId, 6> FrustumPlanes = {
+                "frustumPlanes[0]", "frustumPlanes[1]", "frustumPlanes[2]",
+                "frustumPlanes[3]", "frustumPlanes[4]", "frustumPlanes[5]"
+        };
+
+        std::uint64_t BatchKey(const Mesh &mesh, bool byMaterial) {
+            const std::uint64_t indexType = mesh.IndexType == GL_UNSIGNED_INT ? 1u : 0u;
+            return byMaterial ? static_cast<std::uint64_t>(mesh.MaterialIndex) << 1 | indexType : indexType;
+        }
+    }
+
+    GpuCuller::GpuCuller() {
+        for (auto &table: _tables) {
+            glGenBuffers(1, &table.MeshBuffer);
+            glGenBuffers(1, &table.CommandBuffer);
+            glGenBuffers(1, &table.BatchBuffer);
+            glGenBuffers(1, &table.CountBuffer);
+        }
+        glGenBuffers(1, &_meshletBuffer);
+        glGenBuffers(1, &_statsBuffer);
+        for (auto &readback: _statsReadbacks)
+            glGenBuffers(1, &readback.Buffer);
+
+        auto &state = RenderState::Shared();
+        constexpr StatsTotals zero{};
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, _statsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), zero.data(), GL_DYNAMIC_COPY);
+        for (const auto &readback: _statsReadbacks) {
+            state.BindBuffer(GL_COPY_WRITE_BUFFER, readback.Buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, sizeof(StatsTotals), nullptr, GL_STREAM_READ);
+        }
+    }
+
+    GpuCuller::~GpuCuller() {
+        auto &state = RenderState::Shared();
+        for (auto &readback: _statsReadbacks) {
+            if (readback.Fence)
+                glDeleteSync(readback.Fence);
+            state.DeleteBuffer(readback.Buffer);
+        }
+        state.DeleteBuffer(_statsBuffer);
+        state.DeleteBuffer(_meshletBuffer);
+        for (auto &table: _tables) {
+            state.DeleteBuffer(table.CountBuffer);
+            state.DeleteBuffer(table.BatchBuffer);
+            state.DeleteBuffer(table.CommandBuffer);
+            state.DeleteBuffer(table.MeshBuffer);
+        }
+    }
+
+    bool GpuCuller::IsSupported() {
+        return IndirectDrawList::IsSupported() && GLExtensions::DispatchCompute && GLExtensions::ShaderStorageBuffers;
+    }
+
+    std::span<const GpuCuller::Batch> GpuCuller::Prepare(std::span<const Mesh> meshes, bool byMaterial) {
+        _table = &_tables[byMaterial ? 1 : 0];
+        auto &table = *_table;
+        if (meshes.size() == table.MeshCount)
+            return table.Batches;
+        table.MeshCount = meshes.size();
+        PrepareMeshlets(meshes);
+
+        std::vector<std::uint32_t> order(meshes.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return BatchKey(meshes[a], byMaterial) < BatchKey(meshes[b], byMaterial);
+        });
+
+        std::vector<std::uint32_t> firstMeshlet(meshes.size());
+        for (std::size_t i = 1; i < meshes.size(); i++)
+            firstMeshlet[i] = firstMeshlet[i - 1] + static_cast<std::uint32_t>(meshes[i - 1].Meshlets.size());
+
+        std::vector<GpuDrawMesh> entries(meshes.size());
+        std::vector<std::uint32_t> batchFirst;
+        std::uint32_t commandCount = 0;
+        table.Batches.clear();
+        for (std::uint32_t position = 0; position < order.size(); position++) {
+            const auto index = order[position];
+            const auto &mesh = meshes[index];
+            if (position == 0 || BatchKey(mesh, byMaterial) != BatchKey(meshes[order[position - 1]], byMaterial)) {
+                table.Batches.push_back({mesh.MaterialIndex, mesh.IndexType, commandCount, 0});
+                batchFirst.push_back(commandCount);
+            }
+
+            auto &entry = entries[index];
+            entry.BoundsMin = glm::vec4(mesh.BoundsMin, mesh.BoundsRadius());
+            entry.BoundsMax = glm::vec4(mesh.BoundsMax, 0.0f);
+            entry.LodCount = static_cast<std::uint32_t>(std::min(mesh.Lods.size(), MaxMeshLods));
+            for (std::uint32_t lod = 0; lod < entry.LodCount; lod++) {
+                entry.Lods[lod] = {mesh.FirstIndex() + mesh.Lods[lod].FirstIndex, mesh.Lods[lod].IndexCount,
+                                   std::bit_cast<std::uint32_t>(mesh.Lods[lod].Error), 0};
+            }
+            entry.BaseVertex = mesh.BaseVertex();
+            entry.Record = index;
+            entry.Batch = static_cast<std::uint32_t>(table.Batches.size() - 1);
+            entry.Slot = table.Batches.back().CommandCount;
+            entry.FirstMeshlet = firstMeshlet[index];
+            entry.MeshletCount = static_cast<std::uint32_t>(mesh.Meshlets.size());
+
+            const auto slots = std::max(entry.MeshletCount, 1u);
+            table.Batches.back().CommandCount += slots;
+            commandCount += slots;
+        }
+
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, table.MeshBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(entries.size() * sizeof(GpuDrawMesh)),
+                     entries.data(), GL_STATIC_DRAW);
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, table.BatchBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(batchFirst.size() * sizeof(std::uint32_t)),
+                     batchFirst.data(), GL_STATIC_DRAW);
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, table.CommandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER,
+                     static_cast<GLsizeiptr>(commandCount * sizeof(DrawElementsIndirectCommand)), nullptr,
+                     GL_DYNAMIC_DRAW);
+        table.ZeroCounts.assign(table.Batches.size(), 0);
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, table.CountBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER,
+                     static_cast<GLsizeiptr>(table.ZeroCounts.size() * sizeof(std::uint32_t)), nullptr,
+                     GL_DYNAMIC_DRAW);
+        return table.Batches;
+    }
+
+    void GpuCuller::PrepareMeshlets(std::span<const Mesh> meshes) {
+        if (meshes.size() == _meshletMeshCount)
+            return;
+        _meshletMeshCount = meshes.size();
+
+        std::vector<GpuDrawMeshlet> entries;
+        for (const auto &mesh: meshes) {
+            for (const auto &meshlet: mesh.Meshlets) {
+                GpuDrawMeshlet entry{};
+                entry.Sphere = glm::vec4(meshlet.Center, meshlet.Radius);
+                entry.BoundsMin = glm::vec4(meshlet.BoundsMin, 0.0f);
+                entry.BoundsMax = glm::vec4(meshlet.BoundsMax, 0.0f);
+                entry.Cone = glm::vec4(meshlet.ConeAxis, meshlet.ConeCutoff);
+                entry.ConeApex = meshlet.ConeApex;
+                entry.FirstIndex = mesh.FirstIndex() + meshlet.FirstIndex;
+                entry.IndexCount = meshlet.IndexCount;
+                entries.push_back(entry);
+            }
+        }
+        // A buffer without storage cannot be bound, so a model without meshlets still gets one unread entry.
+        if (entries.empty())
+            entries.emplace_back();
+
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_SHADER_STORAGE_BUFFER, _meshletBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(entries.size() * sizeof(GpuDrawMeshlet)),
+                     entries.data(), GL_STATIC_DRAW);
+    }
+
+    Core::CullStats GpuCuller::Cull(const RenderView &view, const glm::mat4 &model) {
+        const auto stats = ConsumeStatsReadbacks();
+        const auto &table = *_table;
+        if (table.MeshCount == 0)
+            return stats;
+
+        auto &state = RenderState::Shared();
+        const bool compact = Compacts();
+        if (compact) {
+            state.BindBuffer(GL_SHADER_STORAGE_BUFFER, table.CountBuffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                            static_cast<GLsizeiptr>(table.ZeroCounts.size() * sizeof(std::uint32_t)),
+                            table.ZeroCounts.data());
+        }
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, MeshBinding, table.MeshBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandBinding, table.CommandBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, BatchBinding, table.BatchBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, CountBinding, table.CountBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, MeshletBinding, _meshletBuffer);
+        state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, StatsBinding, _statsBuffer);
+
+        const auto &program = Program();
+        program.Use();
+        const auto frustum = view.Frustum.Transformed(model);
+        for (std::size_t i = 0; i < FrustumPlanes.size(); i++) {
+            const auto &plane = frustum.Planes[i];
+            program.SetVec4(FrustumPlanes[i], plane.x, plane.y, plane.z, plane.w);
+        }
+        const auto camera = glm::vec3(glm::inverse(model) * glm::vec4(view.Position, 1.0f));
+        program.SetInt("meshCount", static_cast<int>(table.MeshCount));
+        program.SetMat4("model", model);
+        program.SetVec3("viewPosition", view.Position.x, view.Position.y, view.Position.z);
+        program.SetVec3("cameraPosition", camera.x, camera.y, camera.z);
+        program.SetFloat("projectionScale", view.ProjectionScale);
+        program.SetFloat("lodThreshold", view.LodThreshold);
+        program.SetBool("backfaceCulling", view.BackfaceCulling);
+        program.SetBool("compact", compact);
+        if (view.Pyramid)
+            view.Pyramid->Bind(program, HiZUnit);
+        else
+            program.SetBool("hiZEnabled", false);
+
+        const auto groups = static_cast<GLuint>((table.MeshCount + GroupSize - 1) / GroupSize);
+        GLExtensions::DispatchCompute(groups, 1, 1);
+        GLExtensions::Barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        StartStatsReadback();
+        return stats;
+    }
+
+    void GpuCuller::StartStatsReadback() {
+        auto &readback = _statsReadbacks[_nextStatsReadback];
+        if (readback.Fence) {
+            if (glClientWaitSync(readback.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                return;
+            glDeleteSync(readback.Fence);
+            readback.Fence = nullptr;
+        }
+
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_COPY_READ_BUFFER, _statsBuffer);
+        state.BindBuffer(GL_COPY_WRITE_BUFFER, readback.Buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(StatsTotals));
+        readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.Sequence = ++_statsSequence;
+        _nextStatsReadback = (_nextStatsReadback + 1) % StatsReadbackCount;
+    }
+
+    Core::CullStats GpuCuller::ConsumeStatsReadbacks() {
+        StatsReadback *newest = nullptr;
+        for (auto &readback: _statsReadbacks) {
+            if (!readback.Fence)
+                continue;
+            const auto status = glClientWaitSync(readback.Fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                continue;
+            glDeleteSync(readback.Fence);
+            readback.Fence = nullptr;
+            if (status != GL_WAIT_FAILED && readback.Sequence > _reportedSequence &&
+                (!newest || readback.Sequence > newest->Sequence))
+                newest = &readback;
+        }
+        if (!newest)
+            return {};
+
+        StatsTotals totals{};
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_COPY_READ_BUFFER, newest->Buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(totals), totals.data());
+
+        // Unsigned differences stay right across the wrap of the totals.
+        const Core::CullStats stats{totals[0] - _reportedTotals[0], totals[1] - _reportedTotals[1]};
+        _reportedTotals = totals;
+        _reportedSequence = newest->Sequence;
+        return stats;
+    }
+
+    void GpuCuller::Bind() const {
+        auto &state = RenderState::Shared();
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, _table->CommandBuffer);
+        if (Compacts())
+            state.BindBuffer(GL_PARAMETER_BUFFER, _table->CountBuffer);
+    }
+
+    void GpuCuller::Draw(const Batch &batch) const {
+        const auto stride = sizeof(DrawElementsIndirectCommand);
+        const auto commands = reinterpret_cast<const void *>(batch.FirstCommand * stride);
+        if (Compacts()) {
+            const auto batchIndex = static_cast<std::size_t>(&batch - _table->Batches.data());
+            GLExtensions::MultiDrawElementsIndirectCount(GL_TRIANGLES, batch.IndexType, commands,
+                                                         static_cast<GLintptr>(batchIndex * sizeof(std::uint32_t)),
+                                                         static_cast<GLsizei>(batch.CommandCount), 0);
+            return;
+        }
+        if (GLExtensions::MultiDrawElementsIndirect) {
+            GLExtensions::MultiDrawElementsIndirect(GL_TRIANGLES, batch.IndexType, commands,
+                                                    static_cast<GLsizei>(batch.CommandCount), 0);
+            return;
+        }
+        for (std::uint32_t i = 0; i < batch.CommandCount; i++) {
+            GLExtensions::DrawElementsIndirect(GL_TRIANGLES, batch.IndexType,
+                                               reinterpret_cast<const void *>((batch.FirstCommand + i) * stride));
+        }
+    }
+
+    Shader &GpuCuller::Program() {
+        static Shader program("CullDraws.comp");
+        return program;
+    }
+
+    bool GpuCuller::Compacts() {
+        return GLExtensions::MultiDrawElementsIndirectCount != nullptr;
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Mesh.hpp"
+#include "RenderView.hpp"
+#include "Shader.hpp"
+#include "Core/BoundsCulling.hpp"
+#include "glm/glm.hpp"
+#include "glm/ext/vector_uint4_sized.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Per-mesh input of CullDraws.comp, in its std430 layout. Lods hold the first index in the shared element
+    // buffer, the index count and the error bits; BoundsMin.w is the bounding sphere radius. A mesh owns one command
+    // slot per meshlet, or one without meshlets, starting at Slot.
+    struct GpuDrawMesh {
+        glm::vec4 BoundsMin;
+        glm::vec4 BoundsMax;
+        std::array<glm::u32vec4, MaxMeshLods> Lods;
+        std::int32_t BaseVertex;
+        std::uint32_t Record;
+        std::uint32_t Batch;
+        // Command within the batch when draws are not compacted.
+        std::uint32_t Slot;
+        std::uint32_t LodCount;
+        std::uint32_t FirstMeshlet;
+        std::uint32_t MeshletCount;
+        std::uint32_t Padding;
+    };
+
+    static_assert(sizeof(GpuDrawMesh) == 128);
+
+    // Per-meshlet input of CullDraws.comp, in its std430 layout; the bounds of Meshlet with FirstIndex made absolute
+    // in the shared element buffer. Cone.w is the cone cutoff.
+    struct GpuDrawMeshlet {
+        glm::vec4 Sphere;
+        glm::vec4 BoundsMin;
+        glm::vec4 BoundsMax;
+        glm::vec4 Cone;
+        glm::vec3 ConeApex;
+        std::uint32_t FirstIndex;
+        std::uint32_t IndexCount;
+        std::array<std::uint32_t, 3> Padding;
+    };
+
+    static_assert(sizeof(GpuDrawMeshlet) == 96);
+
+    // Frustum culling and level selection for the meshes of one model in a compute pass. The mesh table stays on the
+    // GPU and visible meshes are written as indirect commands grouped into batches like IndirectDrawList's; with
+    // indirect-count draws each batch is compacted through an atomic counter, otherwise culled commands draw no
+    // instances. Meshes hidden behind the view's depth pyramid are culled too, and meshes drawn at level 0 are split
+    // into their visible meshlets as on the CPU path. A table is kept for each grouping, so passes that alternate
+    // between them do not rebuild it. Record i of the caller's draw records must belong to mesh i.
+    class GpuCuller {
+    public:
+        struct Batch {
+            std::uint32_t MaterialIndex;
+            GLenum IndexType;
+            std::uint32_t FirstCommand;
+            std::uint32_t CommandCount;
+        };
+
+        GpuCuller();
+
+        GpuCuller(const GpuCuller &) = delete;
+
+        GpuCuller &operator=(const GpuCuller &) = delete;
+
+        ~GpuCuller();
+
+        // Needs compute shaders and shader storage buffers (GL 4.3) on top of indirect draws.
+        static bool IsSupported();
+
+        // Selects the table of a grouping, uploading it when meshes were added since it was built; meshes keep their
+        // place in the shared geometry buffer, so nothing else invalidates it.
+        std::span<const Batch> Prepare(std::span<const Mesh> meshes, bool byMaterial);
+
+        // Dispatches the culling pass and waits on it before the draws read the commands. Leaves the compute program
+        // bound. Returns the meshes kept and culled by earlier passes whose counts arrived since the last call, a
+        // frame or two late, as they are read back without stalling.
+        Core::CullStats Cull(const RenderView &view, const glm::mat4 &model);
+
+        // Binds the command buffer, and the counts when draws are compacted, for Draw; the VAO is the caller's.
+        void Bind() const;
+
+        // Takes a batch from the last Prepare, whose position selects its count.
+        void Draw(const Batch &batch) const;
+
+    private:
+        static constexpr GLuint MeshBinding = 1;
+        static constexpr GLuint CommandBinding = 2;
+        static constexpr GLuint BatchBinding = 3;
+        static constexpr GLuint CountBinding = 4;
+        static constexpr GLuint MeshletBinding = 5;
+        static constexpr GLuint StatsBinding = 6;
+        static constexpr GLuint GroupSize = 64;
+        // Past the units materials take.
+        static constexpr GLuint HiZUnit = 16;
+        static constexpr std::size_t StatsReadbackCount = 3;
+
+        struct Table {
+            GLuint MeshBuffer{};
+            GLuint CommandBuffer{};
+            GLuint BatchBuffer{};
+            GLuint CountBuffer{};
+            std::size_t MeshCount{};
+            std::vector<Batch> Batches;
+            std::vector<std::uint32_t> ZeroCounts;
+        };
+
+        // Running totals of visible and culled meshes, which wrap; only differences between readbacks are used.
+        using StatsTotals = std::array<std::uint32_t, 2>;
+
+        struct StatsReadback {
+            GLuint Buffer{};
+            GLsync Fence{};
+            std::uint64_t Sequence{};
+        };
+
+        // Indexed by the byMaterial of Prepare.
+        std::array<Table, 2> _tables{};
+        Table *_table = &_tables[1];
+        GLuint _meshletBuffer{};
+        std::size_t _meshletMeshCount{};
+        GLuint _statsBuffer{};
+        std::array<StatsReadback, StatsReadbackCount> _statsReadbacks{};
+        std::size_t _nextStatsReadback = 0;
+        std::uint64_t _statsSequence = 0;
+        std::uint64_t _reportedSequence = 0;
+        StatsTotals _reportedTotals{};
+
+        // Uploads the meshlets of every mesh, shared by both tables.
+        void PrepareMeshlets(std::span<const Mesh> meshes);
+
+        // Copies the running totals into a free readback slot, leaving busy slots alone.
+        void StartStatsReadback();
+
+        // What the totals of the newest finished readback add to the ones reported before.
+        Core::CullStats ConsumeStatsReadbacks();
+
+        static Shader &Program();
+
+        static bool Compacts();
+    };
+}
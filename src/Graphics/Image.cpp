@@ -0,0 +1,65 @@
+#include "Image.hpp"
+#include "Core/Scheduler.hpp"
+#include "FileSystem.hpp"
+#include "stb_image.h"
+
+namespace Graphics {
+
+    Image Image::Decode(const std::string &path, bool flipVertically) {
+        const auto file = FileSystem::Shared().Open(path);
+        if (!file.IsOpen())
+            return {};
+        return Decode(file.Data(), flipVertically);
+    }
+
+    Image Image::Decode(std::span<const std::byte> encoded, bool flipVertically) {
+        stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+        Image image;
+        image._pixels.reset(stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(encoded.data()),
+                                                  static_cast<int>(encoded.size()),
+                                                  &image.Width, &image.Height, &image.Channels, 0));
+        return image;
+    }
+
+    Core::Task<Image> Image::DecodeAsync(std::string path, bool flipVertically) {
+        co_await Core::Scheduler::WorkerThread();
+        co_return Decode(path, flipVertically);
+    }
+
+    bool Image::IsValid() const {
+        return _pixels != nullptr;
+    }
+
+    const unsigned char *Image::Pixels() const {
+        return _pixels.get();
+    }
+
+    GLenum Image::DataFormat() const {
+        switch (Channels) {
+            case 1:
+                return GL_RED;
+            case 2:
+                return GL_RG;
+            case 3:
+                return GL_RGB;
+            default:
+                return GL_RGBA;
+        }
+    }
+
+    GLenum Image::InternalFormat(bool gammaCorrection) const {
+        switch (Channels) {
+            case 3:
+                return gammaCorrection ? GL_SRGB : GL_RGB;
+            case 4:
+                return gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
+            default:
+                return DataFormat();
+        }
+    }
+
+    void Image::PixelsDeleter::operator()(unsigned char *pixels) const {
+        stbi_image_free(pixels);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Core/Task.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace Graphics {
+
+    // CPU-side decoded pixels. Decoding is thread-safe; uploading must happen on the GL thread.
+    class Image {
+    public:
+        int Width{};
+        int Height{};
+        int Channels{};
+
+        static Image Decode(const std::string &path, bool flipVertically);
+
+        static Image Decode(std::span<const std::byte> encoded, bool flipVertically);
+
+        static Core::Task<Image> DecodeAsync(std::string path, bool flipVertically);
+
+        [[nodiscard]] bool IsValid() const;
+
+        [[nodiscard]] const unsigned char *Pixels() const;
+
+        [[nodiscard]] GLenum DataFormat() const;
+
+        [[nodiscard]] GLenum InternalFormat(bool gammaCorrection) const;
+
+    private:
+        struct PixelsDeleter {
+            void operator()(unsigned char *pixels) const;
+        };
+
+        std::unique_ptr<unsigned char, PixelsDeleter> _pixels;
+    };
+}
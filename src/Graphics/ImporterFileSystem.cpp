@@ -0,0 +1,77 @@
+#include "ImporterFileSystem.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Graphics {
+
+    bool ImporterFileSystem::Exists(const char *path) const {
+        return FileSystem::Shared().Exists(path);
+    }
+
+    char ImporterFileSystem::getOsSeparator() const {
+        return '/';
+    }
+
+    Assimp::IOStream *ImporterFileSystem::Open(const char *path, const char *mode) {
+        if (mode && (std::strchr(mode, 'w') || std::strchr(mode, 'a')))
+            return nullptr;
+        auto view = FileSystem::Shared().Find(path);
+        if (!view.IsOpen())
+            return nullptr;
+        return new FileViewStream(std::move(view));
+    }
+
+    void ImporterFileSystem::Close(Assimp::IOStream *stream) {
+        delete stream;
+    }
+
+    FileViewStream::FileViewStream(FileView view) : _view(std::move(view)) {
+    }
+
+    std::size_t FileViewStream::Read(void *buffer, std::size_t size, std::size_t count) {
+        if (size == 0)
+            return 0;
+        const auto data = _view.Data();
+        const auto available = (data.size() - _position) / size;
+        const auto read = std::min(count, available);
+        std::memcpy(buffer, data.data() + _position, read * size);
+        _position += read * size;
+        return read;
+    }
+
+    std::size_t FileViewStream::Write(const void *, std::size_t, std::size_t) {
+        return 0;
+    }
+
+    aiReturn FileViewStream::Seek(std::size_t offset, aiOrigin origin) {
+        std::size_t position;
+        switch (origin) {
+            case aiOrigin_SET:
+                position = offset;
+                break;
+            case aiOrigin_CUR:
+                position = _position + offset;
+                break;
+            case aiOrigin_END:
+                position = _view.Data().size() - offset;
+                break;
+            default:
+                return aiReturn_FAILURE;
+        }
+        if (position > _view.Data().size())
+            return aiReturn_FAILURE;
+        _position = position;
+        return aiReturn_SUCCESS;
+    }
+
+    std::size_t FileViewStream::Tell() const {
+        return _position;
+    }
+
+    std::size_t FileViewStream::FileSize() const {
+        return _view.Data().size();
+    }
+
+    void FileViewStream::Flush() {
+    }
+}
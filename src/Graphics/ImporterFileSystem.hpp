@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FileSystem.hpp"
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+#include <cstddef>
+
+namespace Graphics {
+    // Lets Assimp read a model and the files it references (materials, external buffers) through the mounted
+    // file system, straight out of mapped memory.
+    class ImporterFileSystem final : public Assimp::IOSystem {
+    public:
+        bool Exists(const char *path) const override;
+
+        char getOsSeparator() const override;
+
+        Assimp::IOStream *Open(const char *path, const char *mode) override;
+
+        void Close(Assimp::IOStream *stream) override;
+    };
+
+    class FileViewStream final : public Assimp::IOStream {
+    public:
+        explicit FileViewStream(FileView view);
+
+        std::size_t Read(void *buffer, std::size_t size, std::size_t count) override;
+
+        std::size_t Write(const void *buffer, std::size_t size, std::size_t count) override;
+
+        aiReturn Seek(std::size_t offset, aiOrigin origin) override;
+
+        std::size_t Tell() const override;
+
+        std::size_t FileSize() const override;
+
+        void Flush() override;
+
+    private:
+        FileView _view;
+        std::size_t _position{};
+    };
+}
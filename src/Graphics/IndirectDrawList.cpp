@@ -0,0 +1,129 @@
+#include "IndirectDrawList.hpp"
+#include "GLExtensions.hpp"
+#include "RenderState.hpp"
+#include <algorithm>
+#include <cstddef>
+
+namespace Graphics {
+
+    IndirectDrawList::IndirectDrawList(VertexFormat format) : _format(format) {
+        glGenVertexArrays(1, &_vertexArray);
+        glGenBuffers(1, &_recordBuffer);
+        glGenBuffers(1, &_commandBuffer);
+    }
+
+    IndirectDrawList::~IndirectDrawList() {
+        auto &state = RenderState::Shared();
+        state.DeleteBuffer(_commandBuffer);
+        state.DeleteBuffer(_recordBuffer);
+        state.DeleteVertexArray(_vertexArray);
+    }
+
+    bool IndirectDrawList::IsSupported() {
+        return GLExtensions::DrawElementsIndirect != nullptr;
+    }
+
+    void IndirectDrawList::SetRecords(std::span<const DrawRecord> records) {
+        RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, _recordBuffer);
+        if (records.size() > _recordCapacity) {
+            _recordCapacity = records.size();
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(records.size_bytes()), records.data(),
+                         GL_DYNAMIC_DRAW);
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(records.size_bytes()), records.data());
+        }
+    }
+
+    void IndirectDrawList::Clear() {
+        _pending.clear();
+    }
+
+    void IndirectDrawList::Add(std::uint32_t record, const Mesh &mesh, MeshRange range) {
+        const std::uint64_t key = static_cast<std::uint64_t>(mesh.MaterialIndex) << 1 |
+                                  (mesh.IndexType == GL_UNSIGNED_INT ? 1u : 0u);
+        _pending.push_back({key, {range.IndexCount, 1, mesh.FirstIndex() + range.FirstIndex, mesh.BaseVertex(),
+                                  record}});
+    }
+
+    std::span<const IndirectDrawList::Batch> IndirectDrawList::Build(bool byMaterial) {
+        const std::uint64_t mask = byMaterial ? ~0ull : 1ull;
+        std::stable_sort(_pending.begin(), _pending.end(), [&](const PendingCommand &a, const PendingCommand &b) {
+            return (a.Key & mask) < (b.Key & mask);
+        });
+
+        _commands.clear();
+        _batches.clear();
+        for (const auto &pending: _pending) {
+            if (_batches.empty() || (pending.Key & mask) != (_pending[_batches.back().FirstCommand].Key & mask)) {
+                _batches.push_back({
+                        static_cast<std::uint32_t>(pending.Key >> 1),
+                        pending.Key & 1u ? static_cast<GLenum>(GL_UNSIGNED_INT) : static_cast<GLenum>(GL_UNSIGNED_SHORT),
+                        pending.Command.BaseInstance,
+                        _commands.size(),
+                        0
+                });
+            }
+            _commands.push_back(pending.Command);
+            _batches.back().CommandCount++;
+        }
+
+        RenderState::Shared().BindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                     static_cast<GLsizeiptr>(_commands.size() * sizeof(DrawElementsIndirectCommand)),
+                     _commands.data(), GL_STREAM_DRAW);
+        return _batches;
+    }
+
+    void IndirectDrawList::Bind() {
+        if (_generation != GeometryBuffer::Shared(_format).Generation())
+            SetupVertexArray();
+        auto &state = RenderState::Shared();
+        state.BindVertexArray(_vertexArray);
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+    }
+
+    void IndirectDrawList::Draw(const Batch &batch) const {
+        const auto stride = sizeof(DrawElementsIndirectCommand);
+        if (GLExtensions::MultiDrawElementsIndirect) {
+            GLExtensions::MultiDrawElementsIndirect(GL_TRIANGLES, batch.IndexType,
+                                                    reinterpret_cast<const void *>(batch.FirstCommand * stride),
+                                                    static_cast<GLsizei>(batch.CommandCount), 0);
+            return;
+        }
+        for (std::size_t i = 0; i < batch.CommandCount; i++) {
+            GLExtensions::DrawElementsIndirect(GL_TRIANGLES, batch.IndexType,
+                                               reinterpret_cast<const void *>((batch.FirstCommand + i) * stride));
+        }
+    }
+
+    void IndirectDrawList::SetupVertexArray() {
+        const auto &geometry = GeometryBuffer::Shared(_format);
+        _generation = geometry.Generation();
+
+        RenderState::Shared().BindVertexArray(_vertexArray);
+        geometry.ApplyLayout();
+
+        RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, _recordBuffer);
+        const auto stride = static_cast<GLsizei>(sizeof(DrawRecord));
+        for (GLuint column = 0; column < 4; column++) {
+            const auto location = DrawModelLocation + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+                                  reinterpret_cast<const void *>(offsetof(DrawRecord, Model) +
+                                                                 column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glEnableVertexAttribArray(BoundsMinLocation);
+        glVertexAttribPointer(BoundsMinLocation, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const void *>(offsetof(DrawRecord, BoundsMin)));
+        glVertexAttribDivisor(BoundsMinLocation, 1);
+        glEnableVertexAttribArray(BoundsExtentLocation);
+        glVertexAttribPointer(BoundsExtentLocation, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const void *>(offsetof(DrawRecord, BoundsExtent)));
+        glVertexAttribDivisor(BoundsExtentLocation, 1);
+        glEnableVertexAttribArray(MaterialIndexLocation);
+        glVertexAttribIPointer(MaterialIndexLocation, 1, GL_UNSIGNED_INT, stride,
+                               reinterpret_cast<const void *>(offsetof(DrawRecord, MaterialIndex)));
+        glVertexAttribDivisor(MaterialIndexLocation, 1);
+    }
+}
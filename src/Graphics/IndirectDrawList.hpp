@@ -0,0 +1,93 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Mesh.hpp"
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+    struct DrawElementsIndirectCommand {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint FirstIndex;
+        GLint BaseVertex;
+        GLuint BaseInstance;
+    };
+
+    // Per-draw data, fetched as instanced attributes through the command's BaseInstance: the transform at
+    // locations 3 to 6, the dequantization range at 8 and 9 and the material index at 10.
+    struct DrawRecord {
+        glm::mat4 Model;
+        glm::vec3 BoundsMin;
+        glm::vec3 BoundsExtent;
+        std::uint32_t MaterialIndex;
+        std::uint32_t Padding;
+    };
+
+    constexpr GLuint DrawModelLocation = 3;
+    constexpr GLuint MaterialIndexLocation = 10;
+
+    // Indirect commands for meshes of one shared geometry buffer. Commands are grouped into batches sharing a
+    // material and index type, or only an index type when shaders look materials up per draw, and each batch is a
+    // single glMultiDrawElementsIndirect.
+    class IndirectDrawList {
+    public:
+        struct Batch {
+            std::uint32_t MaterialIndex;
+            GLenum IndexType;
+            // Record of the first command, whose mesh provides the batch textures.
+            std::uint32_t Record;
+            std::size_t FirstCommand;
+            std::size_t CommandCount;
+        };
+
+        explicit IndirectDrawList(VertexFormat format);
+
+        IndirectDrawList(const IndirectDrawList &) = delete;
+
+        IndirectDrawList &operator=(const IndirectDrawList &) = delete;
+
+        ~IndirectDrawList();
+
+        // Needs baseInstance in indirect commands, which is GL 4.2 or ARB_base_instance.
+        static bool IsSupported();
+
+        void SetRecords(std::span<const DrawRecord> records);
+
+        void Clear();
+
+        // Queues a range of the mesh, relative to its first index, drawn with the given record.
+        void Add(std::uint32_t record, const Mesh &mesh, MeshRange range);
+
+        // Sorts the queued commands into batches and uploads them. Without byMaterial the batches span materials
+        // and their MaterialIndex is that of the first command.
+        std::span<const Batch> Build(bool byMaterial = true);
+
+        // Binds the VAO and the command buffer for Draw.
+        void Bind();
+
+        void Draw(const Batch &batch) const;
+
+    private:
+        struct PendingCommand {
+            std::uint64_t Key;
+            DrawElementsIndirectCommand Command;
+        };
+
+        VertexFormat _format;
+        GLuint _vertexArray{};
+        GLuint _recordBuffer{};
+        GLuint _commandBuffer{};
+        std::size_t _recordCapacity{};
+        std::uint64_t _generation = ~0ull;
+        std::vector<PendingCommand> _pending;
+        std::vector<DrawElementsIndirectCommand> _commands;
+        std::vector<Batch> _batches;
+
+        void SetupVertexArray();
+    };
+}
@@ -0,0 +1,103 @@
+#include "InstanceLodBatch.hpp"
+#include "GLExtensions.hpp"
+#include "IndirectDrawList.hpp"
+#include "RenderState.hpp"
+#include "Core/OcclusionBuffer.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace Graphics {
+
+    InstanceLodBatch::~InstanceLodBatch() {
+        if (_vertexArray)
+            RenderState::Shared().DeleteVertexArray(_vertexArray);
+    }
+
+    std::span<const glm::mat4> InstanceLodBatch::Sort(const RenderView &view, std::span<const glm::mat4> instances,
+                                                      glm::vec3 center, float radius) {
+        _threshold = view.LodThreshold;
+        _keys.resize(instances.size());
+        for (std::size_t i = 0; i < instances.size(); i++)
+            _keys[i] = view.PixelsPerUnit(instances[i], center, radius);
+
+        _order.resize(instances.size());
+        std::iota(_order.begin(), _order.end(), 0u);
+        if (view.Occluders) {
+            const Core::Bounds bounds{center - glm::vec3(radius), center + glm::vec3(radius)};
+            std::erase_if(_order, [&](std::uint32_t i) {
+                return !view.Occluders->IsVisible(bounds.Transformed(instances[i]));
+            });
+        }
+        std::sort(_order.begin(), _order.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return _keys[a] > _keys[b];
+        });
+
+        _pixelsPerUnit.resize(_order.size());
+        _sorted.resize(_order.size());
+        for (std::size_t i = 0; i < _order.size(); i++) {
+            _pixelsPerUnit[i] = _keys[_order[i]];
+            _sorted[i] = instances[_order[i]];
+        }
+        return _sorted;
+    }
+
+    void InstanceLodBatch::Draw(const Mesh &mesh, GLuint instanceBuffer) {
+        // Bind sets the mesh's dequantization range, which is not VAO state, before the VAO is swapped for this one.
+        mesh.Bind();
+        const auto &geometry = GeometryBuffer::Shared(mesh.Format);
+        if (!_vertexArray || geometry.Generation() != _generation || mesh.Format != _format ||
+            instanceBuffer != _instanceBuffer)
+            SetupVertexArray(mesh.Format, instanceBuffer);
+        RenderState::Shared().BindVertexArray(_vertexArray);
+
+        const auto total = static_cast<GLsizei>(_sorted.size());
+        if (!GLExtensions::DrawElementsInstancedBaseVertexBaseInstance) {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.IndexCount, mesh.IndexType, mesh.LodOffset(0), total,
+                                              mesh.BaseVertex());
+            return;
+        }
+
+        // Errors grow with the level and pixels per unit shrink along the order, so levels split it into ranges.
+        std::size_t first = 0;
+        for (std::size_t lod = 0; lod < mesh.Lods.size(); lod++) {
+            std::size_t end = _pixelsPerUnit.size();
+            if (lod + 1 < mesh.Lods.size()) {
+                const float nextError = mesh.Lods[lod + 1].Error;
+                end = std::partition_point(_pixelsPerUnit.begin() + static_cast<std::ptrdiff_t>(first),
+                                           _pixelsPerUnit.end(), [&](float pixelsPerUnit) {
+                            return nextError * pixelsPerUnit > _threshold;
+                        }) - _pixelsPerUnit.begin();
+            }
+            if (end > first) {
+                GLExtensions::DrawElementsInstancedBaseVertexBaseInstance(
+                        GL_TRIANGLES, static_cast<GLsizei>(mesh.Lods[lod].IndexCount), mesh.IndexType,
+                        mesh.LodOffset(lod), static_cast<GLsizei>(end - first), mesh.BaseVertex(),
+                        static_cast<GLuint>(first));
+            }
+            first = end;
+        }
+    }
+
+    void InstanceLodBatch::SetupVertexArray(VertexFormat format, GLuint instanceBuffer) {
+        if (!_vertexArray)
+            glGenVertexArrays(1, &_vertexArray);
+        const auto &geometry = GeometryBuffer::Shared(format);
+        _format = format;
+        _instanceBuffer = instanceBuffer;
+        _generation = geometry.Generation();
+
+        auto &state = RenderState::Shared();
+        state.BindVertexArray(_vertexArray);
+        geometry.ApplyLayout();
+
+        state.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        const auto stride = static_cast<GLsizei>(sizeof(glm::mat4));
+        for (GLuint column = 0; column < 4; column++) {
+            const auto location = DrawModelLocation + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+                                  reinterpret_cast<const void *>(column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+}
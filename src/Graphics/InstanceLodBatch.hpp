@@ -0,0 +1,48 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Mesh.hpp"
+#include "RenderView.hpp"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Orders instances nearest first, so each level of each mesh draws one contiguous range of a single
+    // instance buffer with glDrawElementsInstancedBaseVertexBaseInstance.
+    class InstanceLodBatch {
+    public:
+        InstanceLodBatch() = default;
+
+        InstanceLodBatch(const InstanceLodBatch &) = delete;
+
+        InstanceLodBatch &operator=(const InstanceLodBatch &) = delete;
+
+        ~InstanceLodBatch();
+
+        // Returns the instances in draw order, ready to upload, without those hidden behind the view's occluders.
+        // center and radius bound the model in object space.
+        std::span<const glm::mat4> Sort(const RenderView &view, std::span<const glm::mat4> instances,
+                                        glm::vec3 center, float radius);
+
+        // One instanced draw per level for the instances of the last Sort, uploaded to instanceBuffer as one matrix
+        // each. Draws through a VAO of its own that adds instanceBuffer to the shared geometry of the mesh's format,
+        // leaving the shared VAO other models draw through alone.
+        void Draw(const Mesh &mesh, GLuint instanceBuffer);
+
+    private:
+        GLuint _vertexArray{};
+        GLuint _instanceBuffer{};
+        VertexFormat _format = VertexFormat::Packed;
+        std::uint64_t _generation = ~0ull;
+        std::vector<std::uint32_t> _order;
+        std::vector<float> _keys;
+        std::vector<float> _pixelsPerUnit;
+        std::vector<glm::mat4> _sorted;
+        float _threshold = 1.0f;
+
+        // Points the VAO at the geometry buffers of format and at instanceBuffer; again whenever those grow.
+        void SetupVertexArray(VertexFormat format, GLuint instanceBuffer);
+    };
+}
@@ -0,0 +1,47 @@
+#include "Material.hpp"
+#include "RenderState.hpp"
+#include "UniformRing.hpp"
+#include <algorithm>
+#include <array>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::array<UniformId, Material::MaxDiffuse> DiffuseSamplers = {
+                "material.texture_diffuse1", "material.texture_diffuse2", "material.texture_diffuse3"
+        };
+        constexpr std::array<UniformId, Material::MaxSpecular> SpecularSamplers = {
+                "material.texture_specular1", "material.texture_specular2"
+        };
+    }
+
+    Material::Material(std::vector<GLuint> diffuse, std::vector<GLuint> specular, float shininess)
+            : Parameters{shininess} {
+        diffuse.resize(std::min(diffuse.size(), MaxDiffuse));
+        _diffuseCount = diffuse.size();
+        specular.resize(std::min(specular.size(), MaxSpecular));
+        for (std::size_t i = 0; i < diffuse.size(); i++) {
+            _samplers.push_back({DiffuseSamplers[i], static_cast<GLint>(FirstUnit + _textures.size())});
+            _textures.push_back(diffuse[i]);
+        }
+        for (std::size_t i = 0; i < specular.size(); i++) {
+            _samplers.push_back({SpecularSamplers[i], static_cast<GLint>(FirstUnit + _textures.size())});
+            _textures.push_back(specular[i]);
+        }
+    }
+
+    void Material::Bind(const Shader &shader) const {
+        RenderState::Shared().BindTextures(FirstUnit, _textures);
+        for (const auto &sampler: _samplers)
+            shader.SetInt(sampler.Name, sampler.Unit);
+        UniformRing::Shared().Bind(Parameters);
+    }
+
+    std::span<const GLuint> Material::Textures() const {
+        return _textures;
+    }
+
+    GLuint Material::DiffuseTexture() const {
+        return _diffuseCount > 0 ? _textures.front() : 0;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Shader.hpp"
+#include "UniformBlocks.hpp"
+#include "UniformId.hpp"
+#include "glad/glad.h"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Textures and parameters of one surface, resolved when it is created: textures take consecutive units from
+    // FirstUnit, diffuse before specular, and each sampler uniform is paired with its unit up front, so binding is
+    // one multi-bind, a few glUniform1i calls and one MaterialBlock upload.
+    class Material {
+    public:
+        // Units below stay free for per-pass textures such as shadow maps.
+        static constexpr GLuint FirstUnit = 4;
+        // As many as LitShader declares.
+        static constexpr std::size_t MaxDiffuse = 3;
+        static constexpr std::size_t MaxSpecular = 2;
+
+        MaterialBlock Parameters{32.0f};
+
+        Material() = default;
+
+        // Textures past the sampler counts above are dropped.
+        explicit Material(std::vector<GLuint> diffuse, std::vector<GLuint> specular = {}, float shininess = 32.0f);
+
+        void Bind(const Shader &shader) const;
+
+        [[nodiscard]] std::span<const GLuint> Textures() const;
+
+        // First diffuse texture, or 0 without one.
+        [[nodiscard]] GLuint DiffuseTexture() const;
+
+    private:
+        struct Sampler {
+            UniformId Name;
+            GLint Unit;
+        };
+
+        std::vector<GLuint> _textures;
+        std::vector<Sampler> _samplers;
+        std::size_t _diffuseCount{};
+    };
+}
@@ -0,0 +1,196 @@
+#include "MaterialTable.hpp"
+#include "GLExtensions.hpp"
+#include "RenderState.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::array<UniformId, MaterialTable::MaxArrays> ArraySamplers = {
+                "materialArrays[0]", "materialArrays[1]", "materialArrays[2]",
+                "materialArrays[3]", "materialArrays[4]", "materialArrays[5]"
+        };
+    }
+
+    MaterialTable::MaterialTable(MaterialTextureMode mode) : _mode(mode) {
+    }
+
+    MaterialTable::~MaterialTable() {
+        for (const auto handle: _handles)
+            GLExtensions::MakeTextureHandleNonResident(handle);
+        auto &state = RenderState::Shared();
+        for (const auto array: _arrays)
+            state.DeleteTexture(array);
+        if (_buffer)
+            state.DeleteBuffer(_buffer);
+    }
+
+    // A multi-draw's material index is not dynamically uniform, and ARB_bindless_texture alone leaves sampling
+    // through a handle chosen by it undefined.
+    MaterialTextureMode MaterialTable::PreferredMode() {
+        if (GLExtensions::GetTextureHandle && GLExtensions::ShaderStorageBuffers && GLExtensions::NonUniformSamplers)
+            return MaterialTextureMode::Bindless;
+        if (GLExtensions::TexStorage3D && GLExtensions::CopyImageSubData)
+            return MaterialTextureMode::Arrays;
+        return MaterialTextureMode::Bound;
+    }
+
+    std::unique_ptr<MaterialTable> MaterialTable::Create(std::span<const Material> materials) {
+        const auto mode = PreferredMode();
+        if (mode == MaterialTextureMode::Bound || materials.empty() ||
+            materials.size() > MaterialTableBlock::MaxMaterials)
+            return nullptr;
+
+        std::vector<MaterialEntry> entries(mode == MaterialTextureMode::Arrays ? MaterialTableBlock::MaxMaterials
+                                                                                : materials.size());
+        // A null handle marks a missing texture in bindless mode, which has no reserved layer value.
+        const auto missing = mode == MaterialTextureMode::Bindless ? 0u : NoTexture;
+        for (std::size_t i = 0; i < materials.size(); i++)
+            entries[i] = {{missing, 0}, materials[i].Parameters.Shininess, 0};
+
+        std::unique_ptr<MaterialTable> table(new MaterialTable(mode));
+        const bool built = mode == MaterialTextureMode::Bindless ? table->BuildBindless(materials, entries)
+                                                                 : table->BuildArrays(materials, entries);
+        if (!built)
+            return nullptr;
+
+        const auto target = mode == MaterialTextureMode::Bindless ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER;
+        glGenBuffers(1, &table->_buffer);
+        RenderState::Shared().BindBuffer(target, table->_buffer);
+        glBufferData(target, static_cast<GLsizeiptr>(entries.size() * sizeof(MaterialEntry)), entries.data(),
+                     GL_STATIC_DRAW);
+
+        Log::Information(fmt::format("Material table: {} materials, {} arrays, {} bindless handles",
+                                     materials.size(), table->_arrays.size(), table->_handles.size()));
+        return table;
+    }
+
+    MaterialTextureMode MaterialTable::Mode() const {
+        return _mode;
+    }
+
+    void MaterialTable::Bind(const Shader &shader) const {
+        auto &state = RenderState::Shared();
+        if (_mode == MaterialTextureMode::Bindless) {
+            state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, BindlessBinding, _buffer);
+            return;
+        }
+
+        state.BindBufferBase(GL_UNIFORM_BUFFER, MaterialTableBlock::Binding, _buffer);
+        for (std::size_t i = 0; i < _arrays.size(); i++) {
+            const auto unit = FirstArrayUnit + static_cast<GLuint>(i);
+            state.BindTexture(unit, GL_TEXTURE_2D_ARRAY, _arrays[i]);
+            shader.SetInt(ArraySamplers[i], static_cast<int>(unit));
+        }
+    }
+
+    bool MaterialTable::BuildBindless(std::span<const Material> materials, std::span<MaterialEntry> entries) {
+        // A texture shared by several materials has one handle, which may be made resident only once.
+        std::unordered_map<GLuint, GLuint64> handles;
+        for (std::size_t i = 0; i < materials.size(); i++) {
+            const auto texture = materials[i].DiffuseTexture();
+            if (texture == 0)
+                continue;
+            auto [it, inserted] = handles.try_emplace(texture, 0);
+            if (inserted) {
+                it->second = GLExtensions::GetTextureHandle(texture);
+                GLExtensions::MakeTextureHandleResident(it->second);
+                _handles.push_back(it->second);
+            }
+            entries[i].Diffuse[0] = static_cast<std::uint32_t>(it->second);
+            entries[i].Diffuse[1] = static_cast<std::uint32_t>(it->second >> 32);
+        }
+        return true;
+    }
+
+    bool MaterialTable::BuildArrays(std::span<const Material> materials, std::span<MaterialEntry> entries) {
+        struct Group {
+            ArrayFormat Format;
+            std::vector<GLuint> Textures;
+        };
+
+        std::vector<Group> groups;
+        std::unordered_map<GLuint, std::uint32_t> locations;
+        for (std::size_t i = 0; i < materials.size(); i++) {
+            const auto texture = materials[i].DiffuseTexture();
+            if (texture == 0)
+                continue;
+            if (const auto it = locations.find(texture); it != locations.end()) {
+                entries[i].Diffuse[0] = it->second;
+                continue;
+            }
+
+            const auto format = FormatOf(texture);
+            auto group = std::find_if(groups.begin(), groups.end(), [&](const Group &g) {
+                return g.Format == format;
+            });
+            if (group == groups.end()) {
+                if (groups.size() == MaxArrays) {
+                    const auto count = groups.size() + 1;
+                    Log::Error("MATERIAL_TABLE::TOO_MANY_TEXTURE_FORMATS {}", count);
+                    return false;
+                }
+                group = groups.insert(groups.end(), {format, {}});
+            }
+
+            const auto location = static_cast<std::uint32_t>(group - groups.begin()) << 16 |
+                                  static_cast<std::uint32_t>(group->Textures.size());
+            group->Textures.push_back(texture);
+            locations.emplace(texture, location);
+            entries[i].Diffuse[0] = location;
+        }
+
+        // Every texture keeps its own sampling state; the arrays take the first one's.
+        auto &state = RenderState::Shared();
+        for (const auto &group: groups) {
+            const auto &format = group.Format;
+            GLint wrap = GL_REPEAT, minFilter = GL_LINEAR_MIPMAP_LINEAR, magFilter = GL_LINEAR;
+            state.BindTexture(GL_TEXTURE_2D, group.Textures.front());
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrap);
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &magFilter);
+
+            GLuint array{};
+            glGenTextures(1, &array);
+            _arrays.push_back(array);
+            state.BindTexture(GL_TEXTURE_2D_ARRAY, array);
+            GLExtensions::TexStorage3D(GL_TEXTURE_2D_ARRAY, format.Levels, static_cast<GLenum>(format.InternalFormat),
+                                       format.Width, format.Height, static_cast<GLsizei>(group.Textures.size()));
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+
+            for (std::size_t layer = 0; layer < group.Textures.size(); layer++) {
+                for (GLsizei level = 0; level < format.Levels; level++) {
+                    GLExtensions::CopyImageSubData(group.Textures[layer], GL_TEXTURE_2D, level, 0, 0, 0,
+                                                   array, GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(layer),
+                                                   std::max(format.Width >> level, 1),
+                                                   std::max(format.Height >> level, 1), 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    MaterialTable::ArrayFormat MaterialTable::FormatOf(GLuint texture) {
+        RenderState::Shared().BindTexture(GL_TEXTURE_2D, texture);
+        ArrayFormat format{};
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &format.Width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &format.Height);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format.InternalFormat);
+
+        // Levels present in the chain; arrays are allocated with the same count so every level can be copied.
+        while (true) {
+            GLint width = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, format.Levels, GL_TEXTURE_WIDTH, &width);
+            if (width == 0)
+                break;
+            format.Levels++;
+        }
+        return format;
+    }
+}
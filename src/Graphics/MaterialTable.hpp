@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Material.hpp"
+#include "Shader.hpp"
+#include "ShaderPermutation.hpp"
+#include "UniformBlocks.hpp"
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // The diffuse textures and shininess of a model's materials in a form shaders index by the per-draw material
+    // index, so one program bind and one multi-draw can cover every material. Bindless mode, where the driver also
+    // samples through handles that differ within a draw, makes the existing textures resident and stores their
+    // handles in a shader storage buffer; array mode copies textures of equal size, format and level count into
+    // the layers of a few GL_TEXTURE_2D_ARRAYs and keeps the layer of each material in a uniform block. The array
+    // copies add to, rather than replace, the per-material textures, which shaders compiled for
+    // MaterialTextureMode::Bound still sample.
+    class MaterialTable {
+    public:
+        // As many arrays as LitShader declares, on the units that follow those Material uses.
+        static constexpr std::size_t MaxArrays = 6;
+        static constexpr GLuint FirstArrayUnit = 10;
+        static constexpr GLuint BindlessBinding = 0;
+        static constexpr std::uint32_t NoTexture = ~0u;
+
+        MaterialTable(const MaterialTable &) = delete;
+
+        MaterialTable &operator=(const MaterialTable &) = delete;
+
+        ~MaterialTable();
+
+        // What the driver supports, preferring bindless handles; Bound when neither mode is available.
+        static MaterialTextureMode PreferredMode();
+
+        // Returns null when there is no mode to build, or the materials do not fit it; textures must be resident.
+        static std::unique_ptr<MaterialTable> Create(std::span<const Material> materials);
+
+        [[nodiscard]] MaterialTextureMode Mode() const;
+
+        // Binds the table, and in array mode the arrays and their samplers, for a shader of the same mode.
+        void Bind(const Shader &shader) const;
+
+    private:
+        struct ArrayFormat {
+            GLsizei Width;
+            GLsizei Height;
+            GLint InternalFormat;
+            GLsizei Levels;
+
+            bool operator==(const ArrayFormat &) const = default;
+        };
+
+        MaterialTextureMode _mode;
+        GLuint _buffer{};
+        std::vector<GLuint> _arrays;
+        std::vector<GLuint64> _handles;
+
+        explicit MaterialTable(MaterialTextureMode mode);
+
+        bool BuildBindless(std::span<const Material> materials, std::span<MaterialEntry> entries);
+
+        bool BuildArrays(std::span<const Material> materials, std::span<MaterialEntry> entries);
+
+        static ArrayFormat FormatOf(GLuint texture);
+    };
+}
@@ -1,68 +1,179 @@
 #include "Mesh.hpp"
+#include "MeshletBuilder.hpp"
+#include "RenderState.hpp"
+#include "glm/gtc/packing.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace Graphics {
 
+    Half Half::FromFloat(float value) {
+        return {glm::packHalf1x16(value)};
+    }
+
+    namespace {
+        glm::i16vec2 EncodeOctahedral(glm::vec3 normal) {
+            normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            glm::vec2 encoded(normal.x, normal.y);
+            if (normal.z < 0.0f) {
+                encoded = (1.0f - glm::abs(glm::vec2(normal.y, normal.x))) *
+                          glm::vec2(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+            }
+            return glm::i16vec2(glm::round(glm::clamp(encoded, -1.0f, 1.0f) * 32767.0f));
+        }
+    }
+
     Graphics::Mesh::Mesh(
-            const std::vector<Vertex> &vertices,
-            const std::vector<unsigned int> &indices,
-            const std::vector<TextureIdentifier> &textures
-    ) {
-        Vertices = vertices;
-        Indices = indices;
-        Textures = textures;
+            std::span<const Vertex> vertices,
+            std::span<const unsigned int> indices,
+            VertexFormat format,
+            std::span<const MeshLod> lods,
+            std::span<const Meshlet> meshlets
+    ) : Format(format) {
+        Vertices.assign(vertices.begin(), vertices.end());
+        Indices.assign(indices.begin(), indices.end());
+        Meshlets.assign(meshlets.begin(), meshlets.end());
+        if (lods.empty())
+            Lods.push_back({0, static_cast<std::uint32_t>(indices.size()), 0.0f});
+        else
+            Lods.assign(lods.begin(), lods.end());
+
+        if (!vertices.empty()) {
+            BoundsMin = BoundsMax = vertices.front().Position;
+            for (const auto &vertex: vertices) {
+                BoundsMin = glm::min(BoundsMin, vertex.Position);
+                BoundsMax = glm::max(BoundsMax, vertex.Position);
+            }
+            const auto center = BoundsCenter();
+            for (const auto &vertex: vertices)
+                BoundsSphereRadius = std::max(BoundsSphereRadius, glm::distance(center, vertex.Position));
+        }
 
-        SetupMesh();
+        SetupMesh(vertices, indices);
     }
 
-    void Graphics::Mesh::SetupMesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+    std::vector<Graphics::PackedVertex> Graphics::Mesh::Pack(std::span<const Vertex> vertices, glm::vec3 boundsMin,
+                                                             glm::vec3 boundsMax) {
+        const auto extent = boundsMax - boundsMin;
+        const auto scale = glm::vec3(
+                extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                extent.z > 0.0f ? 1.0f / extent.z : 0.0f
+        );
+
+        std::vector<PackedVertex> packed;
+        packed.reserve(vertices.size());
+        for (const auto &vertex: vertices) {
+            const auto position = glm::round(glm::clamp((vertex.Position - boundsMin) * scale, 0.0f, 1.0f) * 65535.0f);
+            packed.push_back({
+                    glm::u16vec4(glm::u16vec3(position), 0),
+                    {Half::FromFloat(vertex.TexCoords.x), Half::FromFloat(vertex.TexCoords.y)},
+                    EncodeOctahedral(vertex.Normal)
+            });
+        }
+        return packed;
+    }
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    void Graphics::Mesh::SetupMesh(std::span<const Vertex> vertices, std::span<const unsigned int> indices) {
+        IndexCount = static_cast<GLsizei>(Lods.front().IndexCount);
 
-        glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), &Vertices[0], GL_DYNAMIC_DRAW);
+        std::vector<PackedVertex> packed;
+        const void *vertexData = vertices.data();
+        if (Format == VertexFormat::Packed) {
+            packed = Pack(vertices, BoundsMin, BoundsMax);
+            vertexData = packed.data();
+        }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(unsigned int), &Indices[0], GL_DYNAMIC_DRAW);
+        auto &geometry = GeometryBuffer::Shared(Format);
+        if (vertices.size() <= 0x10000) {
+            const std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+            IndexType = GL_UNSIGNED_SHORT;
+            Geometry = geometry.Allocate(vertexData, vertices.size(), shortIndices.data(),
+                                         shortIndices.size() * sizeof(std::uint16_t));
+        } else {
+            IndexType = GL_UNSIGNED_INT;
+            Geometry = geometry.Allocate(vertexData, vertices.size(), indices.data(), indices.size_bytes());
+        }
+        VAO = geometry.VertexArray();
+    }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+    void Graphics::Mesh::Bind() const {
+        RenderState::Shared().BindVertexArray(VAO);
+        if (Format == VertexFormat::Packed) {
+            const auto extent = BoundsMax - BoundsMin;
+            glVertexAttrib3f(BoundsMinLocation, BoundsMin.x, BoundsMin.y, BoundsMin.z);
+            glVertexAttrib3f(BoundsExtentLocation, extent.x, extent.y, extent.z);
+        }
+    }
 
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, TexCoords));
+    glm::vec3 Graphics::Mesh::BoundsCenter() const {
+        return (BoundsMin + BoundsMax) * 0.5f;
+    }
+
+    float Graphics::Mesh::BoundsRadius() const {
+        return BoundsSphereRadius;
+    }
+
+    std::size_t Graphics::Mesh::SelectLod(float pixelsPerUnit, float thresholdPixels) const {
+        std::size_t lod = 0;
+        while (lod + 1 < Lods.size() && Lods[lod + 1].Error * pixelsPerUnit <= thresholdPixels)
+            lod++;
+        return lod;
+    }
+
+    const void *Graphics::Mesh::LodOffset(std::size_t lod) const {
+        return reinterpret_cast<const void *>(Geometry->IndexOffset + Lods[lod].FirstIndex * IndexSize());
+    }
 
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Normal));
+    GLint Graphics::Mesh::BaseVertex() const {
+        return Geometry->BaseVertex;
+    }
 
-        glBindVertexArray(0);
+    GLuint Graphics::Mesh::FirstIndex() const {
+        return static_cast<GLuint>(Geometry->IndexOffset / IndexSize());
     }
 
-    void Graphics::Mesh::Draw(Graphics::Shader &shader) {
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        for (unsigned int i = 0; i < Textures.size(); i++) {
-            glActiveTexture(GL_TEXTURE0 + i);
+    std::size_t Graphics::Mesh::IndexSize() const {
+        return IndexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+    }
 
-            std::string number;
-            std::string name = Textures[i].Type;
-            if (name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if (name == "texture_specular")
-                number = std::to_string(specularNr++);
+    void Graphics::Mesh::Draw(std::size_t lod) {
+        Bind();
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(Lods[lod].IndexCount), IndexType, LodOffset(lod),
+                                 BaseVertex());
+    }
 
-            std::string material = "material.";
-            material.append(name);
-            material.append(number);
+    void Graphics::Mesh::CullMeshlets(const Core::Frustum &frustum, glm::vec3 camera, bool backfaceCulling,
+                                      std::vector<MeshRange> &ranges) const {
+        const auto first = ranges.size();
+        for (const auto &meshlet: Meshlets) {
+            if (!MeshletBuilder::IsVisible(meshlet, frustum, camera, backfaceCulling))
+                continue;
+            if (ranges.size() > first &&
+                ranges.back().FirstIndex + ranges.back().IndexCount == meshlet.FirstIndex)
+                ranges.back().IndexCount += meshlet.IndexCount;
+            else
+                ranges.push_back({meshlet.FirstIndex, meshlet.IndexCount});
+        }
+    }
 
-            glBindTexture(GL_TEXTURE_2D, Textures[i].Id);
-            shader.SetInt(material, i);
+    void Graphics::Mesh::DrawMeshlets(const Core::Frustum &frustum, glm::vec3 camera, bool backfaceCulling) {
+        _ranges.clear();
+        CullMeshlets(frustum, camera, backfaceCulling, _ranges);
+        if (_ranges.empty())
+            return;
+
+        _rangeCounts.clear();
+        _rangeOffsets.clear();
+        for (const auto &range: _ranges) {
+            _rangeCounts.push_back(static_cast<GLsizei>(range.IndexCount));
+            _rangeOffsets.push_back(reinterpret_cast<const void *>(Geometry->IndexOffset +
+                                                                   range.FirstIndex * IndexSize()));
         }
-        glActiveTexture(GL_TEXTURE0);
+        _rangeBaseVertices.assign(_ranges.size(), BaseVertex());
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, Indices.size(), GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
+        Bind();
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, _rangeCounts.data(), IndexType, _rangeOffsets.data(),
+                                      static_cast<GLsizei>(_ranges.size()), _rangeBaseVertices.data());
     }
-}
\ No newline at end of file
+}
@@ -1,7 +1,15 @@
 #pragma once
 
 #include "glm/glm.hpp"
+#include "glm/ext/vector_int2_sized.hpp"
+#include "glm/ext/vector_uint4_sized.hpp"
+#include "GeometryBuffer.hpp"
 #include "Shader.hpp"
+#include "Core/Frustum.hpp"
+#include "VertexLayout.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,27 +20,129 @@ namespace Graphics {
         glm::vec3 Normal;
     };
 
-    struct TextureIdentifier {
-        unsigned int Id;
-        std::string Type;
-        std::string Path;
+    // 16 bytes: xyz as unorm16 inside the mesh bounds (w stays 0 so shaders can tell the formats apart),
+    // half-float UVs and an octahedral snorm16 normal.
+    struct PackedVertex {
+        glm::u16vec4 Position;
+        std::array<Half, 2> TexCoords;
+        glm::i16vec2 Normal;
+    };
+
+    using StandardLayout = VertexLayout<
+            Attribute<0, &Vertex::Position>,
+            Attribute<1, &Vertex::TexCoords>,
+            Attribute<2, &Vertex::Normal>
+    >;
+
+    using PackedLayout = VertexLayout<
+            Attribute<0, &PackedVertex::Position, true>,
+            Attribute<1, &PackedVertex::TexCoords>,
+            Attribute<2, &PackedVertex::Normal, true>
+    >;
+
+    // Generic attributes carrying the dequantization range for packed positions.
+    constexpr GLuint BoundsMinLocation = 8;
+    constexpr GLuint BoundsExtentLocation = 9;
+
+    enum class VertexFormat {
+        Standard,
+        Packed
+    };
+
+    // A range of the mesh index buffer and the object-space surface deviation it introduces; level 0 is exact.
+    struct MeshLod {
+        std::uint32_t FirstIndex;
+        std::uint32_t IndexCount;
+        float Error;
+    };
+
+    constexpr std::size_t MaxMeshLods = 4;
+
+    // A cluster of level 0 triangles with the bounds used to cull it. A camera inside the cone, that is
+    // dot(normalize(ConeApex - camera), ConeAxis) >= ConeCutoff, sees only back faces.
+    struct Meshlet {
+        std::uint32_t FirstIndex;
+        std::uint32_t IndexCount;
+        glm::vec3 Center;
+        float Radius;
+        glm::vec3 BoundsMin;
+        glm::vec3 BoundsMax;
+        glm::vec3 ConeApex;
+        glm::vec3 ConeAxis;
+        float ConeCutoff;
+    };
+
+    // Index range relative to the start of a mesh's indices.
+    struct MeshRange {
+        std::uint32_t FirstIndex;
+        std::uint32_t IndexCount;
     };
 
     class Mesh {
     public:
         std::vector<Vertex> Vertices;
         std::vector<unsigned int> Indices;
-        std::vector<TextureIdentifier> Textures;
-        unsigned int VAO{}, VBO{}, EBO{};
+        unsigned int VAO{};
+        GeometryBuffer::Handle Geometry;
+        // Into the owning model's Materials; draws expect the caller to have bound it.
+        std::uint32_t MaterialIndex{};
+        VertexFormat Format = VertexFormat::Standard;
+        GLenum IndexType = GL_UNSIGNED_INT;
+        GLsizei IndexCount{};
+        glm::vec3 BoundsMin{};
+        glm::vec3 BoundsMax{};
+        // Distance from BoundsCenter() to the furthest vertex; tighter than half the box diagonal.
+        float BoundsSphereRadius{};
+        std::vector<MeshLod> Lods;
+        std::vector<Meshlet> Meshlets;
 
-        Mesh(const std::vector<Vertex> &vertices,
-             const std::vector<unsigned int> &indices,
-             const std::vector<TextureIdentifier> &textures);
+        // Without lods the whole index buffer is a single level.
+        Mesh(std::span<const Vertex> vertices,
+             std::span<const unsigned int> indices,
+             VertexFormat format = VertexFormat::Standard,
+             std::span<const MeshLod> lods = {},
+             std::span<const Meshlet> meshlets = {});
 
-        void Draw(Shader &shader);
+        // Binds the shared VAO and the dequantization range, for callers that issue their own draws. Those must
+        // pass BaseVertex() and offsets from LodOffset, since the mesh lives inside the shared geometry buffers.
+        void Bind() const;
+
+        void Draw(std::size_t lod = 0);
+
+        // Draws level 0 skipping meshlets outside the frustum or facing away from the camera, both in object space.
+        void DrawMeshlets(const Core::Frustum &frustum, glm::vec3 camera, bool backfaceCulling = true);
+
+        // Appends the visible level 0 meshlets to ranges, merging neighbours that are adjacent in the index buffer.
+        void CullMeshlets(const Core::Frustum &frustum, glm::vec3 camera, bool backfaceCulling,
+                          std::vector<MeshRange> &ranges) const;
+
+        [[nodiscard]] glm::vec3 BoundsCenter() const;
+
+        [[nodiscard]] float BoundsRadius() const;
+
+        // Coarsest level whose error stays within thresholdPixels when one object unit covers pixelsPerUnit.
+        [[nodiscard]] std::size_t SelectLod(float pixelsPerUnit, float thresholdPixels) const;
+
+        // Byte offset of a level inside the element buffer, for glDrawElements* calls.
+        [[nodiscard]] const void *LodOffset(std::size_t lod) const;
+
+        [[nodiscard]] GLint BaseVertex() const;
+
+        // Position of the mesh's first index in the shared element buffer, in units of IndexType.
+        [[nodiscard]] GLuint FirstIndex() const;
+
+        [[nodiscard]] std::size_t IndexSize() const;
+
+        static std::vector<PackedVertex> Pack(std::span<const Vertex> vertices, glm::vec3 boundsMin,
+                                              glm::vec3 boundsMax);
 
     private:
-        void SetupMesh();
+        std::vector<MeshRange> _ranges;
+        std::vector<GLsizei> _rangeCounts;
+        std::vector<const void *> _rangeOffsets;
+        std::vector<GLint> _rangeBaseVertices;
+
+        void SetupMesh(std::span<const Vertex> vertices, std::span<const unsigned int> indices);
     };
 }
 
@@ -0,0 +1,238 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::uint32_t Unused = ~0u;
+
+        // Clusters are cut at Tipsify dead ends and also capped, so large connected meshes can still be reordered.
+        constexpr std::size_t MaxClusterTriangles = 256;
+
+        struct Adjacency {
+            std::vector<std::uint32_t> Offsets;
+            std::vector<std::uint32_t> Triangles;
+        };
+
+        Adjacency BuildAdjacency(std::span<const std::uint32_t> indices, std::size_t vertexCount) {
+            Adjacency adjacency;
+            adjacency.Offsets.assign(vertexCount + 1, 0);
+            for (const auto index: indices)
+                adjacency.Offsets[index + 1]++;
+            std::partial_sum(adjacency.Offsets.begin(), adjacency.Offsets.end(), adjacency.Offsets.begin());
+
+            adjacency.Triangles.resize(indices.size());
+            auto cursor = adjacency.Offsets;
+            for (std::size_t i = 0; i < indices.size(); i++)
+                adjacency.Triangles[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+            return adjacency;
+        }
+    }
+
+    float VertexCacheStats::Acmr() const {
+        return Triangles ? static_cast<float>(Transformed) / static_cast<float>(Triangles) : 0.0f;
+    }
+
+    float VertexCacheStats::Atvr() const {
+        return Vertices ? static_cast<float>(Transformed) / static_cast<float>(Vertices) : 0.0f;
+    }
+
+    VertexCacheStats &VertexCacheStats::operator+=(const VertexCacheStats &other) {
+        Triangles += other.Triangles;
+        Transformed += other.Transformed;
+        Vertices += other.Vertices;
+        return *this;
+    }
+
+    VertexCacheStats MeshOptimizer::AnalyzeVertexCache(std::span<const std::uint32_t> indices,
+                                                       std::size_t vertexCount, std::size_t cacheSize) {
+        VertexCacheStats stats{indices.size() / 3, 0, 0};
+
+        // Timestamp FIFO: a vertex is resident while fewer than cacheSize misses happened since it was loaded.
+        std::vector<std::size_t> loadedAt(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        for (const auto index: indices) {
+            if (loadedAt[index] == 0 || stats.Transformed - loadedAt[index] >= cacheSize) {
+                stats.Transformed++;
+                loadedAt[index] = stats.Transformed;
+            }
+            if (!referenced[index]) {
+                referenced[index] = true;
+                stats.Vertices++;
+            }
+        }
+        return stats;
+    }
+
+    std::vector<std::uint32_t> MeshOptimizer::OptimizeVertexCache(std::span<std::uint32_t> indices,
+                                                                  std::size_t vertexCount, std::size_t cacheSize) {
+        const auto triangleCount = indices.size() / 3;
+        std::vector<std::uint32_t> clusters;
+        if (triangleCount == 0)
+            return clusters;
+
+        const auto adjacency = BuildAdjacency(indices, vertexCount);
+        std::vector<std::uint32_t> live(vertexCount, 0);
+        for (const auto index: indices)
+            live[index]++;
+
+        std::vector<std::size_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<std::uint32_t> deadEnd;
+        std::vector<std::uint32_t> candidates;
+        std::vector<std::uint32_t> output;
+        output.reserve(indices.size());
+
+        std::size_t time = cacheSize + 1;
+        std::uint32_t cursor = 0;
+        std::uint32_t fanning = indices[0];
+        std::size_t clusterStart = 0;
+        clusters.push_back(0);
+
+        const auto skipDeadEnd = [&]() -> std::uint32_t {
+            while (!deadEnd.empty()) {
+                const auto vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[vertex] > 0)
+                    return vertex;
+            }
+            for (; cursor < vertexCount; cursor++) {
+                if (live[cursor] > 0)
+                    return cursor;
+            }
+            return Unused;
+        };
+
+        while (fanning != Unused) {
+            candidates.clear();
+            for (auto i = adjacency.Offsets[fanning]; i < adjacency.Offsets[fanning + 1]; i++) {
+                const auto triangle = adjacency.Triangles[i];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                for (int corner = 0; corner < 3; corner++) {
+                    const auto vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    candidates.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    live[vertex]--;
+                    if (time - cacheTime[vertex] > cacheSize)
+                        cacheTime[vertex] = time++;
+                }
+            }
+
+            // Prefer a neighbour that will still be cached after its remaining triangles are emitted.
+            std::uint32_t next = Unused;
+            std::size_t bestPriority = 0;
+            for (const auto vertex: candidates) {
+                if (live[vertex] == 0)
+                    continue;
+                std::size_t priority = 0;
+                if (time - cacheTime[vertex] + 2 * live[vertex] <= cacheSize)
+                    priority = time - cacheTime[vertex];
+                if (next == Unused || priority > bestPriority) {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+
+            const auto emittedTriangles = output.size() / 3;
+            if (next == Unused) {
+                next = skipDeadEnd();
+                if (next != Unused && emittedTriangles > clusterStart) {
+                    clusterStart = emittedTriangles;
+                    clusters.push_back(static_cast<std::uint32_t>(clusterStart));
+                }
+            } else if (emittedTriangles - clusterStart >= MaxClusterTriangles) {
+                clusterStart = emittedTriangles;
+                clusters.push_back(static_cast<std::uint32_t>(clusterStart));
+            }
+            fanning = next;
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+        return clusters;
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(std::span<std::uint32_t> indices, std::span<const Vertex> vertices,
+                                         std::span<const std::uint32_t> clusters, float threshold) {
+        const auto triangleCount = indices.size() / 3;
+        if (clusters.size() < 2)
+            return;
+
+        struct Cluster {
+            std::uint32_t First;
+            std::uint32_t Count;
+            glm::vec3 Centroid;
+            glm::vec3 Normal;
+            float Area;
+            float Key;
+        };
+
+        std::vector<Cluster> sorted;
+        sorted.reserve(clusters.size());
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (std::size_t c = 0; c < clusters.size(); c++) {
+            const auto first = clusters[c];
+            const auto end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<std::uint32_t>(triangleCount);
+            Cluster cluster{first, end - first, glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f};
+            for (auto t = first; t < end; t++) {
+                const auto &a = vertices[indices[t * 3]].Position;
+                const auto &b = vertices[indices[t * 3 + 1]].Position;
+                const auto &d = vertices[indices[t * 3 + 2]].Position;
+                const auto normal = glm::cross(b - a, d - a);
+                const float area = glm::length(normal);
+                cluster.Centroid += (a + b + d) * (area / 3.0f);
+                cluster.Normal += normal;
+                cluster.Area += area;
+            }
+            meshCentroid += cluster.Centroid;
+            meshArea += cluster.Area;
+            if (cluster.Area > 0.0f)
+                cluster.Centroid /= cluster.Area;
+            sorted.push_back(cluster);
+        }
+        if (meshArea <= 0.0f)
+            return;
+        meshCentroid /= meshArea;
+
+        // Clusters facing away from the centre are likely to occlude the rest, so they go first.
+        for (auto &cluster: sorted) {
+            const float length = glm::length(cluster.Normal);
+            cluster.Key = length > 0.0f ? glm::dot(cluster.Centroid - meshCentroid, cluster.Normal / length) : 0.0f;
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster &a, const Cluster &b) {
+            return a.Key > b.Key;
+        });
+
+        std::vector<std::uint32_t> reordered;
+        reordered.reserve(indices.size());
+        for (const auto &cluster: sorted) {
+            const auto begin = indices.begin() + cluster.First * 3;
+            reordered.insert(reordered.end(), begin, begin + cluster.Count * 3);
+        }
+
+        const auto before = AnalyzeVertexCache(indices, vertices.size()).Acmr();
+        const auto after = AnalyzeVertexCache(reordered, vertices.size()).Acmr();
+        if (after <= before * threshold)
+            std::copy(reordered.begin(), reordered.end(), indices.begin());
+    }
+
+    std::size_t MeshOptimizer::OptimizeVertexFetch(std::span<Vertex> vertices, std::span<std::uint32_t> indices) {
+        std::vector<std::uint32_t> remap(vertices.size(), Unused);
+        std::vector<Vertex> reordered;
+        reordered.reserve(vertices.size());
+        for (auto &index: indices) {
+            if (remap[index] == Unused) {
+                remap[index] = static_cast<std::uint32_t>(reordered.size());
+                reordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        std::copy(reordered.begin(), reordered.end(), vertices.begin());
+        return reordered.size();
+    }
+}
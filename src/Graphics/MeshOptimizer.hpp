@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Post-transform cache statistics from a FIFO simulation. Sums across meshes with +=.
+    struct VertexCacheStats {
+        std::size_t Triangles{};
+        std::size_t Transformed{};
+        std::size_t Vertices{};
+
+        // Average cache miss ratio: vertex shader invocations per triangle, 0.5 at best.
+        [[nodiscard]] float Acmr() const;
+
+        // Average transform to vertex ratio: invocations per referenced vertex, 1.0 at best.
+        [[nodiscard]] float Atvr() const;
+
+        VertexCacheStats &operator+=(const VertexCacheStats &other);
+    };
+
+    // Import-time triangle and vertex reordering. All passes work on one mesh with indices local to its vertices.
+    class MeshOptimizer {
+    public:
+        static constexpr std::size_t CacheSize = 16;
+
+        static VertexCacheStats AnalyzeVertexCache(std::span<const std::uint32_t> indices, std::size_t vertexCount,
+                                                   std::size_t cacheSize = CacheSize);
+
+        // Tipsify. Returns the first triangle of every cluster it produced, for OptimizeOverdraw.
+        static std::vector<std::uint32_t> OptimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertexCount,
+                                                              std::size_t cacheSize = CacheSize);
+
+        // Draws outward-facing clusters first, unless that raises ACMR past threshold times the current value.
+        static void OptimizeOverdraw(std::span<std::uint32_t> indices, std::span<const Vertex> vertices,
+                                     std::span<const std::uint32_t> clusters, float threshold = 1.05f);
+
+        // Orders vertices by first use and drops unreferenced ones. Returns the new vertex count.
+        static std::size_t OptimizeVertexFetch(std::span<Vertex> vertices, std::span<std::uint32_t> indices);
+    };
+}
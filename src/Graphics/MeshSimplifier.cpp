@@ -0,0 +1,325 @@
+#include "MeshSimplifier.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace Graphics {
+
+    namespace {
+        // Sum of squared distances to a set of planes, weighted by triangle area.
+        struct Quadric {
+            double A00{}, A01{}, A02{}, A11{}, A12{}, A22{};
+            double B0{}, B1{}, B2{};
+            double C{};
+            double Weight{};
+
+            static Quadric FromPlane(glm::dvec3 normal, double distance, double weight) {
+                Quadric quadric;
+                quadric.A00 = normal.x * normal.x * weight;
+                quadric.A01 = normal.x * normal.y * weight;
+                quadric.A02 = normal.x * normal.z * weight;
+                quadric.A11 = normal.y * normal.y * weight;
+                quadric.A12 = normal.y * normal.z * weight;
+                quadric.A22 = normal.z * normal.z * weight;
+                quadric.B0 = normal.x * distance * weight;
+                quadric.B1 = normal.y * distance * weight;
+                quadric.B2 = normal.z * distance * weight;
+                quadric.C = distance * distance * weight;
+                quadric.Weight = weight;
+                return quadric;
+            }
+
+            Quadric &operator+=(const Quadric &other) {
+                A00 += other.A00;
+                A01 += other.A01;
+                A02 += other.A02;
+                A11 += other.A11;
+                A12 += other.A12;
+                A22 += other.A22;
+                B0 += other.B0;
+                B1 += other.B1;
+                B2 += other.B2;
+                C += other.C;
+                Weight += other.Weight;
+                return *this;
+            }
+
+            // Mean squared distance of the point to the accumulated planes.
+            [[nodiscard]] double Error(glm::dvec3 p) const {
+                const double error = A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z +
+                                     2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z) +
+                                     2.0 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+                return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+            }
+        };
+
+        struct Collapse {
+            std::uint32_t From;
+            std::uint32_t To;
+            float Cost;
+        };
+
+        std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b) {
+            return static_cast<std::uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+        }
+
+        struct PositionHash {
+            std::size_t operator()(const glm::vec3 &p) const {
+                const auto x = std::bit_cast<std::uint32_t>(p.x);
+                const auto y = std::bit_cast<std::uint32_t>(p.y);
+                const auto z = std::bit_cast<std::uint32_t>(p.z);
+                return (x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u);
+            }
+        };
+
+        // A vertex may only move if its position is unique (no UV or normal seam) and every edge around it is
+        // shared by exactly two triangles (no border or non-manifold fan).
+        std::vector<bool> FindLockedVertices(std::span<const Vertex> vertices, std::span<const std::uint32_t> indices) {
+            std::unordered_map<glm::vec3, std::uint32_t, PositionHash> positions;
+            std::vector<std::uint32_t> welded(vertices.size());
+            std::vector<std::uint32_t> copies(vertices.size(), 0);
+            for (std::size_t i = 0; i < vertices.size(); i++) {
+                welded[i] = positions.try_emplace(vertices[i].Position, static_cast<std::uint32_t>(i)).first->second;
+                copies[welded[i]]++;
+            }
+
+            std::unordered_map<std::uint64_t, std::uint32_t> edges;
+            for (std::size_t t = 0; t < indices.size(); t += 3) {
+                for (int e = 0; e < 3; e++)
+                    edges[EdgeKey(welded[indices[t + e]], welded[indices[t + (e + 1) % 3]])]++;
+            }
+
+            std::vector<bool> lockedPosition(vertices.size(), false);
+            for (const auto &[key, count]: edges) {
+                if (count != 2) {
+                    lockedPosition[key >> 32] = true;
+                    lockedPosition[key & 0xffffffffu] = true;
+                }
+            }
+
+            std::vector<bool> locked(vertices.size());
+            for (std::size_t i = 0; i < vertices.size(); i++)
+                locked[i] = copies[welded[i]] > 1 || lockedPosition[welded[i]];
+            return locked;
+        }
+
+        // Closest point on triangle abc to p, by the Voronoi region p falls in.
+        float DistanceToTriangle(glm::vec3 p, glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+            const auto ab = b - a;
+            const auto ac = c - a;
+            const auto ap = p - a;
+            const float d1 = glm::dot(ab, ap);
+            const float d2 = glm::dot(ac, ap);
+            if (d1 <= 0.0f && d2 <= 0.0f)
+                return glm::length(ap);
+
+            const auto bp = p - b;
+            const float d3 = glm::dot(ab, bp);
+            const float d4 = glm::dot(ac, bp);
+            if (d3 >= 0.0f && d4 <= d3)
+                return glm::length(bp);
+
+            const float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+                return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+
+            const auto cp = p - c;
+            const float d5 = glm::dot(ab, cp);
+            const float d6 = glm::dot(ac, cp);
+            if (d6 >= 0.0f && d5 <= d6)
+                return glm::length(cp);
+
+            const float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+                return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+
+            const float va = d3 * d6 - d5 * d4;
+            if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+                return glm::length(p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+
+            const float denominator = 1.0f / (va + vb + vc);
+            return glm::length(p - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+        }
+
+        // Largest distance from an original vertex or triangle centroid to the simplified triangles around the
+        // vertices it collapsed into. Samples whose vertices lost every triangle are skipped.
+        float MeasureDeviation(std::span<const Vertex> vertices, std::span<const std::uint32_t> indices,
+                               std::span<const std::uint32_t> simplified,
+                               std::span<const std::uint32_t> representative) {
+            std::vector<std::uint32_t> offsets(vertices.size() + 1);
+            for (const auto index: simplified)
+                offsets[index + 1]++;
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            std::vector<std::uint32_t> adjacent(simplified.size());
+            auto cursor = offsets;
+            for (std::size_t i = 0; i < simplified.size(); i++)
+                adjacent[cursor[simplified[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+            float deviation = 0.0f;
+            const auto measure = [&](glm::vec3 point, std::span<const std::uint32_t> around) {
+                float nearest = std::numeric_limits<float>::max();
+                for (const auto vertex: around) {
+                    for (auto i = offsets[vertex]; i < offsets[vertex + 1]; i++) {
+                        const auto *triangle = &simplified[adjacent[i] * 3];
+                        nearest = std::min(nearest, DistanceToTriangle(point, vertices[triangle[0]].Position,
+                                                                       vertices[triangle[1]].Position,
+                                                                       vertices[triangle[2]].Position));
+                    }
+                }
+                if (nearest != std::numeric_limits<float>::max())
+                    deviation = std::max(deviation, nearest);
+            };
+
+            for (std::size_t t = 0; t < indices.size(); t += 3) {
+                const std::uint32_t around[3] = {representative[indices[t]], representative[indices[t + 1]],
+                                                 representative[indices[t + 2]]};
+                for (int corner = 0; corner < 3; corner++)
+                    measure(vertices[indices[t + corner]].Position, std::span(around + corner, 1));
+                const auto centroid = (vertices[indices[t]].Position + vertices[indices[t + 1]].Position +
+                                       vertices[indices[t + 2]].Position) / 3.0f;
+                measure(centroid, around);
+            }
+            return deviation;
+        }
+
+        bool FlipsTriangle(std::span<const Vertex> vertices, const std::uint32_t *triangle, std::uint32_t from,
+                           std::uint32_t to) {
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            for (int corner = 0; corner < 3; corner++) {
+                before[corner] = vertices[triangle[corner]].Position;
+                after[corner] = vertices[triangle[corner] == from ? to : triangle[corner]].Position;
+            }
+            const auto normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const auto normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            return glm::dot(normalBefore, normalAfter) <= 0.0f;
+        }
+    }
+
+    std::vector<std::uint32_t> MeshSimplifier::Simplify(std::span<const Vertex> vertices,
+                                                        std::span<const std::uint32_t> indices,
+                                                        std::size_t targetIndexCount, float maxError,
+                                                        float &error) {
+        error = 0.0f;
+        std::vector<std::uint32_t> result(indices.begin(), indices.end());
+        if (result.size() <= targetIndexCount)
+            return result;
+
+        const auto locked = FindLockedVertices(vertices, indices);
+        std::vector<Quadric> quadrics(vertices.size());
+        for (std::size_t t = 0; t < indices.size(); t += 3) {
+            const glm::dvec3 a = vertices[indices[t]].Position;
+            const glm::dvec3 b = vertices[indices[t + 1]].Position;
+            const glm::dvec3 c = vertices[indices[t + 2]].Position;
+            auto normal = glm::cross(b - a, c - a);
+            const double length = glm::length(normal);
+            if (length <= 0.0)
+                continue;
+            normal /= length;
+            const auto plane = Quadric::FromPlane(normal, -glm::dot(normal, a), length * 0.5);
+            for (int corner = 0; corner < 3; corner++)
+                quadrics[indices[t + corner]] += plane;
+        }
+
+        const auto cost = [&](std::uint32_t from, std::uint32_t to) {
+            auto merged = quadrics[from];
+            merged += quadrics[to];
+            return static_cast<float>(std::sqrt(merged.Error(glm::dvec3(vertices[to].Position))));
+        };
+
+        std::vector<std::uint32_t> offsets(vertices.size() + 1);
+        std::vector<std::uint32_t> adjacent;
+        std::vector<std::uint32_t> remap(vertices.size());
+        // The vertex each original one has collapsed into so far.
+        std::vector<std::uint32_t> representative(vertices.size());
+        std::iota(representative.begin(), representative.end(), 0u);
+        std::vector<bool> touched(vertices.size());
+        std::vector<Collapse> collapses;
+        const auto targetTriangles = targetIndexCount / 3;
+
+        // Each pass collapses a set of edges whose neighbourhoods do not overlap, then rewrites the index buffer.
+        while (result.size() > targetIndexCount) {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (const auto index: result)
+                offsets[index + 1]++;
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            adjacent.resize(result.size());
+            auto cursor = offsets;
+            for (std::size_t i = 0; i < result.size(); i++)
+                adjacent[cursor[result[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+            collapses.clear();
+            for (std::size_t t = 0; t < result.size(); t += 3) {
+                for (int e = 0; e < 3; e++) {
+                    const auto a = result[t + e];
+                    const auto b = result[t + (e + 1) % 3];
+                    if (!locked[a])
+                        collapses.push_back({a, b, cost(a, b)});
+                    if (!locked[b])
+                        collapses.push_back({b, a, cost(b, a)});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                return a.Cost < b.Cost;
+            });
+
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::fill(touched.begin(), touched.end(), false);
+            auto triangles = result.size() / 3;
+            bool collapsed = false;
+            for (const auto &collapse: collapses) {
+                if (collapse.Cost > maxError || triangles <= targetTriangles)
+                    break;
+                if (touched[collapse.From] || touched[collapse.To])
+                    continue;
+
+                std::size_t removed = 0;
+                bool flips = false;
+                for (auto i = offsets[collapse.From]; i < offsets[collapse.From + 1] && !flips; i++) {
+                    const auto *triangle = &result[adjacent[i] * 3];
+                    if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+                        removed++;
+                    else
+                        flips = FlipsTriangle(vertices, triangle, collapse.From, collapse.To);
+                }
+                if (flips)
+                    continue;
+
+                for (auto i = offsets[collapse.From]; i < offsets[collapse.From + 1]; i++) {
+                    for (int corner = 0; corner < 3; corner++)
+                        touched[result[adjacent[i] * 3 + corner]] = true;
+                }
+                remap[collapse.From] = collapse.To;
+                quadrics[collapse.To] += quadrics[collapse.From];
+                triangles -= std::min(removed, triangles);
+                error = std::max(error, collapse.Cost);
+                collapsed = true;
+            }
+            if (!collapsed)
+                break;
+            for (auto &vertex: representative)
+                vertex = remap[vertex];
+
+            std::size_t written = 0;
+            for (std::size_t t = 0; t < result.size(); t += 3) {
+                const auto a = remap[result[t]];
+                const auto b = remap[result[t + 1]];
+                const auto c = remap[result[t + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                result[written++] = a;
+                result[written++] = b;
+                result[written++] = c;
+            }
+            result.resize(written);
+        }
+
+        // Collapse costs are RMS distances to the merged planes, which a single spike can exceed.
+        if (result.size() < indices.size())
+            error = std::max(error, MeasureDeviation(vertices, indices, result, representative));
+        return result;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Quadric error edge collapse into existing vertices, so every level of detail shares the mesh vertex buffer.
+    class MeshSimplifier {
+    public:
+        // Collapses edges cheapest first until at most targetIndexCount indices remain or the next collapse's
+        // quadric error, the RMS distance to the planes it merges, exceeds maxError object-space units. Border and
+        // attribute seam vertices stay put. error receives the largest distance from an original vertex or
+        // triangle centroid to the simplified surface around it, and never less than any collapse's quadric error.
+        static std::vector<std::uint32_t> Simplify(std::span<const Vertex> vertices,
+                                                   std::span<const std::uint32_t> indices,
+                                                   std::size_t targetIndexCount, float maxError, float &error);
+    };
+}
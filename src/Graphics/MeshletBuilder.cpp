@@ -0,0 +1,208 @@
+#include "MeshletBuilder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::uint32_t Unused = ~0u;
+
+        // Cones wider than a hemisphere can not be culled; this cutoff is never reached.
+        constexpr float NoCone = std::numeric_limits<float>::max();
+
+        constexpr float MaxMergeGrowth = 1.25f;
+    }
+
+    std::vector<Meshlet> MeshletBuilder::Build(std::span<const Vertex> vertices, std::span<std::uint32_t> indices) {
+        const auto triangleCount = indices.size() / 3;
+        std::vector<Meshlet> meshlets;
+        if (triangleCount == 0)
+            return meshlets;
+
+        std::vector<std::uint32_t> offsets(vertices.size() + 1, 0);
+        for (const auto index: indices)
+            offsets[index + 1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<std::uint32_t> adjacent(indices.size());
+        auto cursor = offsets;
+        for (std::size_t i = 0; i < indices.size(); i++)
+            adjacent[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+        std::vector<glm::vec3> centroids(triangleCount);
+        for (std::size_t t = 0; t < triangleCount; t++) {
+            centroids[t] = (vertices[indices[t * 3]].Position + vertices[indices[t * 3 + 1]].Position +
+                            vertices[indices[t * 3 + 2]].Position) / 3.0f;
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<std::uint32_t> stamp(vertices.size(), Unused);
+        std::vector<std::uint32_t> clusterVertices;
+        std::vector<std::uint32_t> output;
+        output.reserve(indices.size());
+
+        // The next cluster starts next to the previous one, so the surface is consumed without leaving islands.
+        std::size_t cursorTriangle = 0;
+        const auto nextSeed = [&]() -> std::size_t {
+            for (const auto vertex: clusterVertices) {
+                for (auto i = offsets[vertex]; i < offsets[vertex + 1]; i++) {
+                    if (!emitted[adjacent[i]])
+                        return adjacent[i];
+                }
+            }
+            while (cursorTriangle < triangleCount && emitted[cursorTriangle])
+                cursorTriangle++;
+            return cursorTriangle;
+        };
+
+        for (auto cluster = 0u;; cluster++) {
+            const auto seed = nextSeed();
+            if (seed == triangleCount)
+                break;
+
+            clusterVertices.clear();
+            glm::vec3 centroidSum(0.0f);
+            std::size_t triangles = 0;
+            const auto emit = [&](std::size_t triangle) {
+                emitted[triangle] = true;
+                for (int corner = 0; corner < 3; corner++) {
+                    const auto vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    if (stamp[vertex] != cluster) {
+                        stamp[vertex] = cluster;
+                        clusterVertices.push_back(vertex);
+                    }
+                }
+                centroidSum += centroids[triangle];
+                triangles++;
+            };
+
+            Meshlet meshlet{};
+            meshlet.FirstIndex = static_cast<std::uint32_t>(output.size());
+            emit(seed);
+
+            // Prefer triangles that add the fewest new vertices, then the one closest to the cluster centre.
+            while (triangles < MaxTriangles) {
+                const auto center = centroidSum / static_cast<float>(triangles);
+                auto best = Unused;
+                int bestNew = 4;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (const auto vertex: clusterVertices) {
+                    for (auto i = offsets[vertex]; i < offsets[vertex + 1]; i++) {
+                        const auto triangle = adjacent[i];
+                        if (emitted[triangle])
+                            continue;
+                        int added = 0;
+                        for (int corner = 0; corner < 3; corner++)
+                            added += stamp[indices[triangle * 3 + corner]] != cluster;
+                        if (clusterVertices.size() + added > MaxVertices)
+                            continue;
+                        const auto offset = centroids[triangle] - center;
+                        const float distance = glm::dot(offset, offset);
+                        if (added < bestNew || (added == bestNew && distance < bestDistance)) {
+                            best = triangle;
+                            bestNew = added;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+                if (best == Unused)
+                    break;
+                emit(best);
+            }
+
+            meshlet.IndexCount = static_cast<std::uint32_t>(output.size()) - meshlet.FirstIndex;
+            meshlets.push_back(meshlet);
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+
+        // Greedy growth strands small islands; consecutive meshlets are neighbours, so fold them into each other
+        // when the result stays compact.
+        std::vector<Meshlet> merged;
+        merged.reserve(meshlets.size());
+        for (auto &meshlet: meshlets) {
+            ComputeBounds(meshlet, vertices, indices);
+            if (!merged.empty()) {
+                auto &previous = merged.back();
+                const bool small = std::min(previous.IndexCount, meshlet.IndexCount) < MaxTriangles * 3 / 4;
+                if (small && previous.IndexCount + meshlet.IndexCount <= MaxTriangles * 3) {
+                    Meshlet combined{};
+                    combined.FirstIndex = previous.FirstIndex;
+                    combined.IndexCount = previous.IndexCount + meshlet.IndexCount;
+                    ComputeBounds(combined, vertices, indices);
+                    if (combined.Radius <= std::max(previous.Radius, meshlet.Radius) * MaxMergeGrowth) {
+                        previous = combined;
+                        continue;
+                    }
+                }
+            }
+            merged.push_back(meshlet);
+        }
+        return merged;
+    }
+
+    void MeshletBuilder::ComputeBounds(Meshlet &meshlet, std::span<const Vertex> vertices,
+                                       std::span<const std::uint32_t> indices) {
+        const auto range = indices.subspan(meshlet.FirstIndex, meshlet.IndexCount);
+        meshlet.BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+        meshlet.BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        for (const auto index: range) {
+            meshlet.BoundsMin = glm::min(meshlet.BoundsMin, vertices[index].Position);
+            meshlet.BoundsMax = glm::max(meshlet.BoundsMax, vertices[index].Position);
+        }
+        meshlet.Center = (meshlet.BoundsMin + meshlet.BoundsMax) * 0.5f;
+        meshlet.Radius = 0.0f;
+        for (const auto index: range)
+            meshlet.Radius = std::max(meshlet.Radius, glm::length(vertices[index].Position - meshlet.Center));
+
+        struct Face {
+            glm::vec3 Point;
+            glm::vec3 Normal;
+        };
+        std::vector<Face> faces;
+        faces.reserve(range.size() / 3);
+        glm::vec3 normalSum(0.0f);
+        for (std::size_t t = 0; t + 2 < range.size(); t += 3) {
+            const auto &a = vertices[range[t]].Position;
+            const auto normal = glm::cross(vertices[range[t + 1]].Position - a, vertices[range[t + 2]].Position - a);
+            const float length = glm::length(normal);
+            if (length <= 0.0f)
+                continue;
+            faces.push_back({a, normal / length});
+            normalSum += normal / length;
+        }
+
+        meshlet.ConeApex = meshlet.Center;
+        meshlet.ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.ConeCutoff = NoCone;
+        const float axisLength = glm::length(normalSum);
+        if (faces.empty() || axisLength <= 0.0f)
+            return;
+
+        const auto axis = normalSum / axisLength;
+        float minDot = 1.0f;
+        for (const auto &face: faces)
+            minDot = std::min(minDot, glm::dot(axis, face.Normal));
+        if (minDot <= 0.0f)
+            return;
+
+        // Pull the apex back along the axis until every triangle plane lies in front of it.
+        float maxT = 0.0f;
+        for (const auto &face: faces)
+            maxT = std::max(maxT, glm::dot(meshlet.Center - face.Point, face.Normal) / glm::dot(axis, face.Normal));
+
+        meshlet.ConeApex = meshlet.Center - axis * maxT;
+        meshlet.ConeAxis = axis;
+        meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+
+    bool MeshletBuilder::IsVisible(const Meshlet &meshlet, const Core::Frustum &frustum, glm::vec3 camera,
+                                   bool backfaceCulling) {
+        if (!frustum.IntersectsSphere(meshlet.Center, meshlet.Radius) ||
+            !frustum.IntersectsBox(meshlet.BoundsMin, meshlet.BoundsMax))
+            return false;
+        return !backfaceCulling || !(glm::dot(glm::normalize(meshlet.ConeApex - camera), meshlet.ConeAxis) >= meshlet.ConeCutoff);
+    }
+}
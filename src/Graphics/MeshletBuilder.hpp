@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "Core/Frustum.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Import-time split of a mesh into spatially compact clusters that can be culled before drawing.
+    class MeshletBuilder {
+    public:
+        static constexpr std::size_t MaxVertices = 64;
+        static constexpr std::size_t MaxTriangles = 124;
+
+        // Grows clusters over shared vertices and rewrites indices so each cluster is one contiguous range.
+        static std::vector<Meshlet> Build(std::span<const Vertex> vertices, std::span<std::uint32_t> indices);
+
+        // Bounding sphere, box and backface cone of the triangles in the meshlet's index range.
+        static void ComputeBounds(Meshlet &meshlet, std::span<const Vertex> vertices,
+                                  std::span<const std::uint32_t> indices);
+
+        // Frustum and camera in the object space of the mesh. Shadow passes turn the cone test off, since back
+        // faces still cast shadows.
+        [[nodiscard]] static bool IsVisible(const Meshlet &meshlet, const Core::Frustum &frustum, glm::vec3 camera,
+                                            bool backfaceCulling = true);
+    };
+}
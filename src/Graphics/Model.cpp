@@ -1,31 +1,299 @@
 #include "Model.hpp"
+#include "ImporterFileSystem.hpp"
+#include "RenderState.hpp"
+#include "Core/OcclusionBuffer.hpp"
+#include "Core/ThreadPool.hpp"
+#include "Core/Scheduler.hpp"
+#include <future>
+#include <limits>
+#include <unordered_set>
 
 namespace Graphics {
 
     void Graphics::Model::Draw(Graphics::Shader &shader) {
-        for (auto &Meshe: Meshes)
-            Meshe.Draw(shader);
+        for (auto &Meshe: Meshes) {
+            BindMaterial(shader, Meshe.MaterialIndex);
+            Meshe.Draw();
+        }
+    }
+
+    void Graphics::Model::Draw(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model) {
+        if (GpuCuller::IsSupported()) {
+            DrawCulledOnGpu(shader, view, model);
+            return;
+        }
+        CullMeshes(view.Frustum.Transformed(model));
+        if (view.Occluders)
+            CullOccluded(*view.Occluders, model);
+        DrawVisible(shader, view, model);
+    }
+
+    void Graphics::Model::Draw(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model,
+                               std::span<const std::uint8_t> visible) {
+        _visible.assign(visible.begin(), visible.end());
+        _visible.resize(Meshes.size(), 0);
+        Core::CullStats stats;
+        for (const auto flag: _visible)
+            stats.Visible += flag != 0;
+        stats.Culled = _visible.size() - stats.Visible;
+        _cullCounters += stats;
+        DrawVisible(shader, view, model);
+    }
+
+    void Graphics::Model::DrawVisible(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model) {
+        const auto frustum = view.Frustum.Transformed(model);
+        const auto camera = glm::vec3(glm::inverse(model) * glm::vec4(view.Position, 1.0f));
+        if (!IndirectDrawList::IsSupported()) {
+            for (std::size_t i = 0; i < Meshes.size(); i++) {
+                if (!_visible[i])
+                    continue;
+                auto &mesh = Meshes[i];
+                const float pixelsPerUnit = view.PixelsPerUnit(model, mesh.BoundsCenter(), mesh.BoundsRadius());
+                const auto lod = mesh.SelectLod(pixelsPerUnit, view.LodThreshold);
+                BindMaterial(shader, mesh.MaterialIndex);
+                if (lod == 0 && !mesh.Meshlets.empty())
+                    mesh.DrawMeshlets(frustum, camera, view.BackfaceCulling);
+                else
+                    mesh.Draw(lod);
+            }
+            return;
+        }
+
+        if (!_drawList)
+            _drawList = std::make_unique<IndirectDrawList>(_format);
+        if (_records.size() != Meshes.size() || _recordedModel != model)
+            UpdateRecords(model);
+
+        _drawList->Clear();
+        for (std::uint32_t i = 0; i < Meshes.size(); i++) {
+            if (!_visible[i])
+                continue;
+            const auto &mesh = Meshes[i];
+            const float pixelsPerUnit = view.PixelsPerUnit(model, mesh.BoundsCenter(), mesh.BoundsRadius());
+            const auto lod = mesh.SelectLod(pixelsPerUnit, view.LodThreshold);
+            if (lod == 0 && !mesh.Meshlets.empty()) {
+                _ranges.clear();
+                mesh.CullMeshlets(frustum, camera, view.BackfaceCulling, _ranges);
+                for (const auto &range: _ranges)
+                    _drawList->Add(i, mesh, range);
+            } else {
+                _drawList->Add(i, mesh, {mesh.Lods[lod].FirstIndex, mesh.Lods[lod].IndexCount});
+            }
+        }
+
+        const bool tabled = _materialTable && shader.Permutation().MaterialTextures == _materialTable->Mode();
+        const auto batches = _drawList->Build(!tabled);
+        if (batches.empty())
+            return;
+
+        shader.SetBool("perDrawModel", true);
+        if (tabled)
+            _materialTable->Bind(shader);
+        _drawList->Bind();
+        for (const auto &batch: batches) {
+            if (!tabled)
+                BindMaterial(shader, Meshes[batch.Record].MaterialIndex);
+            _drawList->Draw(batch);
+        }
+        shader.SetBool("perDrawModel", false);
+    }
+
+    void Graphics::Model::DrawCulledOnGpu(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model) {
+        if (!_drawList)
+            _drawList = std::make_unique<IndirectDrawList>(_format);
+        if (!_gpuCuller)
+            _gpuCuller = std::make_unique<GpuCuller>();
+        if (_records.size() != Meshes.size() || _recordedModel != model)
+            UpdateRecords(model);
+
+        const bool tabled = _materialTable && shader.Permutation().MaterialTextures == _materialTable->Mode();
+        const auto batches = _gpuCuller->Prepare(Meshes, !tabled);
+        if (batches.empty())
+            return;
+        _cullCounters += _gpuCuller->Cull(view, model);
+
+        shader.Use();
+        shader.SetBool("perDrawModel", true);
+        if (tabled)
+            _materialTable->Bind(shader);
+        _drawList->Bind();
+        _gpuCuller->Bind();
+        for (const auto &batch: batches) {
+            if (!tabled)
+                BindMaterial(shader, batch.MaterialIndex);
+            _gpuCuller->Draw(batch);
+        }
+        shader.SetBool("perDrawModel", false);
+    }
+
+    Graphics::MaterialTextureMode Graphics::Model::MaterialTextures() {
+        if (!_materialTableBuilt && IsResident() && IndirectDrawList::IsSupported()) {
+            _materialTable = MaterialTable::Create(Materials);
+            _materialTableBuilt = true;
+        }
+        return _materialTable ? _materialTable->Mode() : MaterialTextureMode::Bound;
+    }
+
+    void Graphics::Model::UpdateRecords(const glm::mat4 &model) {
+        _records.clear();
+        _records.reserve(Meshes.size());
+        for (const auto &mesh: Meshes)
+            _records.push_back({model, mesh.BoundsMin, mesh.BoundsMax - mesh.BoundsMin, mesh.MaterialIndex, 0});
+        _recordedModel = model;
+        _drawList->SetRecords(_records);
+    }
+
+    void Graphics::Model::CullMeshes(const Core::Frustum &frustum) {
+        // Meshes only ever append while streaming, so the set is extended rather than rebuilt.
+        for (auto i = _bounds.Size(); i < Meshes.size(); i++)
+            _bounds.Add(Meshes[i].BoundsMin, Meshes[i].BoundsMax);
+        _cullCounters += _bounds.Cull(frustum, _visible);
+    }
+
+    void Graphics::Model::CullOccluded(const Core::OcclusionBuffer &occluders, const glm::mat4 &model) {
+        std::uint64_t hidden = 0;
+        for (std::size_t i = 0; i < _visible.size(); i++) {
+            const Core::Bounds bounds{Meshes[i].BoundsMin, Meshes[i].BoundsMax};
+            if (_visible[i] && !occluders.IsVisible(bounds.Transformed(model))) {
+                _visible[i] = 0;
+                hidden++;
+            }
+        }
+        _cullCounters.Visible -= hidden;
+        _cullCounters.Culled += hidden;
+    }
+
+    Core::CullStats Graphics::Model::CullCounters() {
+        return _cullCounters;
+    }
+
+    void Graphics::Model::ResetCullCounters() {
+        _cullCounters = {};
+    }
+
+    void Graphics::Model::BindMaterial(Shader &shader, std::uint32_t index) const {
+        if (index < Materials.size())
+            Materials[index].Bind(shader);
+    }
+
+    glm::vec3 Graphics::Model::BoundsCenter() const {
+        if (Meshes.empty())
+            return glm::vec3(0.0f);
+        auto boundsMin = Meshes.front().BoundsMin;
+        auto boundsMax = Meshes.front().BoundsMax;
+        for (const auto &mesh: Meshes) {
+            boundsMin = glm::min(boundsMin, mesh.BoundsMin);
+            boundsMax = glm::max(boundsMax, mesh.BoundsMax);
+        }
+        return (boundsMin + boundsMax) * 0.5f;
+    }
+
+    float Graphics::Model::BoundsRadius() const {
+        const auto center = BoundsCenter();
+        float radius = 0.0f;
+        for (const auto &mesh: Meshes)
+            radius = std::max(radius, glm::length(mesh.BoundsCenter() - center) + mesh.BoundsRadius());
+        return radius;
+    }
+
+    bool Graphics::Model::IsResident() const {
+        return _loading.IsReady();
+    }
+
+    const Core::Task<void> &Graphics::Model::Loaded() const {
+        return _loading;
+    }
+
+    std::shared_ptr<Graphics::Model> Graphics::Model::LoadAsync(const std::string &path, VertexFormat format) {
+        std::shared_ptr<Model> model(new Model());
+        model->_format = format;
+        model->_directory = path.substr(0, path.find_last_of('/'));
+        model->_loading = StreamModel(model, path);
+        return model;
     }
 
     void Graphics::Model::LoadModel(const std::string &path) {
+        _directory = path.substr(0, path.find_last_of('/'));
+
+        ModelSource source;
+        if (!ReadModel(path, source))
+            return;
+
+        // Decode every file the cache does not hold yet on the worker pool; only the upload waits for the GL thread.
+        const auto pending = CollectTextures(source.Data);
+        std::vector<std::future<DecodedTexture>> decoded;
+        decoded.reserve(pending.size());
+        for (const auto &texture: pending) {
+            decoded.push_back(Core::ThreadPool::Shared().Submit(
+                    [file = _directory + '/' + texture.Path, params = ParamsFor(texture.Kind)] {
+                        return TextureCache::Decode(file, params);
+                    }));
+        }
+
+        auto &cache = TextureCache::Shared();
+        for (std::size_t i = 0; i < pending.size(); i++) {
+            TexturesLoaded.push_back(cache.Insert(_directory + '/' + pending[i].Path, ParamsFor(pending[i].Kind),
+                                                  decoded[i].get()));
+        }
+
+        ResolveMaterials(source.Data, Core::LoadMode::Blocking);
+        Meshes.reserve(source.Data.Meshes.size());
+        for (const auto &mesh: source.Data.Meshes)
+            AddMesh(source.Data, mesh);
+    }
+
+    Core::Task<void> Graphics::Model::StreamModel(std::shared_ptr<Model> model, std::string path) {
+        constexpr std::size_t meshesPerSlice = 16;
+
+        co_await Core::Scheduler::WorkerThread();
+        ModelSource source;
+        if (!ReadModel(path, source))
+            co_return;
+
+        // Meshes become drawable slice by slice, sampling placeholder texels until their images arrive.
+        co_await Core::Scheduler::MainThread();
+        model->ResolveMaterials(source.Data, Core::LoadMode::Async);
+        model->Meshes.reserve(source.Data.Meshes.size());
+        for (std::size_t i = 0; i < source.Data.Meshes.size(); i++) {
+            model->AddMesh(source.Data, source.Data.Meshes[i]);
+            if ((i + 1) % meshesPerSlice == 0)
+                co_await Core::Scheduler::MainThread();
+        }
+
+        for (const auto &texture: model->TexturesLoaded)
+            co_await texture->Loading;
+    }
+
+    bool Graphics::Model::ReadModel(const std::string &path, ModelSource &source) {
+        const auto sourceHash = ModelCache::HashSource(path);
+        source.Cache = ModelCache::Open(path, sourceHash, ImportFlags);
+        if (source.Cache) {
+            source.Data = source.Cache->Data();
+            return true;
+        }
+
+        auto &imported = source.Imported;
+        if (!ImportModel(path, imported))
+            return false;
+
+        source.Data = {imported.Vertices, imported.Indices, imported.Meshes, imported.Meshlets,
+                       std::move(imported.Textures), imported.MaterialCount};
+        ModelCache::Write(path, sourceHash, ImportFlags, source.Data);
+        return true;
+    }
+
+    bool Graphics::Model::ImportModel(const std::string &path, ImportedModel &imported) {
         Assimp::Importer import;
-        const aiScene *scene = import.ReadFile(
-                path,
-                aiProcess_GenNormals |
-                aiProcess_Triangulate |
-                aiProcess_JoinIdenticalVertices |
-                aiProcess_OptimizeMeshes |
-                aiProcess_FindInvalidData
-        );
+        // The importer owns and deletes its IO handler.
+        import.SetIOHandler(new ImporterFileSystem);
+        const aiScene *scene = import.ReadFile(path, ImportFlags);
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
             auto error =  import.GetErrorString();
             Log::Error("ASSIMP: {}", error);
-            return;
+            return false;
         }
 
-        _directory = path.substr(0, path.find_last_of('/'));
-
 //        for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
 //            aiMaterial *material = scene->mMaterials[i];
 //            fmt::print("{}\n", material->GetName().C_Str());
@@ -46,23 +314,104 @@ namespace Graphics {
 //            }
 //        }
 
-        ProcessNode(scene->mRootNode, scene);
+        imported.MaterialCount = scene->mNumMaterials;
+        for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+            LoadMaterialTextures(scene->mMaterials[i], aiTextureType_DIFFUSE, TextureKind::Diffuse, i, imported);
+            LoadMaterialTextures(scene->mMaterials[i], aiTextureType_SPECULAR, TextureKind::Specular, i, imported);
+        }
+
+        imported.SceneMeshes.reserve(scene->mNumMeshes);
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+            imported.SceneMeshes.push_back(ProcessMesh(scene->mMeshes[i], imported));
+
+        ProcessNode(scene->mRootNode, imported);
+
+        const auto &before = imported.Unoptimized;
+        const auto &after = imported.Optimized;
+        Log::Information(fmt::format("MESH_OPTIMIZER {} ACMR {:.3f} -> {:.3f} ATVR {:.3f} -> {:.3f}", path,
+                                     before.Acmr(), after.Acmr(), before.Atvr(), after.Atvr()));
+        const auto &lods = imported.LodTriangles;
+        Log::Information(fmt::format("MESH_LOD {} triangles {} / {} / {} / {}", path,
+                                     lods[0], lods[1], lods[2], lods[3]));
+        return true;
+    }
+
+    std::vector<bool> Graphics::Model::UsedMaterials(const ModelData &data) {
+        std::vector<bool> used(data.MaterialCount, false);
+        for (const auto &mesh: data.Meshes) {
+            if (mesh.MaterialIndex < data.MaterialCount)
+                used[mesh.MaterialIndex] = true;
+        }
+        return used;
+    }
+
+    std::vector<Graphics::CookedTexture> Graphics::Model::CollectTextures(const ModelData &data) const {
+        const auto used = UsedMaterials(data);
+        auto &cache = TextureCache::Shared();
+
+        std::unordered_set<std::string> queued;
+        std::vector<CookedTexture> pending;
+        for (const auto &texture: data.Textures) {
+            if (texture.MaterialIndex >= data.MaterialCount || !used[texture.MaterialIndex])
+                continue;
+            const auto file = _directory + '/' + texture.Path;
+            if (queued.insert(file + static_cast<char>('0' + static_cast<int>(texture.Kind))).second &&
+                !cache.Find(file, ParamsFor(texture.Kind)))
+                pending.push_back(texture);
+        }
+        return pending;
+    }
+
+    void Graphics::Model::ResolveMaterials(const ModelData &data, Core::LoadMode mode) {
+        const auto used = UsedMaterials(data);
+        std::unordered_set<const CachedTexture *> held;
+        for (const auto &texture: TexturesLoaded)
+            held.insert(texture.get());
+
+        std::vector<std::vector<GLuint>> diffuse(data.MaterialCount);
+        std::vector<std::vector<GLuint>> specular(data.MaterialCount);
+        for (const auto &texture: data.Textures) {
+            if (texture.MaterialIndex >= data.MaterialCount || !used[texture.MaterialIndex])
+                continue;
+            auto handle = TextureCache::Shared().Load(_directory + '/' + texture.Path, ParamsFor(texture.Kind), mode);
+            auto &ids = texture.Kind == TextureKind::Diffuse ? diffuse : specular;
+            ids[texture.MaterialIndex].push_back(handle->Id);
+            if (held.insert(handle.get()).second)
+                TexturesLoaded.push_back(std::move(handle));
+        }
+
+        Materials.clear();
+        Materials.reserve(data.MaterialCount);
+        for (std::uint32_t i = 0; i < data.MaterialCount; i++)
+            Materials.emplace_back(std::move(diffuse[i]), std::move(specular[i]), Shininess);
     }
 
-    void Graphics::Model::ProcessNode(aiNode *node, const aiScene *scene) {
+    void Graphics::Model::AddMesh(const ModelData &data, const CookedMesh &mesh) {
+        Meshes.emplace_back(
+                data.Vertices.subspan(mesh.FirstVertex, mesh.VertexCount),
+                data.Indices.subspan(mesh.FirstIndex, mesh.IndexCount),
+                _format,
+                std::span(mesh.Lods).first(mesh.LodCount),
+                data.Meshlets.subspan(mesh.FirstMeshlet, mesh.MeshletCount)
+        );
+        Meshes.back().MaterialIndex = mesh.MaterialIndex;
+    }
+
+    void Graphics::Model::ProcessNode(aiNode *node, ImportedModel &imported) {
         for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-            Meshes.push_back(ProcessMesh(mesh, scene));
+            imported.Meshes.push_back(imported.SceneMeshes[node->mMeshes[i]]);
         }
         for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            ProcessNode(node->mChildren[i], scene);
+            ProcessNode(node->mChildren[i], imported);
         }
     }
 
-    Graphics::Mesh Graphics::Model::ProcessMesh(aiMesh *mesh, const aiScene *scene) {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<TextureIdentifier> textures;
+    Graphics::CookedMesh Graphics::Model::ProcessMesh(aiMesh *mesh, ImportedModel &imported) {
+        CookedMesh cooked{};
+        cooked.FirstVertex = static_cast<std::uint32_t>(imported.Vertices.size());
+        cooked.VertexCount = mesh->mNumVertices;
+        cooked.FirstIndex = static_cast<std::uint32_t>(imported.Indices.size());
+        cooked.MaterialIndex = mesh->mMaterialIndex;
 
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
             Vertex vertex{};
@@ -85,102 +434,101 @@ namespace Graphics {
             } else
                 vertex.TexCoords = glm::vec2(0.0f, 0.0f);
 
-            vertices.push_back(vertex);
+            imported.Vertices.push_back(vertex);
         }
 
         for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
             aiFace face = mesh->mFaces[i];
             for (unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
+                imported.Indices.push_back(face.mIndices[j]);
         }
 
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-            std::vector<TextureIdentifier> diffuseMaps =
-                    LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-            textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        cooked.IndexCount = static_cast<std::uint32_t>(imported.Indices.size()) - cooked.FirstIndex;
+        OptimizeMesh(cooked, imported);
+        BuildMeshlets(cooked, imported);
+        BuildLods(cooked, imported);
+        return cooked;
+    }
 
-            std::vector<TextureIdentifier> specularMaps =
-                    LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-            textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        }
+    void Graphics::Model::OptimizeMesh(CookedMesh &cooked, ImportedModel &imported) {
+        const auto vertices = std::span(imported.Vertices).subspan(cooked.FirstVertex, cooked.VertexCount);
+        const auto indices = std::span(imported.Indices).subspan(cooked.FirstIndex, cooked.IndexCount);
+        imported.Unoptimized += MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
 
-        return {vertices, indices, textures};
+        const auto clusters = MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+        MeshOptimizer::OptimizeOverdraw(indices, vertices, clusters);
     }
 
-    std::vector<Graphics::TextureIdentifier>
-    Graphics::Model::LoadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string &typeName) {
-        std::vector<TextureIdentifier> textures;
-        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
-            aiString str;
-            mat->GetTexture(type, i, &str);
+    void Graphics::Model::BuildMeshlets(CookedMesh &cooked, ImportedModel &imported) {
+        const auto vertices = std::span(imported.Vertices).subspan(cooked.FirstVertex, cooked.VertexCount);
+        const auto indices = std::span(imported.Indices).subspan(cooked.FirstIndex, cooked.IndexCount);
+        const auto meshlets = MeshletBuilder::Build(vertices, indices);
 
-            bool skip = false;
-            for (auto &j: TexturesLoaded) {
-                if (std::strcmp(j.Path.data(), str.C_Str()) == 0) {
-                    textures.push_back(j);
-                    skip = true;
-                    break;
-                }
-            }
+        // Building rewrites the triangle order, so each meshlet's range is reordered for the cache again, and
+        // vertices are only laid out for fetch once the order is final.
+        for (const auto &meshlet: meshlets)
+            MeshOptimizer::OptimizeVertexCache(indices.subspan(meshlet.FirstIndex, meshlet.IndexCount),
+                                               vertices.size());
+        cooked.VertexCount = static_cast<std::uint32_t>(MeshOptimizer::OptimizeVertexFetch(vertices, indices));
+        imported.Vertices.resize(cooked.FirstVertex + cooked.VertexCount);
+        imported.Optimized += MeshOptimizer::AnalyzeVertexCache(indices, cooked.VertexCount);
 
-            if (!skip) {
-                TextureIdentifier texture;
-                texture.Id = TextureFromFile(str.C_Str(), _directory, type == aiTextureType_DIFFUSE);
-                texture.Type = typeName;
-                texture.Path = str.C_Str();
-                textures.push_back(texture);
-                TexturesLoaded.push_back(texture);
-            }
-        }
-        return textures;
+        cooked.FirstMeshlet = static_cast<std::uint32_t>(imported.Meshlets.size());
+        cooked.MeshletCount = static_cast<std::uint32_t>(meshlets.size());
+        imported.Meshlets.insert(imported.Meshlets.end(), meshlets.begin(), meshlets.end());
     }
 
-    unsigned int Graphics::Model::TextureFromFile(const char *path, const std::string &directory, bool gammaCorrection) {
-        stbi_set_flip_vertically_on_load(true);
-        std::string filename = std::string(path);
-        filename = directory + '/' + filename;
+    void Graphics::Model::BuildLods(CookedMesh &cooked, ImportedModel &imported) {
+        const auto vertices = std::span(imported.Vertices).subspan(cooked.FirstVertex, cooked.VertexCount);
+        const std::vector<std::uint32_t> source(imported.Indices.begin() + cooked.FirstIndex,
+                                                imported.Indices.begin() + cooked.FirstIndex + cooked.IndexCount);
+        cooked.Lods[0] = {0, cooked.IndexCount, 0.0f};
+        cooked.LodCount = 1;
 
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (const auto &vertex: vertices) {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+        const float maxError = glm::length(boundsMax - boundsMin) * 0.5f * MaxLodError;
 
-        int width, height, nrComponents;
-        unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
+        // Every level is simplified from the full mesh so its error is measured against the real surface.
+        while (cooked.LodCount < MaxMeshLods) {
+            const auto &previous = cooked.Lods[cooked.LodCount - 1];
+            const auto target = previous.IndexCount / 6 * 3;
+            if (target < MinLodTriangles * 3)
+                break;
 
-        if (data) {
-            GLenum internalFormat;
-            GLenum dataFormat;
-            if (nrComponents == 1)
-            {
-                internalFormat = dataFormat = GL_RED;
-            }
-            else if (nrComponents == 3)
-            {
-                internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-                dataFormat = GL_RGB;
-            }
-            else if (nrComponents == 4)
-            {
-                internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-                dataFormat = GL_RGBA;
-            }
+            float error = 0.0f;
+            auto lod = MeshSimplifier::Simplify(vertices, source, target, maxError, error);
+            if (lod.size() > previous.IndexCount * 3 / 4)
+                break;
+            MeshOptimizer::OptimizeVertexCache(lod, vertices.size());
 
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
+            cooked.Lods[cooked.LodCount++] = {cooked.IndexCount, static_cast<std::uint32_t>(lod.size()),
+                                              std::max(error, previous.Error)};
+            imported.Indices.insert(imported.Indices.end(), lod.begin(), lod.end());
+            cooked.IndexCount += static_cast<std::uint32_t>(lod.size());
+        }
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        for (std::uint32_t i = 0; i < cooked.LodCount; i++)
+            imported.LodTriangles[i] += cooked.Lods[i].IndexCount / 3;
+    }
 
-            stbi_image_free(data);
-        } else {
-            Log::Error("TEXTURE: Texture failed to load at path {} ", path);
-            stbi_image_free(data);
+    void Graphics::Model::LoadMaterialTextures(aiMaterial *mat, aiTextureType type, TextureKind kind,
+                                               std::uint32_t materialIndex, ImportedModel &imported) {
+        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
+            aiString str;
+            mat->GetTexture(type, i, &str);
+            imported.Textures.push_back({materialIndex, kind, str.C_Str()});
         }
+    }
 
-        return textureID;
+    Graphics::TextureParams Graphics::Model::ParamsFor(TextureKind kind) {
+        TextureParams params;
+        params.GammaCorrection = kind == TextureKind::Diffuse;
+        return params;
     }
 
 }
\ No newline at end of file
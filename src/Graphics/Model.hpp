@@ -1,6 +1,20 @@
 #pragma once
 
+#include "GpuCuller.hpp"
+#include "IndirectDrawList.hpp"
+#include "Material.hpp"
+#include "MaterialTable.hpp"
 #include "Mesh.hpp"
+#include "ModelCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "MeshletBuilder.hpp"
+#include "RenderView.hpp"
+#include "TextureCache.hpp"
+#include "Core/BoundsCulling.hpp"
+#include "Core/Task.hpp"
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <assimp/Importer.hpp>
@@ -10,10 +24,14 @@
 namespace Graphics {
     class Model {
     public:
-        std::vector<TextureIdentifier> TexturesLoaded;
+        std::vector<TextureCache::Handle> TexturesLoaded;
         std::vector<Mesh> Meshes;
+        // Indexed by Mesh::MaterialIndex.
+        std::vector<Material> Materials;
+        // Specular exponent of every material; set before the materials are resolved.
+        float Shininess = 32.0f;
 
-        explicit Model(const char *path) {
+        explicit Model(const char *path, VertexFormat format = VertexFormat::Packed) : _format(format) {
             LoadModel(path);
 
 //            for (auto &tex: TexturesLoaded) {
@@ -23,21 +41,134 @@ namespace Graphics {
 //            }
         }
 
+        // Returns immediately; meshes appear as they are uploaded and sample placeholder texels until resident.
+        static std::shared_ptr<Model> LoadAsync(const std::string &path,
+                                                VertexFormat format = VertexFormat::Packed);
+
+        [[nodiscard]] bool IsResident() const;
+
+        [[nodiscard]] const Core::Task<void> &Loaded() const;
+
         void Draw(Graphics::Shader &shader);
 
+        // Draws every mesh inside the view frustum at the coarsest level the view allows, culling meshlets at level 0. Where indirect draws
+        // are available every material is one glMultiDrawElementsIndirect and the shader reads model per draw, or
+        // every index type is one when the shader was compiled for MaterialTextures(); otherwise model must match
+        // the uniform the shader uses. Where GpuCuller is supported the meshes and meshlets are culled in a compute
+        // pass instead, against the view's depth pyramid, and its counts reach CullCounters a frame or two late;
+        // otherwise meshes behind the view's occluders are dropped too.
+        void Draw(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model);
+
+        // As above for callers that culled the meshes themselves, such as through a scene Core::Bvh; visible holds
+        // one flag per mesh and meshes past its end are skipped.
+        void Draw(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model,
+                  std::span<const std::uint8_t> visible);
+
+        // How shaders should sample this model's materials for Draw to batch across them. Bound until the model is
+        // resident, and wherever indirect draws or a material table are unavailable.
+        [[nodiscard]] MaterialTextureMode MaterialTextures();
+
+        // Meshes every Draw with a view kept and skipped since the last reset, summed over all models and passes.
+        static Core::CullStats CullCounters();
+
+        static void ResetCullCounters();
+
+        [[nodiscard]] glm::vec3 BoundsCenter() const;
+
+        [[nodiscard]] float BoundsRadius() const;
+
     private:
+        static constexpr unsigned int ImportFlags =
+                aiProcess_GenNormals |
+                aiProcess_Triangulate |
+                aiProcess_JoinIdenticalVertices |
+                aiProcess_OptimizeMeshes |
+                aiProcess_FindInvalidData;
+
+        // Levels stop halving below this many triangles, or once error reaches this fraction of the mesh radius.
+        static constexpr std::size_t MinLodTriangles = 64;
+        static constexpr float MaxLodError = 0.25f;
+
+        struct ImportedModel {
+            std::vector<Vertex> Vertices;
+            std::vector<std::uint32_t> Indices;
+            std::vector<CookedMesh> Meshes;
+            std::vector<Meshlet> Meshlets;
+            std::vector<CookedTexture> Textures;
+            std::vector<CookedMesh> SceneMeshes;
+            std::uint32_t MaterialCount{};
+            VertexCacheStats Unoptimized;
+            VertexCacheStats Optimized;
+            std::array<std::size_t, MaxMeshLods> LodTriangles{};
+        };
+
+        struct ModelSource {
+            std::unique_ptr<ModelCache> Cache;
+            ImportedModel Imported;
+            ModelData Data;
+        };
+
         std::string _directory;
+        VertexFormat _format = VertexFormat::Packed;
+        Core::Task<void> _loading;
+        std::unique_ptr<IndirectDrawList> _drawList;
+        std::unique_ptr<GpuCuller> _gpuCuller;
+        std::unique_ptr<MaterialTable> _materialTable;
+        bool _materialTableBuilt = false;
+        std::vector<DrawRecord> _records;
+        glm::mat4 _recordedModel{};
+        std::vector<MeshRange> _ranges;
+        Core::BoundsSet _bounds;
+        std::vector<std::uint8_t> _visible;
+        static inline Core::CullStats _cullCounters;
+
+        Model() = default;
 
         void LoadModel(const std::string &path);
 
-        void ProcessNode(aiNode *node, const aiScene *scene);
+        void UpdateRecords(const glm::mat4 &model);
+
+        // Fills _visible for the meshes, tested in object space against the view frustum transformed by model.
+        void CullMeshes(const Core::Frustum &frustum);
 
-        Mesh ProcessMesh(aiMesh *mesh, const aiScene *scene);
+        // Clears the meshes of _visible hidden behind occluders once placed by model.
+        void CullOccluded(const Core::OcclusionBuffer &occluders, const glm::mat4 &model);
 
-        std::vector<TextureIdentifier>
-        LoadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string &typeName);
+        void DrawVisible(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model);
 
-        static unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma);
+        void DrawCulledOnGpu(Graphics::Shader &shader, const RenderView &view, const glm::mat4 &model);
+
+        static Core::Task<void> StreamModel(std::shared_ptr<Model> model, std::string path);
+
+        static bool ReadModel(const std::string &path, ModelSource &source);
+
+        static bool ImportModel(const std::string &path, ImportedModel &imported);
+
+        static std::vector<bool> UsedMaterials(const ModelData &data);
+
+        [[nodiscard]] std::vector<CookedTexture> CollectTextures(const ModelData &data) const;
+
+        void ResolveMaterials(const ModelData &data, Core::LoadMode mode);
+
+        void AddMesh(const ModelData &data, const CookedMesh &mesh);
+
+        void BindMaterial(Shader &shader, std::uint32_t index) const;
+
+        static void ProcessNode(aiNode *node, ImportedModel &imported);
+
+        static CookedMesh ProcessMesh(aiMesh *mesh, ImportedModel &imported);
+
+        // Orders triangles for the vertex cache, then outward-facing clusters first.
+        static void OptimizeMesh(CookedMesh &cooked, ImportedModel &imported);
+
+        // Splits the mesh into meshlets and finishes its optimization on their final order.
+        static void BuildMeshlets(CookedMesh &cooked, ImportedModel &imported);
+
+        static void BuildLods(CookedMesh &cooked, ImportedModel &imported);
+
+        static void LoadMaterialTextures(aiMaterial *mat, aiTextureType type, TextureKind kind,
+                                         std::uint32_t materialIndex, ImportedModel &imported);
+
+        static TextureParams ParamsFor(TextureKind kind);
     };
 }
-
@@ -0,0 +1,246 @@
+#include "ModelCache.hpp"
+#include "Core/Hash.hpp"
+#include "Log.hpp"
+#include <assimp/version.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::uint32_t Magic = 0x484d4343; // "CCMH"
+        constexpr std::size_t Alignment = 16;
+
+        struct Header {
+            std::uint32_t Magic;
+            std::uint32_t Version;
+            std::uint64_t SourceHash;
+            std::uint32_t ImportFlags;
+            std::uint32_t VertexSize;
+            std::uint32_t MeshCount;
+            std::uint32_t MaterialCount;
+            std::uint32_t TextureCount;
+            std::uint32_t StringsSize;
+            std::uint32_t MeshletCount;
+            std::uint32_t Reserved;
+            std::uint64_t VertexCount;
+            std::uint64_t IndexCount;
+            std::uint64_t MeshesOffset;
+            std::uint64_t MeshletsOffset;
+            std::uint64_t TexturesOffset;
+            std::uint64_t StringsOffset;
+            std::uint64_t VerticesOffset;
+            std::uint64_t IndicesOffset;
+        };
+
+        struct TextureRecord {
+            std::uint32_t MaterialIndex;
+            std::uint32_t Kind;
+            std::uint32_t PathOffset;
+            std::uint32_t PathLength;
+        };
+
+        static_assert(std::is_trivially_copyable_v<Vertex> && sizeof(Vertex) == 32);
+        static_assert(std::is_trivially_copyable_v<CookedMesh>);
+        static_assert(std::is_trivially_copyable_v<Meshlet>);
+
+        constexpr std::uint64_t Align(std::uint64_t offset) {
+            return (offset + Alignment - 1) & ~static_cast<std::uint64_t>(Alignment - 1);
+        }
+
+        template<typename T>
+        std::span<const T> ViewAt(std::span<const std::byte> bytes, std::uint64_t offset, std::uint64_t count) {
+            if (offset % alignof(T) != 0 || offset > bytes.size() || count > (bytes.size() - offset) / sizeof(T))
+                return {};
+            return {reinterpret_cast<const T *>(bytes.data() + offset), static_cast<std::size_t>(count)};
+        }
+    }
+
+    std::string ModelCache::PathFor(const std::string &sourcePath) {
+        return FileSystem::CachePath(sourcePath + ".cmesh");
+    }
+
+    std::uint64_t ModelCache::HashSource(const std::string &sourcePath) {
+        const auto source = FileSystem::Shared().Find(sourcePath);
+        auto hash = Core::Hash::Fnv1a(source.Data());
+        hash = Core::Hash::Combine(hash, aiGetVersionMajor());
+        hash = Core::Hash::Combine(hash, aiGetVersionMinor());
+        hash = Core::Hash::Combine(hash, aiGetVersionRevision());
+        for (const auto &library: MaterialLibraries(sourcePath, source.Data())) {
+            hash = Core::Hash::Fnv1a(library, hash);
+            hash = Core::Hash::Combine(hash, Core::Hash::Fnv1a(FileSystem::Shared().Find(library).Data()));
+        }
+        return hash;
+    }
+
+    // Material names, texture paths and parameters come from the .mtl files an .obj names, and are baked into the
+    // cache with the meshes; a name runs to the end of its line, as Assimp reads it.
+    std::vector<std::string> ModelCache::MaterialLibraries(const std::string &sourcePath,
+                                                           std::span<const std::byte> source) {
+        std::vector<std::string> libraries;
+        if (!sourcePath.ends_with(".obj"))
+            return libraries;
+
+        const auto slash = sourcePath.find_last_of('/');
+        const auto directory = slash == std::string::npos ? std::string() : sourcePath.substr(0, slash + 1);
+        const std::string_view text(reinterpret_cast<const char *>(source.data()), source.size());
+        constexpr std::string_view Whitespace = " \t\r";
+        for (std::size_t start = 0; start < text.size();) {
+            auto end = text.find('\n', start);
+            if (end == std::string_view::npos)
+                end = text.size();
+            auto line = text.substr(start, end - start);
+            start = end + 1;
+
+            line.remove_prefix(std::min(line.size(), line.find_first_not_of(Whitespace)));
+            if (!line.starts_with("mtllib") || line.size() < 7 || Whitespace.find(line[6]) == std::string_view::npos)
+                continue;
+            line.remove_prefix(6);
+            line.remove_prefix(std::min(line.size(), line.find_first_not_of(Whitespace)));
+            line = line.substr(0, line.find_last_not_of(Whitespace) + 1);
+            if (!line.empty())
+                libraries.push_back(directory + std::string(line));
+        }
+        return libraries;
+    }
+
+    ModelCache::ModelCache(const std::string &cachePath) : _file(FileSystem::Shared().Find(cachePath)) {
+    }
+
+    std::unique_ptr<ModelCache> ModelCache::Open(const std::string &sourcePath, std::uint64_t sourceHash,
+                                                 unsigned int importFlags) {
+        std::unique_ptr<ModelCache> cache(new ModelCache(PathFor(sourcePath)));
+        if (!cache->_file.IsOpen())
+            return nullptr;
+
+        if (!cache->Parse(sourceHash, importFlags)) {
+            Log::Information(fmt::format("MODEL_CACHE::STALE {}", sourcePath));
+            return nullptr;
+        }
+        return cache;
+    }
+
+    bool ModelCache::Parse(std::uint64_t sourceHash, unsigned int importFlags) {
+        const auto bytes = _file.Data();
+        if (bytes.size() < sizeof(Header))
+            return false;
+
+        Header header{};
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.Magic != Magic || header.Version != Version || header.VertexSize != sizeof(Vertex) ||
+            header.SourceHash != sourceHash || header.ImportFlags != importFlags)
+            return false;
+
+        _data.Vertices = ViewAt<Vertex>(bytes, header.VerticesOffset, header.VertexCount);
+        _data.Indices = ViewAt<std::uint32_t>(bytes, header.IndicesOffset, header.IndexCount);
+        _data.Meshes = ViewAt<CookedMesh>(bytes, header.MeshesOffset, header.MeshCount);
+        _data.Meshlets = ViewAt<Meshlet>(bytes, header.MeshletsOffset, header.MeshletCount);
+        const auto textures = ViewAt<TextureRecord>(bytes, header.TexturesOffset, header.TextureCount);
+        const auto strings = ViewAt<char>(bytes, header.StringsOffset, header.StringsSize);
+        _data.MaterialCount = header.MaterialCount;
+
+        if (_data.Vertices.size() != header.VertexCount || _data.Indices.size() != header.IndexCount ||
+            _data.Meshes.size() != header.MeshCount || _data.Meshlets.size() != header.MeshletCount ||
+            textures.size() != header.TextureCount ||
+            strings.size() != header.StringsSize)
+            return false;
+
+        for (const auto &mesh: _data.Meshes) {
+            if (static_cast<std::uint64_t>(mesh.FirstVertex) + mesh.VertexCount > header.VertexCount ||
+                static_cast<std::uint64_t>(mesh.FirstIndex) + mesh.IndexCount > header.IndexCount ||
+                mesh.LodCount == 0 || mesh.LodCount > MaxMeshLods ||
+                static_cast<std::uint64_t>(mesh.FirstMeshlet) + mesh.MeshletCount > header.MeshletCount)
+                return false;
+            for (const auto &meshlet: _data.Meshlets.subspan(mesh.FirstMeshlet, mesh.MeshletCount)) {
+                if (static_cast<std::uint64_t>(meshlet.FirstIndex) + meshlet.IndexCount > mesh.Lods[0].IndexCount)
+                    return false;
+            }
+            for (std::uint32_t i = 0; i < mesh.LodCount; i++) {
+                if (static_cast<std::uint64_t>(mesh.Lods[i].FirstIndex) + mesh.Lods[i].IndexCount > mesh.IndexCount)
+                    return false;
+            }
+        }
+
+        _data.Textures.reserve(textures.size());
+        for (const auto &record: textures) {
+            if (static_cast<std::uint64_t>(record.PathOffset) + record.PathLength > strings.size())
+                return false;
+            _data.Textures.push_back({
+                    record.MaterialIndex,
+                    static_cast<TextureKind>(record.Kind),
+                    std::string(strings.data() + record.PathOffset, record.PathLength)
+            });
+        }
+        return true;
+    }
+
+    bool ModelCache::Write(const std::string &sourcePath, std::uint64_t sourceHash, unsigned int importFlags,
+                           const ModelData &data) {
+        std::vector<TextureRecord> textures;
+        std::string strings;
+        textures.reserve(data.Textures.size());
+        for (const auto &texture: data.Textures) {
+            textures.push_back({
+                    texture.MaterialIndex,
+                    static_cast<std::uint32_t>(texture.Kind),
+                    static_cast<std::uint32_t>(strings.size()),
+                    static_cast<std::uint32_t>(texture.Path.size())
+            });
+            strings += texture.Path;
+        }
+
+        Header header{};
+        header.Magic = Magic;
+        header.Version = Version;
+        header.SourceHash = sourceHash;
+        header.ImportFlags = importFlags;
+        header.VertexSize = sizeof(Vertex);
+        header.MeshCount = static_cast<std::uint32_t>(data.Meshes.size());
+        header.MaterialCount = data.MaterialCount;
+        header.TextureCount = static_cast<std::uint32_t>(textures.size());
+        header.StringsSize = static_cast<std::uint32_t>(strings.size());
+        header.MeshletCount = static_cast<std::uint32_t>(data.Meshlets.size());
+        header.VertexCount = data.Vertices.size();
+        header.IndexCount = data.Indices.size();
+        header.MeshesOffset = Align(sizeof(Header));
+        header.MeshletsOffset = Align(header.MeshesOffset + data.Meshes.size_bytes());
+        header.TexturesOffset = Align(header.MeshletsOffset + data.Meshlets.size_bytes());
+        header.StringsOffset = Align(header.TexturesOffset + textures.size() * sizeof(TextureRecord));
+        header.VerticesOffset = Align(header.StringsOffset + strings.size());
+        header.IndicesOffset = Align(header.VerticesOffset + data.Vertices.size_bytes());
+
+        const auto cachePath = PathFor(sourcePath);
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+        std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            Log::Error("MODEL_CACHE::WRITE_FAILED {}", cachePath);
+            return false;
+        }
+
+        const auto writeAt = [&file](std::uint64_t offset, const void *source, std::size_t size) {
+            static constexpr char padding[Alignment]{};
+            const auto position = static_cast<std::uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(offset - position));
+            file.write(static_cast<const char *>(source), static_cast<std::streamsize>(size));
+        };
+
+        writeAt(0, &header, sizeof(Header));
+        writeAt(header.MeshesOffset, data.Meshes.data(), data.Meshes.size_bytes());
+        writeAt(header.MeshletsOffset, data.Meshlets.data(), data.Meshlets.size_bytes());
+        writeAt(header.TexturesOffset, textures.data(), textures.size() * sizeof(TextureRecord));
+        writeAt(header.StringsOffset, strings.data(), strings.size());
+        writeAt(header.VerticesOffset, data.Vertices.data(), data.Vertices.size_bytes());
+        writeAt(header.IndicesOffset, data.Indices.data(), data.Indices.size_bytes());
+
+        return file.good();
+    }
+
+    const ModelData &ModelCache::Data() const {
+        return _data;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "FileSystem.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Graphics {
+    enum class TextureKind : std::uint32_t {
+        Diffuse,
+        Specular
+    };
+
+    struct CookedMesh {
+        std::uint32_t FirstVertex;
+        std::uint32_t VertexCount;
+        std::uint32_t FirstIndex;
+        std::uint32_t IndexCount;
+        std::uint32_t MaterialIndex;
+        std::uint32_t LodCount;
+        std::array<MeshLod, MaxMeshLods> Lods;
+        std::uint32_t FirstMeshlet;
+        std::uint32_t MeshletCount;
+    };
+
+    struct CookedTexture {
+        std::uint32_t MaterialIndex;
+        TextureKind Kind;
+        std::string Path;
+    };
+
+    // Non-owning view over processed model data, either freshly imported or mapped from a cache file.
+    struct ModelData {
+        std::span<const Vertex> Vertices;
+        std::span<const std::uint32_t> Indices;
+        std::span<const CookedMesh> Meshes;
+        std::span<const Meshlet> Meshlets;
+        std::vector<CookedTexture> Textures;
+        std::uint32_t MaterialCount{};
+    };
+
+    class ModelCache {
+    public:
+        static constexpr std::uint32_t Version = 5;
+
+        static std::string PathFor(const std::string &sourcePath);
+
+        // Covers the source file, the material libraries an .obj references and the Assimp version.
+        static std::uint64_t HashSource(const std::string &sourcePath);
+
+        static std::unique_ptr<ModelCache> Open(const std::string &sourcePath, std::uint64_t sourceHash,
+                                                unsigned int importFlags);
+
+        static bool Write(const std::string &sourcePath, std::uint64_t sourceHash, unsigned int importFlags,
+                          const ModelData &data);
+
+        [[nodiscard]] const ModelData &Data() const;
+
+    private:
+        FileView _file;
+        ModelData _data;
+
+        explicit ModelCache(const std::string &cachePath);
+
+        bool Parse(std::uint64_t sourceHash, unsigned int importFlags);
+
+        static std::vector<std::string> MaterialLibraries(const std::string &sourcePath,
+                                                          std::span<const std::byte> source);
+    };
+}
@@ -0,0 +1,96 @@
+#include "ProgramCache.hpp"
+#include "Core/Hash.hpp"
+#include "FileSystem.hpp"
+#include "GLExtensions.hpp"
+#include "Log.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Graphics {
+
+    namespace {
+        constexpr std::uint32_t Magic = 0x47504343; // "CCPG"
+
+        struct Header {
+            std::uint32_t Magic;
+            std::uint32_t Version;
+            std::uint64_t Key;
+            std::uint32_t Format;
+            std::uint32_t Length;
+        };
+    }
+
+    std::uint64_t ProgramCache::Key(std::span<const std::string_view> sources, std::string_view defines) {
+        auto key = Core::Hash::Fnv1a(GLExtensions::Driver);
+        for (const auto source: sources)
+            key = Core::Hash::Combine(key, Core::Hash::Fnv1a(source));
+        return Core::Hash::Combine(key, Core::Hash::Fnv1a(defines));
+    }
+
+    std::string ProgramCache::PathFor(std::uint64_t key) {
+        return FileSystem::CachePath(fmt::format("shaders/{:016x}.cprog", key));
+    }
+
+    bool ProgramCache::IsSupported() {
+        return GLExtensions::ProgramBinary != nullptr;
+    }
+
+    bool ProgramCache::Load(GLuint program, std::uint64_t key) {
+        if (!IsSupported())
+            return false;
+        const auto file = FileSystem::Shared().Find(PathFor(key));
+        const auto bytes = file.Data();
+        if (bytes.size() < sizeof(Header))
+            return false;
+
+        Header header{};
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.Magic != Magic || header.Version != Version || header.Key != key ||
+            header.Length != bytes.size() - sizeof(Header))
+            return false;
+
+        GLExtensions::ProgramBinary(program, header.Format, bytes.data() + sizeof(Header),
+                                    static_cast<GLsizei>(header.Length));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+            Log::Information(fmt::format("PROGRAM_CACHE::REJECTED {:016x}", key));
+        return linked == GL_TRUE;
+    }
+
+    void ProgramCache::PrepareForStore(GLuint program) {
+        if (IsSupported())
+            GLExtensions::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    bool ProgramCache::Store(GLuint program, std::uint64_t key) {
+        if (!IsSupported())
+            return false;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return false;
+
+        std::vector<std::byte> binary(static_cast<std::size_t>(length));
+        GLenum format = 0;
+        GLsizei written = 0;
+        GLExtensions::GetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return false;
+
+        const Header header{Magic, Version, key, format, static_cast<std::uint32_t>(written)};
+        const auto path = PathFor(key);
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char *>(binary.data()), written);
+        if (!file.good()) {
+            Log::Error("PROGRAM_CACHE::WRITE_FAILED {}", path);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Graphics {
+    // Linked program binaries from glGetProgramBinary, one file per key. Drivers may reject a binary at any time
+    // (an update, a different GPU), so callers always keep the source path to fall back to.
+    class ProgramCache {
+    public:
+        static constexpr std::uint32_t Version = 1;
+
+        // Covers the stage sources, the defines they were compiled with and the driver identity.
+        static std::uint64_t Key(std::span<const std::string_view> sources, std::string_view defines);
+
+        static std::string PathFor(std::uint64_t key);
+
+        // Loads the cached binary into program; false when there is none or the driver rejects it.
+        static bool Load(GLuint program, std::uint64_t key);
+
+        // Call before linking so the driver keeps the binary retrievable.
+        static void PrepareForStore(GLuint program);
+
+        static bool Store(GLuint program, std::uint64_t key);
+
+        [[nodiscard]] static bool IsSupported();
+    };
+}
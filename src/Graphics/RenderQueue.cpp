@@ -0,0 +1,114 @@
+#include "RenderQueue.hpp"
+#include "RenderState.hpp"
+#include "Core/RadixSort.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace Graphics {
+    namespace {
+        // Dense ids keep the key fields narrow; past the field width ids wrap, which only costs sort quality.
+        template<typename Map, typename Value>
+        std::uint32_t Intern(Map &ids, const Value &value, int bits) {
+            const auto id = ids.try_emplace(value, static_cast<std::uint32_t>(ids.size())).first->second;
+            return id & ((1u << bits) - 1);
+        }
+    }
+
+    void RenderQueue::Reset(glm::vec3 eye) {
+        _eye = eye;
+        _packets.clear();
+        _entries.clear();
+        _programIds.clear();
+        _materialIds.clear();
+        _geometryIds.clear();
+        _sorted = true;
+        _stats = {};
+    }
+
+    void RenderQueue::Submit(const DrawPacket &packet) {
+        const auto program = Intern(_programIds, static_cast<const void *>(packet.Program), ProgramBits);
+        const auto material = Intern(_materialIds, static_cast<const void *>(packet.Material), MaterialBits);
+        const auto geometry = Intern(_geometryIds, GeometryOf(packet), GeometryBits);
+        const auto depth = glm::distance(_eye, glm::vec3(packet.Transform[3]));
+
+        _entries.push_back({Key(packet.Pass, program, material, geometry, depth),
+                            static_cast<std::uint32_t>(_packets.size())});
+        _packets.push_back(packet);
+        _sorted = false;
+    }
+
+    void RenderQueue::Execute(RenderPass pass) {
+        if (!_sorted) {
+            Core::RadixSort(_entries, _scratch, [](const SortEntry &entry) { return entry.Key; });
+            _sorted = true;
+        }
+
+        const auto passOf = [](const SortEntry &entry) {
+            return static_cast<RenderPass>(entry.Key >> (64 - PassBits));
+        };
+        const auto first = std::ranges::partition_point(_entries, [&](const auto &entry) {
+            return passOf(entry) < pass;
+        });
+
+        auto &state = RenderState::Shared();
+        const Shader *program = nullptr;
+        const Material *material = nullptr;
+        GLuint geometry = ~0u;
+        for (auto it = first; it != _entries.end() && passOf(*it) == pass; ++it) {
+            const auto &packet = _packets[it->Packet];
+            auto &shader = *packet.Program;
+            if (&shader != program) {
+                shader.Use();
+                program = &shader;
+                material = nullptr;
+                _stats.ProgramChanges++;
+            }
+            if (packet.Material && packet.Material != material) {
+                packet.Material->Bind(shader);
+                material = packet.Material;
+                _stats.MaterialChanges++;
+            }
+            if (const auto packetGeometry = GeometryOf(packet); packetGeometry != geometry) {
+                geometry = packetGeometry;
+                _stats.GeometryChanges++;
+            }
+
+            shader.SetMat4("model", packet.Transform);
+            if (packet.Mesh) {
+                packet.Mesh->Draw(packet.Lod);
+            } else {
+                state.BindVertexArray(packet.VertexArray);
+                glDrawArrays(packet.Mode, packet.First, packet.Count);
+            }
+            _stats.Draws++;
+        }
+    }
+
+    const RenderQueueStats &RenderQueue::Stats() const {
+        return _stats;
+    }
+
+    std::size_t RenderQueue::Size() const {
+        return _packets.size();
+    }
+
+    std::uint64_t RenderQueue::Key(RenderPass pass, std::uint32_t program, std::uint32_t material,
+                                   std::uint32_t geometry, float depth) {
+        // Non-negative floats order like their bit patterns, so the top bits are a depth with floating precision.
+        const std::uint64_t depthBits = std::bit_cast<std::uint32_t>(std::max(depth, 0.0f)) >> (32 - DepthBits);
+        const std::uint64_t state = (static_cast<std::uint64_t>(program) << (MaterialBits + GeometryBits)) |
+                                    (static_cast<std::uint64_t>(material) << GeometryBits) | geometry;
+        std::uint64_t key = static_cast<std::uint64_t>(pass) << (64 - PassBits);
+        if (pass == RenderPass::Transparent) {
+            const auto farFirst = (1ull << DepthBits) - 1 - depthBits;
+            key |= farFirst << (ProgramBits + MaterialBits + GeometryBits) | state;
+        } else {
+            key |= state << DepthBits | depthBits;
+        }
+        return key;
+    }
+
+    GLuint RenderQueue::GeometryOf(const DrawPacket &packet) {
+        return packet.Mesh ? packet.Mesh->VAO : packet.VertexArray;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Material.hpp"
+#include "Mesh.hpp"
+#include "Shader.hpp"
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics {
+    // Passes execute in this order and own the top bits of the sort key.
+    enum class RenderPass : std::uint8_t {
+        Shadow,
+        Opaque,
+        Transparent
+    };
+
+    // One draw: either a level of a mesh or a non-indexed range of a vertex array.
+    struct DrawPacket {
+        RenderPass Pass = RenderPass::Opaque;
+        Shader *Program{};
+
+        // Bound whenever it differs from the previous draw's; none leaves the material state as it is.
+        const Graphics::Material *Material{};
+
+        Graphics::Mesh *Mesh{};
+        std::size_t Lod{};
+
+        GLuint VertexArray{};
+        GLenum Mode = GL_TRIANGLES;
+        GLint First{};
+        GLsizei Count{};
+
+        glm::mat4 Transform{1.0f};
+    };
+
+    struct RenderQueueStats {
+        std::size_t Draws{};
+        std::size_t ProgramChanges{};
+        std::size_t MaterialChanges{};
+        std::size_t GeometryChanges{};
+    };
+
+    // Collects a frame's draws and submits them ordered by a 64-bit key: pass first, then for opaque and shadow
+    // draws program, material, geometry and depth front to back, and for transparent draws depth back to front
+    // ahead of state. Packets are kept by value; what they point to must outlive Execute. GL thread only.
+    class RenderQueue {
+    public:
+        // Forgets the previous frame's packets; depth is measured from eye to each packet's translation.
+        void Reset(glm::vec3 eye);
+
+        void Submit(const DrawPacket &packet);
+
+        // Sorts once after the last Submit, then draws the packets of one pass. The caller sets up the target,
+        // viewport and fixed state of the pass and the per-pass uniforms of its programs beforehand.
+        void Execute(RenderPass pass);
+
+        [[nodiscard]] const RenderQueueStats &Stats() const;
+
+        [[nodiscard]] std::size_t Size() const;
+
+        static std::uint64_t Key(RenderPass pass, std::uint32_t program, std::uint32_t material,
+                                 std::uint32_t geometry, float depth);
+
+    private:
+        static constexpr int PassBits = 2;
+        static constexpr int ProgramBits = 12;
+        static constexpr int MaterialBits = 16;
+        static constexpr int GeometryBits = 10;
+        static constexpr int DepthBits = 24;
+
+        struct SortEntry {
+            std::uint64_t Key;
+            std::uint32_t Packet;
+        };
+
+        glm::vec3 _eye{};
+        std::vector<DrawPacket> _packets;
+        std::vector<SortEntry> _entries;
+        std::vector<SortEntry> _scratch;
+        bool _sorted = true;
+        std::unordered_map<const void *, std::uint32_t> _programIds;
+        std::unordered_map<const void *, std::uint32_t> _materialIds;
+        std::unordered_map<GLuint, std::uint32_t> _geometryIds;
+        RenderQueueStats _stats;
+
+        static GLuint GeometryOf(const DrawPacket &packet);
+    };
+}
@@ -0,0 +1,276 @@
+#include "RenderState.hpp"
+#include "GLExtensions.hpp"
+
+namespace Graphics {
+
+    RenderState &RenderState::Shared() {
+        static RenderState state;
+        return state;
+    }
+
+    RenderState::RenderState() {
+        Invalidate();
+    }
+
+    bool RenderState::Change(GLuint &slot, GLuint value) {
+        if (slot == value) {
+            _counters.Elided++;
+            return false;
+        }
+        slot = value;
+        _counters.Issued++;
+        return true;
+    }
+
+    void RenderState::UseProgram(GLuint program) {
+        if (Change(_program, program))
+            glUseProgram(program);
+    }
+
+    void RenderState::BindVertexArray(GLuint vertexArray) {
+        if (Change(_vertexArray, vertexArray))
+            glBindVertexArray(vertexArray);
+    }
+
+    void RenderState::BindBuffer(GLenum target, GLuint buffer) {
+        const auto index = BufferIndex(target);
+        if (index < 0) {
+            _counters.Issued++;
+            glBindBuffer(target, buffer);
+        } else if (Change(_buffers[index], buffer)) {
+            glBindBuffer(target, buffer);
+        }
+    }
+
+    void RenderState::BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        if (const auto slot = BufferIndex(target); slot >= 0)
+            _buffers[slot] = buffer;
+        _counters.Issued++;
+        glBindBufferBase(target, index, buffer);
+    }
+
+    void RenderState::BindFramebuffer(GLenum target, GLuint framebuffer) {
+        if (target == GL_FRAMEBUFFER) {
+            if (_drawFramebuffer == framebuffer && _readFramebuffer == framebuffer) {
+                _counters.Elided++;
+                return;
+            }
+            _drawFramebuffer = _readFramebuffer = framebuffer;
+            _counters.Issued++;
+            glBindFramebuffer(target, framebuffer);
+        } else if (Change(target == GL_READ_FRAMEBUFFER ? _readFramebuffer : _drawFramebuffer, framebuffer)) {
+            glBindFramebuffer(target, framebuffer);
+        }
+    }
+
+    void RenderState::ActiveTexture(GLenum unit) {
+        if (Change(_activeUnit, unit - GL_TEXTURE0))
+            glActiveTexture(unit);
+    }
+
+    void RenderState::BindTexture(GLenum target, GLuint texture) {
+        const auto index = TextureIndex(target);
+        if (index < 0 || _activeUnit >= MaxTextureUnits) {
+            _counters.Issued++;
+            glBindTexture(target, texture);
+        } else if (Change(_textures[_activeUnit][index], texture)) {
+            glBindTexture(target, texture);
+        }
+    }
+
+    void RenderState::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+        // Skip the unit switch too when the texture is already there.
+        const auto index = TextureIndex(target);
+        if (index >= 0 && unit < MaxTextureUnits && _textures[unit][index] == texture) {
+            _counters.Elided++;
+            return;
+        }
+        ActiveTexture(GL_TEXTURE0 + unit);
+        BindTexture(target, texture);
+    }
+
+    void RenderState::BindTextures(GLuint first, std::span<const GLuint> textures) {
+        if (textures.empty())
+            return;
+        if (first + textures.size() > MaxTextureUnits || !GLExtensions::BindTextures) {
+            for (std::size_t i = 0; i < textures.size(); i++)
+                BindTexture(first + static_cast<GLuint>(i), GL_TEXTURE_2D, textures[i]);
+            return;
+        }
+
+        bool bound = true;
+        for (std::size_t i = 0; i < textures.size(); i++)
+            bound &= _textures[first + i][Texture2D] == textures[i];
+        if (bound) {
+            _counters.Elided++;
+            return;
+        }
+
+        // Zero unbinds every target of its unit; other names bind to the target they were created with.
+        for (std::size_t i = 0; i < textures.size(); i++) {
+            auto &unit = _textures[first + i];
+            if (textures[i] == 0)
+                unit.fill(0);
+            else
+                unit[Texture2D] = textures[i];
+        }
+        _counters.Issued++;
+        GLExtensions::BindTextures(first, static_cast<GLsizei>(textures.size()), textures.data());
+    }
+
+    void RenderState::SetEnabled(GLenum capability, bool enabled) {
+        const auto index = CapabilityIndex(capability);
+        if (index >= 0 && !Change(_capabilities[index], enabled))
+            return;
+        if (index < 0)
+            _counters.Issued++;
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+
+    void RenderState::BlendFunc(GLenum source, GLenum destination) {
+        if (_blendSource == source && _blendDestination == destination) {
+            _counters.Elided++;
+            return;
+        }
+        _blendSource = source;
+        _blendDestination = destination;
+        _counters.Issued++;
+        glBlendFunc(source, destination);
+    }
+
+    void RenderState::DepthFunc(GLenum function) {
+        if (Change(_depthFunc, function))
+            glDepthFunc(function);
+    }
+
+    void RenderState::DepthMask(bool write) {
+        if (Change(_depthMask, write))
+            glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void RenderState::CullFace(GLenum face) {
+        if (Change(_cullFace, face))
+            glCullFace(face);
+    }
+
+    void RenderState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        const std::array<GLint, 4> viewport{x, y, width, height};
+        if (_viewportKnown && _viewport == viewport) {
+            _counters.Elided++;
+            return;
+        }
+        _viewport = viewport;
+        _viewportKnown = true;
+        _counters.Issued++;
+        glViewport(x, y, width, height);
+    }
+
+    void RenderState::DeleteProgram(GLuint program) {
+        if (_program == program)
+            _program = Unknown;
+        glDeleteProgram(program);
+    }
+
+    void RenderState::DeleteVertexArray(GLuint vertexArray) {
+        // Deleting the bound VAO reverts the binding to zero.
+        if (_vertexArray == vertexArray)
+            _vertexArray = 0;
+        glDeleteVertexArrays(1, &vertexArray);
+    }
+
+    void RenderState::DeleteBuffer(GLuint buffer) {
+        for (auto &bound: _buffers) {
+            if (bound == buffer)
+                bound = 0;
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+
+    void RenderState::DeleteTexture(GLuint texture) {
+        for (auto &unit: _textures) {
+            for (auto &bound: unit) {
+                if (bound == texture)
+                    bound = 0;
+            }
+        }
+        glDeleteTextures(1, &texture);
+    }
+
+    void RenderState::DeleteFramebuffer(GLuint framebuffer) {
+        // Deleting a bound framebuffer reverts its bindings to the default one.
+        if (_drawFramebuffer == framebuffer)
+            _drawFramebuffer = 0;
+        if (_readFramebuffer == framebuffer)
+            _readFramebuffer = 0;
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+
+    void RenderState::Invalidate() {
+        _program = _vertexArray = _drawFramebuffer = _readFramebuffer = _activeUnit = Unknown;
+        _buffers.fill(Unknown);
+        for (auto &unit: _textures)
+            unit.fill(Unknown);
+        _capabilities.fill(Unknown);
+        _blendSource = _blendDestination = _depthFunc = _cullFace = Unknown;
+        _depthMask = Unknown;
+        _viewportKnown = false;
+    }
+
+    RenderStateCounters RenderState::Counters() const {
+        return _counters;
+    }
+
+    void RenderState::ResetCounters() {
+        _counters = {};
+    }
+
+    int RenderState::BufferIndex(GLenum target) {
+        switch (target) {
+            case GL_ARRAY_BUFFER:
+                return ArrayBuffer;
+            case GL_UNIFORM_BUFFER:
+                return UniformBuffer;
+            case GL_DRAW_INDIRECT_BUFFER:
+                return DrawIndirectBuffer;
+            case GL_COPY_READ_BUFFER:
+                return CopyReadBuffer;
+            case GL_COPY_WRITE_BUFFER:
+                return CopyWriteBuffer;
+            default:
+                return -1;
+        }
+    }
+
+    int RenderState::TextureIndex(GLenum target) {
+        switch (target) {
+            case GL_TEXTURE_2D:
+                return Texture2D;
+            case GL_TEXTURE_CUBE_MAP:
+                return TextureCubeMap;
+            case GL_TEXTURE_2D_ARRAY:
+                return Texture2DArray;
+            default:
+                return -1;
+        }
+    }
+
+    int RenderState::CapabilityIndex(GLenum capability) {
+        switch (capability) {
+            case GL_DEPTH_TEST:
+                return DepthTestIndex;
+            case GL_BLEND:
+                return BlendIndex;
+            case GL_CULL_FACE:
+                return CullFaceIndex;
+            case GL_STENCIL_TEST:
+                return StencilTestIndex;
+            case GL_SCISSOR_TEST:
+                return ScissorTestIndex;
+            default:
+                return -1;
+        }
+    }
+}
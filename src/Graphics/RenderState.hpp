@@ -0,0 +1,129 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Graphics {
+    struct RenderStateCounters {
+        std::uint64_t Issued{};
+        std::uint64_t Elided{};
+    };
+
+    // Shadows the GL state the renderer touches and drops calls that would set what is already set. Code that
+    // changes tracked state behind its back (another library, a raw gl call) must call Invalidate afterwards, and
+    // objects must be deleted through the Delete* calls so a recycled name is never mistaken for a bound one.
+    // State is unknown until first set, so the first call of each kind always reaches the driver. GL thread only.
+    class RenderState {
+    public:
+        static constexpr std::size_t MaxTextureUnits = 32;
+
+        RenderState(const RenderState &) = delete;
+
+        RenderState &operator=(const RenderState &) = delete;
+
+        static RenderState &Shared();
+
+        void UseProgram(GLuint program);
+
+        void BindVertexArray(GLuint vertexArray);
+
+        // GL_ELEMENT_ARRAY_BUFFER belongs to the bound VAO and, like other untracked targets, always passes through.
+        void BindBuffer(GLenum target, GLuint buffer);
+
+        // Binds an indexed binding point, which also sets the generic binding of target.
+        void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+        void ActiveTexture(GLenum unit);
+
+        // Binds on the active unit.
+        void BindTexture(GLenum target, GLuint texture);
+
+        void BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+        // 2D textures on consecutive units from first, as one glBindTextures where the driver has it.
+        void BindTextures(GLuint first, std::span<const GLuint> textures);
+
+        void SetEnabled(GLenum capability, bool enabled);
+
+        void Enable(GLenum capability) {
+            SetEnabled(capability, true);
+        }
+
+        void Disable(GLenum capability) {
+            SetEnabled(capability, false);
+        }
+
+        void BlendFunc(GLenum source, GLenum destination);
+
+        void DepthFunc(GLenum function);
+
+        void DepthMask(bool write);
+
+        void CullFace(GLenum face);
+
+        void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+        void DeleteProgram(GLuint program);
+
+        void DeleteVertexArray(GLuint vertexArray);
+
+        void DeleteBuffer(GLuint buffer);
+
+        void DeleteTexture(GLuint texture);
+
+        void DeleteFramebuffer(GLuint framebuffer);
+
+        // Forgets everything, so the next call of each kind is issued.
+        void Invalidate();
+
+        [[nodiscard]] RenderStateCounters Counters() const;
+
+        void ResetCounters();
+
+    private:
+        static constexpr GLuint Unknown = ~0u;
+
+        enum BufferTarget {
+            ArrayBuffer, UniformBuffer, DrawIndirectBuffer, CopyReadBuffer, CopyWriteBuffer, BufferTargetCount
+        };
+        enum TextureTarget {
+            Texture2D, TextureCubeMap, Texture2DArray, TextureTargetCount
+        };
+        enum Capability {
+            DepthTestIndex, BlendIndex, CullFaceIndex, StencilTestIndex, ScissorTestIndex, CapabilityCount
+        };
+
+        GLuint _program = Unknown;
+        GLuint _vertexArray = Unknown;
+        GLuint _drawFramebuffer = Unknown;
+        GLuint _readFramebuffer = Unknown;
+        GLuint _activeUnit = Unknown;
+        std::array<GLuint, BufferTargetCount> _buffers{};
+        std::array<std::array<GLuint, TextureTargetCount>, MaxTextureUnits> _textures{};
+        std::array<GLuint, CapabilityCount> _capabilities{};
+        GLenum _blendSource = Unknown;
+        GLenum _blendDestination = Unknown;
+        GLenum _depthFunc = Unknown;
+        GLuint _depthMask = Unknown;
+        GLenum _cullFace = Unknown;
+        std::array<GLint, 4> _viewport{};
+        bool _viewportKnown = false;
+        RenderStateCounters _counters;
+
+        RenderState();
+
+        // Stores value into slot and returns true when the call has to be issued.
+        bool Change(GLuint &slot, GLuint value);
+
+        static int BufferIndex(GLenum target);
+
+        static int TextureIndex(GLenum target);
+
+        static int CapabilityIndex(GLenum capability);
+    };
+}
@@ -0,0 +1,36 @@
+#include "RenderView.hpp"
+#include "glad/glad.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Graphics {
+
+    namespace {
+        // Spheres reaching closer than this are treated as touching the camera.
+        constexpr float MinDistance = 0.1f;
+    }
+
+    RenderView RenderView::FromCamera(const Camera &camera, float lodThreshold) {
+        GLint viewport[4]{};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        RenderView view;
+        view.Position = camera.Position;
+        view.Frustum = Core::Frustum::FromMatrix(camera.GetCameraMatrix());
+        view.ProjectionScale = static_cast<float>(viewport[3]) /
+                               (2.0f * std::tan(glm::radians(Camera::FieldOfView) * 0.5f));
+        view.LodThreshold = lodThreshold;
+        return view;
+    }
+
+    float RenderView::PixelsPerUnit(const glm::mat4 &model, glm::vec3 center, float radius) const {
+        const float scale = std::sqrt(std::max({
+                glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))
+        }));
+        const auto worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+        const float distance = glm::length(worldCenter - Position) - radius * scale;
+        return ProjectionScale * scale / std::max(distance, MinDistance);
+    }
+}
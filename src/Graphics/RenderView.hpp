@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Camera.hpp"
+#include "Core/Frustum.hpp"
+#include "glm/glm.hpp"
+
+namespace Core {
+    class OcclusionBuffer;
+}
+
+namespace Graphics {
+    class DepthPyramid;
+
+    // Per-frame camera state used to pick levels of detail.
+    struct RenderView {
+        glm::vec3 Position{};
+        Core::Frustum Frustum;
+
+        // Pixels covered by one world unit at a distance of one unit.
+        float ProjectionScale = 1.0f;
+
+        // Largest simplification error, in pixels, a level may show on screen.
+        float LodThreshold = 1.0f;
+
+        // Off for shadow passes, where faces turned away from the camera still cast shadows.
+        bool BackfaceCulling = true;
+
+        // Last frame's depth reprojected for this camera, tested by the GPU culling pass; null to skip the test.
+        const DepthPyramid *Pyramid = nullptr;
+
+        // The same depth read back for culling on the CPU, already drawn for this camera; null to skip the test.
+        const Core::OcclusionBuffer *Occluders = nullptr;
+
+        // Reads the current viewport height; GL thread only.
+        static RenderView FromCamera(const Camera &camera, float lodThreshold = 1.0f);
+
+        // Pixels per object unit for a bounding sphere given in object space, measured at its nearest point.
+        [[nodiscard]] float PixelsPerUnit(const glm::mat4 &model, glm::vec3 center, float radius) const;
+    };
+}
@@ -1,42 +1,106 @@
 #include "Shader.hpp"
+#include "ProgramCache.hpp"
+#include "UniformBlocks.hpp"
+#include "GLExtensions.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include <algorithm>
+#include <numeric>
 
 namespace Graphics {
 
-    Shader::Shader(const char *vertexName, const char *fragmentName) {
+    Shader::Shader(const char *vertexName, const char *fragmentName, const ShaderPermutation &permutation)
+            : _permutation(permutation) {
+        Build({{GL_VERTEX_SHADER, vertexName}, {GL_FRAGMENT_SHADER, fragmentName}});
+    }
+
+    Shader::Shader(const char *computeName, const ShaderPermutation &permutation) : _permutation(permutation) {
+        Build({{GL_COMPUTE_SHADER, computeName}});
+    }
+
+    void Shader::Build(std::initializer_list<Stage> stages) {
+        const std::string basePath = "resources/shaders/";
+        const auto defines = _permutation.Defines();
+        std::vector<ShaderSource> sources;
+        std::vector<std::string_view> texts;
+        sources.reserve(stages.size());
+        for (const auto &stage: stages) {
+            sources.push_back(ShaderPreprocessor::Process(basePath + stage.Name, defines));
+            texts.push_back(sources.back().Text);
+        }
+        const auto cacheKey = ProgramCache::Key(texts, defines);
 
-        unsigned int vertexShader = CreateShader(GL_VERTEX_SHADER, vertexName);
-        unsigned int fragmentShader = CreateShader(GL_FRAGMENT_SHADER, fragmentName);
+        _id = glCreateProgram();
+        if (ProgramCache::Load(_id, cacheKey)) {
+            ReflectUniforms();
+            ReflectBlocks();
+            return;
+        }
 
-        CreateProgram(vertexShader, fragmentShader);
+        std::vector<unsigned int> shaders;
+        for (std::size_t i = 0; i < sources.size(); i++)
+            shaders.push_back(CreateShader(stages.begin()[i].Type, sources[i]));
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        ProgramCache::PrepareForStore(_id);
+        if (CreateProgram(shaders))
+            ProgramCache::Store(_id, cacheKey);
+
+        for (const auto shader: shaders) {
+            glDetachShader(_id, shader);
+            glDeleteShader(shader);
+        }
+        ReflectUniforms();
+        ReflectBlocks();
     }
 
     void Shader::Use() const {
-        glUseProgram(_id);
+        RenderState::Shared().UseProgram(_id);
     }
 
-    void Shader::SetBool(const std::string &name, bool value) const {
-        glUniform1i(glGetUniformLocation(_id, name.c_str()), (int) value);
+    const ShaderPermutation &Shader::Permutation() const {
+        return _permutation;
     }
 
-    void Shader::SetInt(const std::string &name, int value) const {
-        glUniform1i(glGetUniformLocation(_id, name.c_str()), value);
+    GLint Shader::Location(UniformId id) const {
+        if (_uniforms.empty())
+            return -1;
+        const auto mask = _uniforms.size() - 1;
+        for (auto slot = id.Hash & mask;; slot = (slot + 1) & mask) {
+            if (_uniforms[slot].Hash == id.Hash)
+                return _uniforms[slot].Location;
+            if (_uniforms[slot].Hash == 0)
+                return -1;
+        }
     }
 
-    void Shader::SetFloat(const std::string &name, float value) const {
-        glUniform1f(glGetUniformLocation(_id, name.c_str()), value);
+    const Shader::UniformBlock *Shader::Block(UniformId id) const {
+        const auto it = std::find_if(_blocks.begin(), _blocks.end(), [&](const UniformBlock &block) {
+            return block.Hash == id.Hash;
+        });
+        return it == _blocks.end() ? nullptr : &*it;
     }
 
-    unsigned int Shader::CreateShader(GLenum type, const std::string &fileName) {
-        const std::string basePath = "resources/shaders/";
-        std::string strShaderCode = File::GetAllLines(basePath + fileName);
-        const char *shaderCode = strShaderCode.c_str();
+    void Shader::SetBool(UniformId id, bool value) const {
+        glUniform1i(Location(id), (int) value);
+    }
+
+    void Shader::SetInt(UniformId id, int value) const {
+        glUniform1i(Location(id), value);
+    }
+
+    void Shader::SetIVec2(UniformId id, int x, int y) const {
+        glUniform2i(Location(id), x, y);
+    }
+
+    void Shader::SetFloat(UniformId id, float value) const {
+        glUniform1f(Location(id), value);
+    }
+
+    unsigned int Shader::CreateShader(GLenum type, const ShaderSource &source) {
+        const char *shaderCode = source.Text.data();
+        const auto length = static_cast<GLint>(source.Text.size());
 
         unsigned int shader = glCreateShader(type);
-        glShaderSource(shader, 1, &shaderCode, nullptr);
+        glShaderSource(shader, 1, &shaderCode, &length);
         glCompileShader(shader);
 
         int success;
@@ -46,16 +110,20 @@ namespace Graphics {
             glGetShaderInfoLog(shader, 512, nullptr, info);
             if (type == GL_VERTEX_SHADER)
                 Log::Error("SHADER::VERTEX::COMPILATION_FAILED: {}", info);
+            else if (type == GL_COMPUTE_SHADER)
+                Log::Error("SHADER::COMPUTE::COMPILATION_FAILED: {}", info);
             else
                 Log::Error("SHADER::FRAGMENT::COMPILATION_FAILED: {}", info);
+            // Log lines read "source(line)"; name the source strings the preprocessor numbered.
+            for (std::size_t i = 0; i < source.Files.size(); i++)
+                Log::Information(fmt::format("  source {}: {}", i, source.Files[i]));
         }
         return shader;
     }
 
-    void Shader::CreateProgram(unsigned int vertex, unsigned int fragment) {
-        _id = glCreateProgram();
-        glAttachShader(_id, vertex);
-        glAttachShader(_id, fragment);
+    bool Shader::CreateProgram(std::span<const unsigned int> shaders) {
+        for (const auto shader: shaders)
+            glAttachShader(_id, shader);
         glLinkProgram(_id);
 
         int success;
@@ -65,30 +133,141 @@ namespace Graphics {
             glGetProgramInfoLog(_id, 512, nullptr, info);
             Log::Error("SHADER::PROGRAM::LINK_FAILED: {}", info);
         }
+        return success;
     }
 
-    void Shader::SetTexture(const char *uName, const Texture &texture) const {
+    void Shader::SetTexture(UniformId id, const Texture &texture) const {
         texture.ActivateAndBind();
-        this->SetInt(uName, texture.GetIndex());
+        this->SetInt(id, texture.GetIndex());
     }
 
-    void Shader::SetMat4(const std::string &name, const glm::mat4 matrix) const {
-        glUniformMatrix4fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+    void Shader::SetMat4(UniformId id, const glm::mat4 matrix) const {
+        glUniformMatrix4fv(Location(id), 1, GL_FALSE, glm::value_ptr(matrix));
     }
 
-    void Shader::SetVec3(const std::string &name, glm::vec3 &vec) const {
-        glUniform3fv(glGetUniformLocation(_id, name.c_str()), 1, &vec[0]);
+    void Shader::SetVec3(UniformId id, glm::vec3 &vec) const {
+        glUniform3fv(Location(id), 1, &vec[0]);
     }
 
-    void Shader::SetVec3(const std::string &name, float x, float y, float z) const {
-        glUniform3f(glGetUniformLocation(_id, name.c_str()), x, y, z);
+    void Shader::SetVec3(UniformId id, float x, float y, float z) const {
+        glUniform3f(Location(id), x, y, z);
     }
 
-    void Shader::SetVec4(const std::string &name, glm::vec4 &vec) const {
-        glUniform4fv(glGetUniformLocation(_id, name.c_str()), 1, &vec[0]);
+    void Shader::SetVec4(UniformId id, glm::vec4 &vec) const {
+        glUniform4fv(Location(id), 1, &vec[0]);
+    }
+
+    void Shader::SetVec4(UniformId id, float x, float y, float z, float w) const {
+        glUniform4f(Location(id), x, y, z, w);
+    }
+
+    void Shader::ReflectUniforms() {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::vector<UniformSlot> found;
+        std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(_id, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+            const std::string_view view(name.data(), static_cast<std::size_t>(length));
+
+            // Uniform block members have no location.
+            const auto location = glGetUniformLocation(_id, name.c_str());
+            if (location < 0)
+                continue;
+            if (!view.ends_with("[0]")) {
+                found.push_back({UniformId::FromName(view).Hash, location});
+                continue;
+            }
+
+            // Arrays are listed once as "name[0]"; every element is reachable by index and the bare name.
+            const std::string array(view.substr(0, view.size() - 3));
+            found.push_back({UniformId::FromName(array).Hash, location});
+            for (GLint element = 0; element < size; element++) {
+                const auto elementName = array + '[' + std::to_string(element) + ']';
+                found.push_back({UniformId::Element(array, static_cast<std::size_t>(element)).Hash,
+                                 glGetUniformLocation(_id, elementName.c_str())});
+            }
+        }
+
+        std::size_t capacity = 1;
+        while (capacity < found.size() * 2)
+            capacity <<= 1;
+        _uniforms.assign(found.empty() ? 0 : capacity, {0, -1});
+        const auto mask = capacity - 1;
+        for (const auto &uniform: found) {
+            auto slot = uniform.Hash & mask;
+            while (_uniforms[slot].Hash != 0 && _uniforms[slot].Hash != uniform.Hash)
+                slot = (slot + 1) & mask;
+            _uniforms[slot] = uniform;
+        }
     }
 
-    void Shader::SetVec4(const std::string &name, float x, float y, float z, float w) const {
-        glUniform4f(glGetUniformLocation(_id, name.c_str()), x, y, z, w);
+    void Shader::ReflectBlocks() {
+        GLint blockCount = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+
+        std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+        std::vector<const UniformBlockLayout *> layouts(static_cast<std::size_t>(blockCount), nullptr);
+        _blocks.clear();
+        for (GLint i = 0; i < blockCount; i++) {
+            const auto index = static_cast<GLuint>(i);
+            GLsizei length = 0;
+            GLint binding = 0;
+            GLint size = 0;
+            glGetActiveUniformBlockName(_id, index, maxLength, &length, name.data());
+            glGetActiveUniformBlockiv(_id, index, GL_UNIFORM_BLOCK_BINDING, &binding);
+            glGetActiveUniformBlockiv(_id, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+            const auto id = UniformId::FromName(std::string_view(name.data(), static_cast<std::size_t>(length)));
+
+            for (const auto &layout: UniformBlockLayouts::All) {
+                if (layout.Name != id)
+                    continue;
+                layouts[index] = &layout;
+                if (static_cast<GLuint>(binding) != layout.Binding) {
+                    glUniformBlockBinding(_id, index, layout.Binding);
+                    binding = static_cast<GLint>(layout.Binding);
+                }
+                if (static_cast<std::size_t>(size) > layout.Size) {
+                    const std::string blockName(name.data(), static_cast<std::size_t>(length));
+                    Log::Error("SHADER::BLOCK_LARGER_THAN_MIRROR {}", blockName);
+                }
+            }
+            _blocks.push_back({id.Hash, static_cast<GLuint>(binding), static_cast<std::size_t>(size)});
+        }
+        if (blockCount == 0)
+            return;
+
+        // Members of mirrored blocks must sit where the CPU struct puts them.
+        GLint uniformCount = 0;
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLuint> indices(static_cast<std::size_t>(uniformCount));
+        std::iota(indices.begin(), indices.end(), 0u);
+        std::vector<GLint> blockIndices(indices.size());
+        std::vector<GLint> offsets(indices.size());
+        glGetActiveUniformsiv(_id, uniformCount, indices.data(), GL_UNIFORM_BLOCK_INDEX, blockIndices.data());
+        glGetActiveUniformsiv(_id, uniformCount, indices.data(), GL_UNIFORM_OFFSET, offsets.data());
+
+        name.assign(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            if (blockIndices[i] < 0 || !layouts[static_cast<std::size_t>(blockIndices[i])])
+                continue;
+            GLsizei length = 0;
+            glGetActiveUniformName(_id, indices[i], maxLength, &length, name.data());
+            const std::string member(name.data(), static_cast<std::size_t>(length));
+            const auto id = UniformId::FromName(member);
+            for (const auto &expected: layouts[static_cast<std::size_t>(blockIndices[i])]->Members) {
+                if (expected.Name == id && expected.Offset != static_cast<std::size_t>(offsets[i]))
+                    Log::Error("SHADER::BLOCK_MEMBER_OFFSET {}", member);
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,46 +1,97 @@
 #pragma once
 
 #include <string>
-#include "File.hpp"
+#include <string_view>
+#include "ShaderPermutation.hpp"
+#include "RenderState.hpp"
+#include "ShaderPreprocessor.hpp"
 #include "Texture.hpp"
+#include "UniformId.hpp"
 #include "Log.hpp"
 #include "glm/glm.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
 
 namespace Graphics {
     class Shader {
     public:
-        Shader(const char *vertexName, const char *fragmentName);
+        struct UniformBlock {
+            std::uint64_t Hash;
+            GLuint Binding;
+            // GL_UNIFORM_BLOCK_DATA_SIZE: the std140 size, arrays included.
+            std::size_t Size;
+        };
+
+        Shader(const char *vertexName, const char *fragmentName, const ShaderPermutation &permutation = {});
+
+        // A compute program; dispatch it with GLExtensions::DispatchCompute after Use.
+        explicit Shader(const char *computeName, const ShaderPermutation &permutation = {});
 
         void Use() const;
 
-        void SetBool(const std::string &name, bool value) const;
+        [[nodiscard]] const ShaderPermutation &Permutation() const;
+
+        // Location reflected at link time; -1 for names the program does not use, which the setters ignore.
+        [[nodiscard]] GLint Location(UniformId id) const;
+
+        // Reflected at link time; nullptr for blocks the program does not use. Blocks with a mirror in
+        // UniformBlocks.hpp are moved to the mirror's binding and checked against its layout.
+        [[nodiscard]] const UniformBlock *Block(UniformId id) const;
+
+        void SetBool(UniformId id, bool value) const;
+
+        void SetInt(UniformId id, int value) const;
 
-        void SetInt(const std::string &name, int value) const;
+        void SetIVec2(UniformId id, int x, int y) const;
 
-        void SetFloat(const std::string &name, float value) const;
+        void SetFloat(UniformId id, float value) const;
 
-        void SetTexture(const char *uName, const Texture &texture) const;
+        void SetTexture(UniformId id, const Texture &texture) const;
 
-        void SetMat4(const std::string &name, glm::mat4 matrix) const;
+        void SetMat4(UniformId id, glm::mat4 matrix) const;
 
-        void SetVec3(const std::string &name, glm::vec3 &vec) const;
+        void SetVec3(UniformId id, glm::vec3 &vec) const;
 
-        void SetVec3(const std::string &name, float x, float y, float z) const;
+        void SetVec3(UniformId id, float x, float y, float z) const;
 
-        void SetVec4(const std::string &name, glm::vec4 &vec) const;
+        void SetVec4(UniformId id, glm::vec4 &vec) const;
 
-        void SetVec4(const std::string &name, float x, float y, float z, float w) const;
+        void SetVec4(UniformId id, float x, float y, float z, float w) const;
 
         ~Shader() {
-            glDeleteProgram(_id);
+            RenderState::Shared().DeleteProgram(_id);
         }
 
     private:
+        struct UniformSlot {
+            std::uint64_t Hash;
+            GLint Location;
+        };
+
         unsigned int _id{};
+        ShaderPermutation _permutation;
+        // Open-addressed by name hash, power-of-two sized; a zero hash marks an empty slot.
+        std::vector<UniformSlot> _uniforms;
+        std::vector<UniformBlock> _blocks;
+
+        struct Stage {
+            GLenum Type;
+            const char *Name;
+        };
+
+        // Loads the program from the cache or compiles and links the stages, then reflects it.
+        void Build(std::initializer_list<Stage> stages);
+
+        static unsigned int CreateShader(GLenum type, const ShaderSource &source);
+
+        // Links the attached stages into _id; returns whether linking succeeded.
+        bool CreateProgram(std::span<const unsigned int> shaders);
 
-        static unsigned int CreateShader(GLenum type, const std::string &fileName);
+        void ReflectUniforms();
 
-        void CreateProgram(unsigned int vertex, unsigned int fragment);
+        void ReflectBlocks();
 
     };
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "fmt/format.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace Graphics {
+    // Where LitShader finds material textures: bound per material, or looked up by the per-draw material index in
+    // texture arrays or through bindless handles (see MaterialTable).
+    enum class MaterialTextureMode : std::uint8_t {
+        Bound,
+        Arrays,
+        Bindless
+    };
+
+    // Compile-time feature set of a shader; every switch reaches both stages as a #define, so code for features a
+    // draw does not use is stripped by the compiler instead of branched around per fragment.
+    struct ShaderPermutation {
+        static constexpr std::uint32_t MaxPointLights = 128;
+
+        bool Shadows = false;
+        bool SpotLight = false;
+        bool Instanced = false;
+        bool AlphaTest = false;
+        std::uint32_t PointLightCount = 0;
+        MaterialTextureMode MaterialTextures = MaterialTextureMode::Bound;
+
+        [[nodiscard]] std::uint64_t Key() const {
+            return static_cast<std::uint64_t>(PointLightCount) << 6 | Shadows | SpotLight << 1 | Instanced << 2 |
+                   AlphaTest << 3 | static_cast<std::uint64_t>(MaterialTextures) << 4;
+        }
+
+        [[nodiscard]] std::string Defines() const {
+            return fmt::format("#define SHADOWS {}\n#define SPOT_LIGHT {}\n#define INSTANCED {}\n"
+                               "#define ALPHA_TEST {}\n#define POINT_LIGHT_COUNT {}\n#define MATERIAL_TEXTURES {}\n",
+                               int(Shadows), int(SpotLight), int(Instanced), int(AlphaTest),
+                               std::min(PointLightCount, MaxPointLights), int(MaterialTextures));
+        }
+
+        bool operator==(const ShaderPermutation &) const = default;
+    };
+}
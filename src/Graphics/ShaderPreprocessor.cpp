@@ -0,0 +1,72 @@
+#include "ShaderPreprocessor.hpp"
+#include "FileSystem.hpp"
+#include "Log.hpp"
+#include "fmt/format.h"
+#include <algorithm>
+
+namespace Graphics {
+
+    namespace {
+        std::string_view TrimLeft(std::string_view line) {
+            const auto start = line.find_first_not_of(" \t");
+            return start == std::string_view::npos ? std::string_view{} : line.substr(start);
+        }
+
+        // The quoted name of an #include line; empty for any other line.
+        std::string_view IncludeName(std::string_view line) {
+            line = TrimLeft(line);
+            if (!line.starts_with("#"))
+                return {};
+            line = TrimLeft(line.substr(1));
+            if (!line.starts_with("include"))
+                return {};
+            const auto open = line.find('"');
+            const auto close = line.find('"', open + 1);
+            if (open == std::string_view::npos || close == std::string_view::npos)
+                return {};
+            return line.substr(open + 1, close - open - 1);
+        }
+
+        void Expand(const std::string &path, std::string_view defines, ShaderSource &source) {
+            const auto file = FileSystem::Shared().Open(path);
+            const auto text = file.Text();
+            const auto index = source.Files.size();
+            source.Files.push_back(path);
+            const auto directory = path.substr(0, path.find_last_of('/') + 1);
+
+            std::size_t lineNumber = 0;
+            for (std::size_t start = 0; start < text.size();) {
+                auto end = text.find('\n', start);
+                if (end == std::string_view::npos)
+                    end = text.size();
+                const auto line = text.substr(start, end - start);
+                start = end + 1;
+                lineNumber++;
+
+                if (const auto name = IncludeName(line); !name.empty()) {
+                    const auto includePath = FileSystem::NormalizePath(directory + std::string(name));
+                    if (std::find(source.Files.begin(), source.Files.end(), includePath) == source.Files.end()) {
+                        source.Text += fmt::format("#line 1 {}\n", source.Files.size());
+                        Expand(includePath, {}, source);
+                    }
+                    source.Text += fmt::format("#line {} {}\n", lineNumber + 1, index);
+                    continue;
+                }
+
+                source.Text += line;
+                source.Text += '\n';
+                if (!defines.empty() && TrimLeft(line).starts_with("#version")) {
+                    source.Text += defines;
+                    source.Text += fmt::format("#line {} {}\n", lineNumber + 1, index);
+                    defines = {};
+                }
+            }
+        }
+    }
+
+    ShaderSource ShaderPreprocessor::Process(const std::string &path, std::string_view defines) {
+        ShaderSource source;
+        Expand(FileSystem::NormalizePath(path), defines, source);
+        return source;
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Graphics {
+    struct ShaderSource {
+        std::string Text;
+        // Source string numbers used by the #line directives, for reading compiler logs.
+        std::vector<std::string> Files;
+    };
+
+    class ShaderPreprocessor {
+    public:
+        // Expands #include "name" relative to the including file, pulling each file in at most once, and inserts
+        // defines right after the #version line.
+        static ShaderSource Process(const std::string &path, std::string_view defines);
+    };
+}
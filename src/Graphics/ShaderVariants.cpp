@@ -0,0 +1,15 @@
+#include "ShaderVariants.hpp"
+
+namespace Graphics {
+
+    ShaderVariants::ShaderVariants(std::string vertexName, std::string fragmentName)
+            : _vertexName(std::move(vertexName)), _fragmentName(std::move(fragmentName)) {
+    }
+
+    Shader &ShaderVariants::Get(const ShaderPermutation &permutation) {
+        auto &variant = _variants[permutation.Key()];
+        if (!variant)
+            variant = std::make_unique<Shader>(_vertexName.c_str(), _fragmentName.c_str(), permutation);
+        return *variant;
+    }
+}
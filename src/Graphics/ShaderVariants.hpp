@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Shader.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Graphics {
+    // One vertex/fragment pair specialized per permutation; each variant compiles the first time it is asked for.
+    class ShaderVariants {
+    public:
+        ShaderVariants(std::string vertexName, std::string fragmentName);
+
+        Shader &Get(const ShaderPermutation &permutation);
+
+    private:
+        std::string _vertexName;
+        std::string _fragmentName;
+        std::unordered_map<std::uint64_t, std::unique_ptr<Shader>> _variants;
+    };
+}
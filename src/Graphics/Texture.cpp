@@ -1,73 +1,45 @@
 #include "Texture.hpp"
+#include "RenderState.hpp"
 
 namespace Graphics {
 
-    Texture::Texture(const char *texPath, GLenum index, GLint wrap, bool gammaCorrection) : _index(index) {
-        stbi_set_flip_vertically_on_load(true);
-
-        glGenTextures(1, &_id);
-        glBindTexture(GL_TEXTURE_2D, _id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-        unsigned char *buffer = stbi_load(
-                texPath,
-                &_width, &_height,
-                &_nrChannels, 0);
-
-        if (buffer) {
-            GLenum internalFormat;
-            GLenum dataFormat;
-            if (_nrChannels == 1)
-            {
-                internalFormat = dataFormat = GL_RED;
-            }
-            else if (_nrChannels == 3)
-            {
-                internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-                dataFormat = GL_RGB;
-            }
-            else if (_nrChannels == 4)
-            {
-                internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-                dataFormat = GL_RGBA;
-            }
-
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, _width, _height, 0, dataFormat, GL_UNSIGNED_BYTE, buffer);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        } else {
-            Log::Error("TEXTURE::LOAD_FAILED {}", texPath);
-        }
-        stbi_image_free(buffer);
+    Texture::Texture(const char *texPath, GLenum index, GLint wrap, bool gammaCorrection, Core::LoadMode mode)
+            : _index(index) {
+        TextureParams params;
+        params.Wrap = wrap;
+        params.MinFilter = GL_NEAREST_MIPMAP_LINEAR;
+        params.MagFilter = GL_NEAREST;
+        params.GammaCorrection = gammaCorrection;
+        _texture = TextureCache::Shared().Load(texPath, params, mode);
     }
 
     void Texture::ActivateAndBind() const {
-        glActiveTexture(_index);
-        glBindTexture(GL_TEXTURE_2D, _id);
+        RenderState::Shared().BindTexture(_index - GL_TEXTURE0, GL_TEXTURE_2D, _texture->Id);
     }
 
     void Texture::ActivateAndBind(GLenum texIndex) {
         _index = texIndex;
-        glActiveTexture(_index);
-        glBindTexture(GL_TEXTURE_2D, _id);
+        ActivateAndBind();
     }
 
     unsigned int Texture::GetId() const {
-        return _id;
+        return _texture->Id;
     }
 
     int Texture::GetWidth() const {
-        return _width;
+        return _texture->Width;
     }
 
     int Texture::GetHeight() const {
-        return _height;
+        return _texture->Height;
     }
 
     int Texture::GetNrChannels() const {
-        return _nrChannels;
+        return _texture->Channels;
+    }
+
+    bool Texture::IsResident() const {
+        return _texture->Loading.IsReady();
     }
 
     int Texture::GetIndex() const {
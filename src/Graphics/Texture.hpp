@@ -2,14 +2,18 @@
 
 #include <iostream>
 #include "glad/glad.h"
-#include "stb_image.h"
+#include "TextureCache.hpp"
+#include "Core/Scheduler.hpp"
 #include "Log.hpp"
 
 namespace Graphics {
 
     class Texture {
     public:
-        Texture(const char *texPath, GLenum index, GLint wrap = GL_REPEAT, bool gammaCorrection = false);
+        // Shares the GL texture with every other user of the same file and sampling state. Async mode returns with a
+        // 1x1 placeholder bound to the id; dimensions stay zero until the image is resident.
+        Texture(const char *texPath, GLenum index, GLint wrap = GL_REPEAT, bool gammaCorrection = false,
+                Core::LoadMode mode = Core::LoadMode::Blocking);
 
         void ActivateAndBind() const;
 
@@ -25,11 +29,10 @@ namespace Graphics {
 
         int GetIndex() const;
 
+        bool IsResident() const;
+
     private:
-        unsigned int _id{};
-        int _width{};
-        int _height{};
-        int _nrChannels{};
+        TextureCache::Handle _texture;
 
         GLenum _index{};
     };
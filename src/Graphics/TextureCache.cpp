@@ -0,0 +1,202 @@
+#include "TextureCache.hpp"
+#include "Core/Hash.hpp"
+#include "FileSystem.hpp"
+#include "GLExtensions.hpp"
+#include "Log.hpp"
+#include "RenderState.hpp"
+#include <filesystem>
+#include <utility>
+
+namespace Graphics {
+
+    std::uint64_t TextureParams::Hash() const {
+        auto hash = Core::Hash::Combine(static_cast<std::uint64_t>(Wrap), static_cast<std::uint64_t>(MinFilter));
+        hash = Core::Hash::Combine(hash, static_cast<std::uint64_t>(MagFilter));
+        hash = Core::Hash::Combine(hash, GammaCorrection);
+        hash = Core::Hash::Combine(hash, FlipVertically);
+        return Core::Hash::Combine(hash, static_cast<std::uint64_t>(Compression));
+    }
+
+    bool DecodedTexture::IsValid() const {
+        return Compressed || Pixels.IsValid();
+    }
+
+    TextureCache &TextureCache::Shared() {
+        static TextureCache cache;
+        return cache;
+    }
+
+    std::string TextureCache::NormalizePath(const std::string &path) {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    DecodedTexture TextureCache::Decode(const std::string &path, const TextureParams &params) {
+        const auto file = FileSystem::Shared().Open(path);
+        if (!file.IsOpen())
+            return {};
+
+        DecodedTexture decoded;
+        decoded.ContentHash = Core::Hash::Fnv1a(file.Data());
+        if (params.Compression != TextureCompression::None) {
+            decoded.Compressed = CompressedTexture::Open(path, decoded.ContentHash, CookSettingsHash(params));
+            if (decoded.Compressed)
+                return decoded;
+        }
+
+        decoded.Pixels = Image::Decode(file.Data(), params.FlipVertically);
+        const auto format = TextureCompressor::Resolve(params.Compression, decoded.Pixels);
+        if (format != TextureCompression::None) {
+            decoded.Compressed = CompressedTexture::Cook(path, decoded.ContentHash, CookSettingsHash(params),
+                                                         decoded.Pixels, format, params.GammaCorrection);
+            decoded.Pixels = {};
+        }
+        return decoded;
+    }
+
+    TextureCache::Handle TextureCache::Find(const std::string &path, const TextureParams &params) {
+        const auto it = _byPath.find({NormalizePath(path), params});
+        if (it == _byPath.end())
+            return nullptr;
+        return it->second.lock();
+    }
+
+    TextureCache::Handle TextureCache::Insert(const std::string &path, const TextureParams &params,
+                                              DecodedTexture decoded) {
+        const auto normalizedPath = NormalizePath(path);
+        TexturePathKey pathKey{normalizedPath, params};
+        if (const auto it = _byPath.find(pathKey); it != _byPath.end()) {
+            if (auto texture = it->second.lock())
+                return texture;
+        }
+
+        const TextureContentKey contentKey{decoded.ContentHash, params};
+        if (decoded.IsValid()) {
+            if (const auto it = _byContent.find(contentKey); it != _byContent.end()) {
+                if (auto texture = it->second.lock()) {
+                    Alias(texture, std::move(pathKey));
+                    return texture;
+                }
+            }
+        }
+
+        auto texture = Create(normalizedPath, params);
+        texture->ContentHash = decoded.ContentHash;
+        Upload(*texture, decoded, params);
+        if (decoded.IsValid()) {
+            texture->_contentKey = contentKey;
+            _byContent[contentKey] = texture;
+        }
+        return texture;
+    }
+
+    TextureCache::Handle TextureCache::Load(const std::string &path, const TextureParams &params,
+                                            Core::LoadMode mode) {
+        if (auto texture = Find(path, params))
+            return texture;
+
+        if (mode == Core::LoadMode::Blocking)
+            return Insert(path, params, Decode(path, params));
+
+        auto texture = Create(NormalizePath(path), params);
+        texture->Loading = StreamTexture(texture, params);
+        return texture;
+    }
+
+    std::size_t TextureCache::KeyHash::operator()(const TexturePathKey &key) const {
+        return static_cast<std::size_t>(Core::Hash::Combine(Core::Hash::Fnv1a(key.Path), key.Params.Hash()));
+    }
+
+    std::size_t TextureCache::KeyHash::operator()(const TextureContentKey &key) const {
+        return static_cast<std::size_t>(Core::Hash::Combine(key.ContentHash, key.Params.Hash()));
+    }
+
+    // The cooked format depends on what the driver can sample, so a file cooked elsewhere is re-cooked here.
+    std::uint64_t TextureCache::CookSettingsHash(const TextureParams &params) {
+        auto hash = Core::Hash::Combine(static_cast<std::uint64_t>(params.Compression), params.GammaCorrection);
+        hash = Core::Hash::Combine(hash, params.FlipVertically);
+        hash = Core::Hash::Combine(hash, GLExtensions::TextureCompressionS3TC);
+        return Core::Hash::Combine(hash, GLExtensions::TextureCompressionBPTC);
+    }
+
+    std::shared_ptr<CachedTexture> TextureCache::Create(const std::string &normalizedPath,
+                                                        const TextureParams &params) {
+        static constexpr unsigned char placeholder[4] = {128, 128, 128, 255};
+
+        std::shared_ptr<CachedTexture> texture(new CachedTexture(), [this](CachedTexture *t) { Release(t); });
+        texture->Path = normalizedPath;
+
+        glGenTextures(1, &texture->Id);
+        RenderState::Shared().BindTexture(GL_TEXTURE_2D, texture->Id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.Wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.Wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.MinFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.MagFilter);
+
+        Alias(texture, {normalizedPath, params});
+        return texture;
+    }
+
+    void TextureCache::Alias(const std::shared_ptr<CachedTexture> &texture, TexturePathKey pathKey) {
+        _byPath[pathKey] = texture;
+        texture->_pathKeys.push_back(std::move(pathKey));
+    }
+
+    void TextureCache::Release(CachedTexture *texture) {
+        for (const auto &key: texture->_pathKeys) {
+            if (const auto it = _byPath.find(key); it != _byPath.end() && it->second.expired())
+                _byPath.erase(it);
+        }
+        if (texture->_contentKey) {
+            const auto it = _byContent.find(*texture->_contentKey);
+            if (it != _byContent.end() && it->second.expired())
+                _byContent.erase(it);
+        }
+
+        RenderState::Shared().DeleteTexture(texture->Id);
+        delete texture;
+    }
+
+    void TextureCache::Upload(CachedTexture &texture, const DecodedTexture &decoded, const TextureParams &params) {
+        if (!decoded.IsValid()) {
+            Log::Error("TEXTURE::LOAD_FAILED {}", texture.Path);
+            return;
+        }
+
+        RenderState::Shared().BindTexture(GL_TEXTURE_2D, texture.Id);
+        if (decoded.Compressed) {
+            texture.Width = decoded.Compressed->Width();
+            texture.Height = decoded.Compressed->Height();
+            texture.Channels = decoded.Compressed->Channels;
+            decoded.Compressed->Upload();
+            return;
+        }
+
+        const auto &image = decoded.Pixels;
+        texture.Width = image.Width;
+        texture.Height = image.Height;
+        texture.Channels = image.Channels;
+        glTexImage2D(GL_TEXTURE_2D, 0, image.InternalFormat(params.GammaCorrection), image.Width, image.Height, 0,
+                     image.DataFormat(), GL_UNSIGNED_BYTE, image.Pixels());
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    // The handle was given out before the content hash was known, so a duplicate found here cannot be folded into
+    // it; the entry is still published so later loads of the same pixels resolve to it.
+    Core::Task<void> TextureCache::StreamTexture(std::shared_ptr<CachedTexture> texture, TextureParams params) {
+        co_await Core::Scheduler::WorkerThread();
+        auto decoded = Decode(texture->Path, params);
+
+        co_await Core::Scheduler::MainThread();
+        texture->ContentHash = decoded.ContentHash;
+        Upload(*texture, decoded, params);
+        if (!decoded.IsValid())
+            co_return;
+
+        const TextureContentKey contentKey{decoded.ContentHash, params};
+        if (const auto it = _byContent.find(contentKey); it == _byContent.end() || it->second.expired()) {
+            texture->_contentKey = contentKey;
+            _byContent[contentKey] = texture;
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Image.hpp"
+#include "CompressedTexture.hpp"
+#include "TextureCompressor.hpp"
+#include "Core/Scheduler.hpp"
+#include "Core/Task.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics {
+
+    // Everything that changes the uploaded GL object, so the same file sampled two ways gets two entries.
+    struct TextureParams {
+        GLint Wrap = GL_REPEAT;
+        GLint MinFilter = GL_LINEAR_MIPMAP_LINEAR;
+        GLint MagFilter = GL_LINEAR;
+        bool GammaCorrection = false;
+        bool FlipVertically = true;
+        TextureCompression Compression = TextureCompression::Auto;
+
+        [[nodiscard]] std::uint64_t Hash() const;
+
+        bool operator==(const TextureParams &) const = default;
+    };
+
+    // Cache keys hold what they stand for, so a hash collision costs a probe rather than returning the wrong texture.
+    struct TexturePathKey {
+        std::string Path;
+        TextureParams Params;
+
+        bool operator==(const TexturePathKey &) const = default;
+    };
+
+    struct TextureContentKey {
+        std::uint64_t ContentHash{};
+        TextureParams Params;
+
+        bool operator==(const TextureContentKey &) const = default;
+    };
+
+    struct CachedTexture {
+        unsigned int Id{};
+        std::string Path;
+        std::uint64_t ContentHash{};
+        int Width{};
+        int Height{};
+        int Channels{};
+        Core::Task<void> Loading;
+
+    private:
+        friend class TextureCache;
+
+        std::optional<TextureContentKey> _contentKey;
+        std::vector<TexturePathKey> _pathKeys;
+    };
+
+    // Either a cooked block-compressed chain or raw pixels when compression is off or unsupported.
+    struct DecodedTexture {
+        std::uint64_t ContentHash{};
+        Image Pixels;
+        std::unique_ptr<CompressedTexture> Compressed;
+
+        [[nodiscard]] bool IsValid() const;
+    };
+
+    // Process-wide 2D texture cache. Entries are found by normalized path, then by content hash, and the GL texture
+    // is deleted when the last handle goes away. Lookups and handle releases must happen on the GL thread.
+    class TextureCache {
+    public:
+        using Handle = std::shared_ptr<const CachedTexture>;
+
+        TextureCache() = default;
+
+        TextureCache(const TextureCache &) = delete;
+
+        TextureCache &operator=(const TextureCache &) = delete;
+
+        static TextureCache &Shared();
+
+        static std::string NormalizePath(const std::string &path);
+
+        // Thread-safe: maps the file once to hash it, then loads the cooked chain or decodes and cooks it.
+        static DecodedTexture Decode(const std::string &path, const TextureParams &params);
+
+        Handle Find(const std::string &path, const TextureParams &params);
+
+        // Returns the resident texture with identical content if there is one, otherwise uploads the decoded pixels.
+        Handle Insert(const std::string &path, const TextureParams &params, DecodedTexture decoded);
+
+        // Async returns a placeholder at once; its Loading task completes after the real pixels are uploaded.
+        Handle Load(const std::string &path, const TextureParams &params,
+                    Core::LoadMode mode = Core::LoadMode::Blocking);
+
+    private:
+        struct KeyHash {
+            std::size_t operator()(const TexturePathKey &key) const;
+
+            std::size_t operator()(const TextureContentKey &key) const;
+        };
+
+        std::unordered_map<TexturePathKey, std::weak_ptr<CachedTexture>, KeyHash> _byPath;
+        std::unordered_map<TextureContentKey, std::weak_ptr<CachedTexture>, KeyHash> _byContent;
+
+        std::shared_ptr<CachedTexture> Create(const std::string &normalizedPath, const TextureParams &params);
+
+        void Alias(const std::shared_ptr<CachedTexture> &texture, TexturePathKey pathKey);
+
+        void Release(CachedTexture *texture);
+
+        static std::uint64_t CookSettingsHash(const TextureParams &params);
+
+        static void Upload(CachedTexture &texture, const DecodedTexture &decoded, const TextureParams &params);
+
+        Core::Task<void> StreamTexture(std::shared_ptr<CachedTexture> texture, TextureParams params);
+    };
+}
@@ -0,0 +1,461 @@
+#include "TextureCompressor.hpp"
+#include "GLExtensions.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Graphics {
+
+    namespace {
+        using Block = std::array<std::array<std::uint8_t, 4>, 16>;
+
+        constexpr std::array<int, 16> Bc7Weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        const std::array<float, 256> &SrgbToLinearTable() {
+            static const auto table = [] {
+                std::array<float, 256> values{};
+                for (int i = 0; i < 256; i++) {
+                    const float c = static_cast<float>(i) / 255.0f;
+                    values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+            return table;
+        }
+
+        std::uint8_t LinearToSrgb(float c) {
+            c = std::clamp(c, 0.0f, 1.0f);
+            const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            return static_cast<std::uint8_t>(std::lround(s * 255.0f));
+        }
+
+        std::uint8_t ToUnorm8(float c) {
+            return static_cast<std::uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+        }
+
+        Block FetchBlock(const MipLevel &level, int blockX, int blockY) {
+            Block block{};
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    const auto sourceX = static_cast<std::size_t>(std::min(blockX * 4 + x, level.Width - 1));
+                    const auto sourceY = static_cast<std::size_t>(std::min(blockY * 4 + y, level.Height - 1));
+                    std::memcpy(block[y * 4 + x].data(), &level.Rgba[(sourceY * level.Width + sourceX) * 4], 4);
+                }
+            }
+            return block;
+        }
+
+        // Principal axis of the first N channels, found by power iteration on the covariance matrix.
+        template<int N>
+        void PrincipalAxis(const Block &block, std::array<float, N> &mean, std::array<float, N> &axis) {
+            mean = {};
+            for (const auto &pixel: block) {
+                for (int c = 0; c < N; c++)
+                    mean[c] += pixel[c] / 16.0f;
+            }
+
+            float covariance[N][N]{};
+            for (const auto &pixel: block) {
+                for (int i = 0; i < N; i++) {
+                    for (int j = 0; j < N; j++)
+                        covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+                }
+            }
+
+            int seed = 0;
+            for (int c = 1; c < N; c++) {
+                if (covariance[c][c] > covariance[seed][seed])
+                    seed = c;
+            }
+            for (int c = 0; c < N; c++)
+                axis[c] = covariance[seed][c];
+
+            for (int iteration = 0; iteration < 8; iteration++) {
+                std::array<float, N> next{};
+                float largest = 0.0f;
+                for (int i = 0; i < N; i++) {
+                    for (int j = 0; j < N; j++)
+                        next[i] += covariance[i][j] * axis[j];
+                    largest = std::max(largest, std::abs(next[i]));
+                }
+                if (largest == 0.0f)
+                    break;
+                for (int c = 0; c < N; c++)
+                    axis[c] = next[c] / largest;
+            }
+
+            float length = 0.0f;
+            for (int c = 0; c < N; c++)
+                length += axis[c] * axis[c];
+            length = std::sqrt(length);
+            for (int c = 0; c < N; c++)
+                axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+        }
+
+        template<int N>
+        void ProjectExtents(const Block &block, const std::array<float, N> &mean, const std::array<float, N> &axis,
+                            float &minT, float &maxT) {
+            minT = std::numeric_limits<float>::max();
+            maxT = std::numeric_limits<float>::lowest();
+            for (const auto &pixel: block) {
+                float t = 0.0f;
+                for (int c = 0; c < N; c++)
+                    t += (pixel[c] - mean[c]) * axis[c];
+                minT = std::min(minT, t);
+                maxT = std::max(maxT, t);
+            }
+        }
+
+        std::uint16_t PackRgb565(const std::array<float, 3> &color) {
+            const auto quantize = [](float value, int maximum) {
+                return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 255.0f) * maximum / 255.0f));
+            };
+            return static_cast<std::uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 |
+                                              quantize(color[2], 31));
+        }
+
+        std::array<int, 3> UnpackRgb565(std::uint16_t color) {
+            const int r = color >> 11 & 31;
+            const int g = color >> 5 & 63;
+            const int b = color & 31;
+            return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+        }
+
+        void WriteLittleEndian(std::byte *out, std::uint64_t value, int bytes) {
+            for (int i = 0; i < bytes; i++)
+                out[i] = static_cast<std::byte>(value >> (8 * i) & 0xff);
+        }
+
+        void EncodeBc1(const Block &block, std::byte *out) {
+            std::array<float, 3> mean{}, axis{};
+            PrincipalAxis<3>(block, mean, axis);
+            float minT, maxT;
+            ProjectExtents<3>(block, mean, axis, minT, maxT);
+
+            // Pull the endpoints in slightly; the extremes are rarely worth more than the interpolated colours.
+            const float inset = (maxT - minT) / 16.0f;
+            std::array<float, 3> high{}, low{};
+            for (int c = 0; c < 3; c++) {
+                high[c] = mean[c] + axis[c] * (maxT - inset);
+                low[c] = mean[c] + axis[c] * (minT + inset);
+            }
+
+            auto color0 = PackRgb565(high);
+            auto color1 = PackRgb565(low);
+            if (color0 < color1)
+                std::swap(color0, color1);
+
+            std::uint32_t indices = 0;
+            if (color0 != color1) {
+                const auto p0 = UnpackRgb565(color0);
+                const auto p1 = UnpackRgb565(color1);
+                std::array<std::array<int, 3>, 4> palette{p0, p1};
+                for (int c = 0; c < 3; c++) {
+                    palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+                    palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+                }
+
+                for (int i = 0; i < 16; i++) {
+                    int best = 0;
+                    int bestError = std::numeric_limits<int>::max();
+                    for (int candidate = 0; candidate < 4; candidate++) {
+                        int error = 0;
+                        for (int c = 0; c < 3; c++) {
+                            const int d = block[i][c] - palette[candidate][c];
+                            error += d * d;
+                        }
+                        if (error < bestError) {
+                            bestError = error;
+                            best = candidate;
+                        }
+                    }
+                    indices |= static_cast<std::uint32_t>(best) << (2 * i);
+                }
+            }
+
+            WriteLittleEndian(out, color0, 2);
+            WriteLittleEndian(out + 2, color1, 2);
+            WriteLittleEndian(out + 4, indices, 4);
+        }
+
+        void EncodeBc4(const std::array<std::uint8_t, 16> &values, std::byte *out) {
+            const auto [lowest, highest] = std::minmax_element(values.begin(), values.end());
+            const int a0 = *highest;
+            const int a1 = *lowest;
+
+            std::uint64_t indices = 0;
+            if (a0 != a1) {
+                std::array<int, 8> palette{a0, a1};
+                for (int i = 2; i < 8; i++)
+                    palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+
+                for (int i = 0; i < 16; i++) {
+                    int best = 0;
+                    for (int candidate = 1; candidate < 8; candidate++) {
+                        if (std::abs(values[i] - palette[candidate]) < std::abs(values[i] - palette[best]))
+                            best = candidate;
+                    }
+                    indices |= static_cast<std::uint64_t>(best) << (3 * i);
+                }
+            }
+
+            out[0] = static_cast<std::byte>(a0);
+            out[1] = static_cast<std::byte>(a1);
+            WriteLittleEndian(out + 2, indices, 6);
+        }
+
+        std::array<std::uint8_t, 16> Channel(const Block &block, int channel) {
+            std::array<std::uint8_t, 16> values{};
+            for (int i = 0; i < 16; i++)
+                values[i] = block[i][channel];
+            return values;
+        }
+
+        struct BitWriter {
+            std::byte *Out;
+            int Position = 0;
+
+            void Write(std::uint32_t value, int bits) {
+                for (int i = 0; i < bits; i++, Position++) {
+                    if (value >> i & 1)
+                        Out[Position >> 3] |= static_cast<std::byte>(1 << (Position & 7));
+                }
+            }
+        };
+
+        // Mode 6: one RGBA subset, 7-bit endpoints plus a p-bit each, 4-bit indices. Expects a zeroed output block.
+        void EncodeBc7(const Block &block, std::byte *out) {
+            std::array<float, 4> mean{}, axis{};
+            PrincipalAxis<4>(block, mean, axis);
+            float minT, maxT;
+            ProjectExtents<4>(block, mean, axis, minT, maxT);
+
+            std::array<std::array<float, 4>, 2> ends{};
+            for (int c = 0; c < 4; c++) {
+                ends[0][c] = mean[c] + axis[c] * minT;
+                ends[1][c] = mean[c] + axis[c] * maxT;
+            }
+
+            int bestError = std::numeric_limits<int>::max();
+            std::array<std::array<int, 4>, 2> bestEndpoints{};
+            std::array<int, 2> bestPBits{};
+            std::array<int, 16> bestIndices{};
+
+            for (int pBits = 0; pBits < 4; pBits++) {
+                const std::array<int, 2> p = {pBits & 1, pBits >> 1};
+                std::array<std::array<int, 4>, 2> endpoints{};
+                std::array<std::array<int, 4>, 2> expanded{};
+                for (int e = 0; e < 2; e++) {
+                    for (int c = 0; c < 4; c++) {
+                        endpoints[e][c] = std::clamp(static_cast<int>(std::lround((ends[e][c] - p[e]) / 2.0f)), 0, 127);
+                        expanded[e][c] = endpoints[e][c] << 1 | p[e];
+                    }
+                }
+
+                std::array<std::array<int, 4>, 16> palette{};
+                for (int i = 0; i < 16; i++) {
+                    for (int c = 0; c < 4; c++)
+                        palette[i][c] = ((64 - Bc7Weights[i]) * expanded[0][c] + Bc7Weights[i] * expanded[1][c] + 32) >> 6;
+                }
+
+                int totalError = 0;
+                std::array<int, 16> indices{};
+                for (int i = 0; i < 16; i++) {
+                    int bestPixelError = std::numeric_limits<int>::max();
+                    for (int candidate = 0; candidate < 16; candidate++) {
+                        int error = 0;
+                        for (int c = 0; c < 4; c++) {
+                            const int d = block[i][c] - palette[candidate][c];
+                            error += d * d;
+                        }
+                        if (error < bestPixelError) {
+                            bestPixelError = error;
+                            indices[i] = candidate;
+                        }
+                    }
+                    totalError += bestPixelError;
+                }
+
+                if (totalError < bestError) {
+                    bestError = totalError;
+                    bestEndpoints = endpoints;
+                    bestPBits = p;
+                    bestIndices = indices;
+                }
+            }
+
+            // The anchor index drops its top bit, so the first pixel must land in the lower half of the ramp.
+            if (bestIndices[0] >= 8) {
+                std::swap(bestEndpoints[0], bestEndpoints[1]);
+                std::swap(bestPBits[0], bestPBits[1]);
+                for (auto &index: bestIndices)
+                    index = 15 - index;
+            }
+
+            BitWriter writer{out};
+            writer.Write(1u << 6, 7);
+            for (int c = 0; c < 4; c++) {
+                writer.Write(bestEndpoints[0][c], 7);
+                writer.Write(bestEndpoints[1][c], 7);
+            }
+            writer.Write(bestPBits[0], 1);
+            writer.Write(bestPBits[1], 1);
+            writer.Write(bestIndices[0], 3);
+            for (int i = 1; i < 16; i++)
+                writer.Write(bestIndices[i], 4);
+        }
+
+        bool HasTranslucency(const Image &image) {
+            if (image.Channels != 4)
+                return false;
+            const auto pixels = image.Pixels();
+            const auto count = static_cast<std::size_t>(image.Width) * image.Height;
+            for (std::size_t i = 0; i < count; i++) {
+                if (pixels[i * 4 + 3] != 255)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    TextureCompression TextureCompressor::Resolve(TextureCompression requested, const Image &image) {
+        if (requested == TextureCompression::None || !image.IsValid())
+            return TextureCompression::None;
+
+        auto format = requested;
+        if (format == TextureCompression::Auto) {
+            if (image.Channels <= 2)
+                format = TextureCompression::BC5;
+            else if (HasTranslucency(image))
+                format = TextureCompression::BC7;
+            else
+                format = TextureCompression::BC1;
+        }
+
+        if (format == TextureCompression::BC7 && !GLExtensions::TextureCompressionBPTC)
+            format = TextureCompression::BC3;
+        if ((format == TextureCompression::BC1 || format == TextureCompression::BC3) &&
+            !GLExtensions::TextureCompressionS3TC)
+            return TextureCompression::None;
+        return format;
+    }
+
+    GLenum TextureCompressor::GLFormat(TextureCompression format, bool srgb) {
+        switch (format) {
+            case TextureCompression::BC1:
+                return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case TextureCompression::BC3:
+                return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case TextureCompression::BC5:
+                return GL_COMPRESSED_RG_RGTC2;
+            case TextureCompression::BC7:
+                return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+            default:
+                return GL_NONE;
+        }
+    }
+
+    std::size_t TextureCompressor::BlockBytes(TextureCompression format) {
+        return format == TextureCompression::BC1 ? 8 : 16;
+    }
+
+    std::size_t TextureCompressor::LevelBytes(TextureCompression format, int width, int height) {
+        return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format);
+    }
+
+    std::vector<MipLevel> TextureCompressor::BuildMipChain(const Image &image, bool srgb) {
+        // Mirrors Image::InternalFormat: only three and four channel images are treated as sRGB.
+        const bool linearize = srgb && image.Channels >= 3;
+        const auto &toLinear = SrgbToLinearTable();
+
+        MipLevel base{image.Width, image.Height, {}};
+        const auto count = static_cast<std::size_t>(image.Width) * image.Height;
+        base.Rgba.resize(count * 4);
+        const auto pixels = image.Pixels();
+        for (std::size_t i = 0; i < count; i++) {
+            const auto source = pixels + i * image.Channels;
+            auto target = &base.Rgba[i * 4];
+            target[0] = source[0];
+            target[1] = image.Channels >= 2 ? source[1] : 0;
+            target[2] = image.Channels >= 3 ? source[2] : 0;
+            target[3] = image.Channels == 4 ? source[3] : 255;
+        }
+
+        // Filter from a float copy of the previous level so rounding does not accumulate down the chain.
+        std::vector<float> current(count * 4);
+        for (std::size_t i = 0; i < count * 4; i++) {
+            const bool colour = (i & 3) != 3;
+            current[i] = linearize && colour ? toLinear[base.Rgba[i]] : base.Rgba[i] / 255.0f;
+        }
+
+        std::vector<MipLevel> levels;
+        levels.push_back(std::move(base));
+        int width = image.Width;
+        int height = image.Height;
+        while (width > 1 || height > 1) {
+            const int nextWidth = std::max(1, width / 2);
+            const int nextHeight = std::max(1, height / 2);
+            std::vector<float> next(static_cast<std::size_t>(nextWidth) * nextHeight * 4);
+            MipLevel level{nextWidth, nextHeight, std::vector<std::uint8_t>(next.size())};
+
+            for (int y = 0; y < nextHeight; y++) {
+                const int y0 = std::min(y * 2, height - 1);
+                const int y1 = std::min(y * 2 + 1, height - 1);
+                for (int x = 0; x < nextWidth; x++) {
+                    const int x0 = std::min(x * 2, width - 1);
+                    const int x1 = std::min(x * 2 + 1, width - 1);
+                    const auto target = (static_cast<std::size_t>(y) * nextWidth + x) * 4;
+                    for (int c = 0; c < 4; c++) {
+                        const auto at = [&](int sx, int sy) {
+                            return current[(static_cast<std::size_t>(sy) * width + sx) * 4 + c];
+                        };
+                        const float value = (at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1)) * 0.25f;
+                        next[target + c] = value;
+                        level.Rgba[target + c] = linearize && c != 3 ? LinearToSrgb(value) : ToUnorm8(value);
+                    }
+                }
+            }
+
+            levels.push_back(std::move(level));
+            current = std::move(next);
+            width = nextWidth;
+            height = nextHeight;
+        }
+        return levels;
+    }
+
+    std::vector<std::byte> TextureCompressor::Encode(const MipLevel &level, TextureCompression format) {
+        std::vector<std::byte> encoded(LevelBytes(format, level.Width, level.Height));
+        const int blocksX = (level.Width + 3) / 4;
+        const int blocksY = (level.Height + 3) / 4;
+        const auto blockBytes = BlockBytes(format);
+
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                const auto block = FetchBlock(level, bx, by);
+                const auto out = encoded.data() + (static_cast<std::size_t>(by) * blocksX + bx) * blockBytes;
+                switch (format) {
+                    case TextureCompression::BC1:
+                        EncodeBc1(block, out);
+                        break;
+                    case TextureCompression::BC3:
+                        EncodeBc4(Channel(block, 3), out);
+                        EncodeBc1(block, out + 8);
+                        break;
+                    case TextureCompression::BC5:
+                        EncodeBc4(Channel(block, 0), out);
+                        EncodeBc4(Channel(block, 1), out + 8);
+                        break;
+                    case TextureCompression::BC7:
+                        EncodeBc7(block, out);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        return encoded;
+    }
+}
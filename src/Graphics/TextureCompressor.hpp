@@ -0,0 +1,42 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "Image.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Graphics {
+    enum class TextureCompression : std::uint32_t {
+        None,
+        Auto,
+        BC1,
+        BC3,
+        BC5,
+        BC7
+    };
+
+    struct MipLevel {
+        int Width{};
+        int Height{};
+        std::vector<std::uint8_t> Rgba;
+    };
+
+    // CPU block encoder used when cooking textures. BC7 only emits mode 6, which covers RGBA with a single subset.
+    class TextureCompressor {
+    public:
+        // Picks the concrete format for an image and falls back when the driver lacks the requested one.
+        static TextureCompression Resolve(TextureCompression requested, const Image &image);
+
+        static GLenum GLFormat(TextureCompression format, bool srgb);
+
+        static std::size_t BlockBytes(TextureCompression format);
+
+        static std::size_t LevelBytes(TextureCompression format, int width, int height);
+
+        // Full chain down to 1x1. With srgb set, colour is averaged in linear space and re-encoded per level.
+        static std::vector<MipLevel> BuildMipChain(const Image &image, bool srgb);
+
+        static std::vector<std::byte> Encode(const MipLevel &level, TextureCompression format);
+    };
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "ShaderPermutation.hpp"
+#include "UniformId.hpp"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Graphics {
+    // CPU mirrors of the std140 blocks in LitShader.frag: vec3 and struct members start on 16 bytes, scalars pack
+    // into the tail of a preceding vec3.
+
+    struct DirectionalLightData {
+        alignas(16) glm::vec3 Direction;
+        alignas(16) glm::vec3 Ambient;
+        alignas(16) glm::vec3 Diffuse;
+        alignas(16) glm::vec3 Specular;
+    };
+
+    struct PointLightData {
+        alignas(16) glm::vec3 Position;
+        float Constant;
+        float Linear;
+        float Quadratic;
+        alignas(16) glm::vec3 Ambient;
+        alignas(16) glm::vec3 Diffuse;
+        alignas(16) glm::vec3 Specular;
+    };
+
+    struct SpotLightData {
+        alignas(16) glm::vec3 Position;
+        alignas(16) glm::vec3 Direction;
+        float CutOff;
+        float OuterCutOff;
+        float Constant;
+        float Linear;
+        float Quadratic;
+        alignas(16) glm::vec3 Ambient;
+        alignas(16) glm::vec3 Diffuse;
+        alignas(16) glm::vec3 Specular;
+    };
+
+    // Camera and scene-wide lights, bound once per frame.
+    struct FrameBlock {
+        static constexpr GLuint Binding = 1;
+
+        alignas(16) glm::vec3 CameraPosition;
+        DirectionalLightData DirLight;
+        SpotLightData SpotLight{};
+    };
+
+    // Point lights; only the first POINT_LIGHT_COUNT entries are uploaded.
+    struct LightBlock {
+        static constexpr GLuint Binding = 2;
+
+        PointLightData PointLights[ShaderPermutation::MaxPointLights];
+    };
+
+    // Per-material parameters, bound whenever the material changes.
+    struct MaterialBlock {
+        static constexpr GLuint Binding = 3;
+
+        alignas(16) float Shininess;
+    };
+
+    // One material of a MaterialTable, a uvec4 in both the std140 block and the std430 buffer.
+    struct MaterialEntry {
+        // Texture array << 16 | layer, or the low and high halves of a bindless handle.
+        std::uint32_t Diffuse[2];
+        float Shininess;
+        std::uint32_t Padding;
+    };
+
+    // Texture array locations of a model's materials, indexed by the per-draw material index.
+    struct MaterialTableBlock {
+        static constexpr GLuint Binding = 4;
+        static constexpr std::size_t MaxMaterials = 256;
+
+        MaterialEntry Entries[MaxMaterials];
+    };
+
+    static_assert(sizeof(DirectionalLightData) == 64 && sizeof(PointLightData) == 80 && sizeof(SpotLightData) == 96);
+    static_assert(offsetof(PointLightData, Constant) == 12 && offsetof(PointLightData, Ambient) == 32);
+    static_assert(offsetof(SpotLightData, CutOff) == 28 && offsetof(SpotLightData, Ambient) == 48);
+    static_assert(offsetof(FrameBlock, DirLight) == 16 && offsetof(FrameBlock, SpotLight) == 80);
+    static_assert(sizeof(FrameBlock) == 176 && sizeof(MaterialBlock) == 16 && sizeof(MaterialEntry) == 16);
+
+    struct UniformBlockMember {
+        UniformId Name;
+        std::size_t Offset;
+    };
+
+    // What Shader checks a reflected block of the same name against; a block may be smaller than its mirror when
+    // it ends in an array sized by a permutation.
+    struct UniformBlockLayout {
+        UniformId Name;
+        GLuint Binding;
+        std::size_t Size;
+        std::span<const UniformBlockMember> Members;
+    };
+
+    namespace UniformBlockLayouts {
+        inline constexpr UniformBlockMember FrameMembers[] = {
+                {"cameraPos", offsetof(FrameBlock, CameraPosition)},
+                {"dirLight.direction", offsetof(FrameBlock, DirLight) + offsetof(DirectionalLightData, Direction)},
+                {"dirLight.specular", offsetof(FrameBlock, DirLight) + offsetof(DirectionalLightData, Specular)},
+                {"spotLight.position", offsetof(FrameBlock, SpotLight) + offsetof(SpotLightData, Position)},
+                {"spotLight.quadratic", offsetof(FrameBlock, SpotLight) + offsetof(SpotLightData, Quadratic)},
+                {"spotLight.specular", offsetof(FrameBlock, SpotLight) + offsetof(SpotLightData, Specular)},
+        };
+
+        inline constexpr UniformBlockMember LightMembers[] = {
+                {"pointLights[0].position", offsetof(PointLightData, Position)},
+                {"pointLights[0].quadratic", offsetof(PointLightData, Quadratic)},
+                {"pointLights[0].specular", offsetof(PointLightData, Specular)},
+                {"pointLights[1].position", sizeof(PointLightData) + offsetof(PointLightData, Position)},
+        };
+
+        inline constexpr UniformBlockMember MaterialMembers[] = {
+                {"shininess", offsetof(MaterialBlock, Shininess)},
+        };
+
+        inline constexpr UniformBlockMember MaterialTableMembers[] = {
+                {"materialEntries[0]", 0},
+                {"materialEntries[1]", sizeof(MaterialEntry)},
+        };
+
+        inline constexpr UniformBlockLayout All[] = {
+                {"Frame", FrameBlock::Binding, sizeof(FrameBlock), FrameMembers},
+                {"Lights", LightBlock::Binding, sizeof(LightBlock), LightMembers},
+                {"MaterialParameters", MaterialBlock::Binding, sizeof(MaterialBlock), MaterialMembers},
+                {"MaterialTable", MaterialTableBlock::Binding, sizeof(MaterialTableBlock), MaterialTableMembers},
+        };
+    }
+}
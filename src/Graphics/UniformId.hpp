@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Core/Hash.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Graphics {
+    // Hashed uniform name. String literals convert at compile time, so setters neither allocate nor query the
+    // driver; names only known at runtime go through FromName or Element.
+    struct UniformId {
+        std::uint64_t Hash{};
+
+        template<std::size_t N>
+        consteval UniformId(const char (&name)[N]) : Hash(Core::Hash::Fnv1a(std::string_view(name, N - 1))) {
+        }
+
+        static constexpr UniformId FromName(std::string_view name) {
+            UniformId id;
+            id.Hash = Core::Hash::Fnv1a(name);
+            return id;
+        }
+
+        // "array[index].member", or "array[index]" without a member, hashed without building the string.
+        static constexpr UniformId Element(std::string_view array, std::size_t index, std::string_view member = {}) {
+            char digits[20]{};
+            std::size_t first = sizeof(digits);
+            do {
+                digits[--first] = static_cast<char>('0' + index % 10);
+                index /= 10;
+            } while (index != 0);
+
+            auto hash = Core::Hash::Fnv1a(array);
+            hash = Core::Hash::Fnv1a("[", hash);
+            hash = Core::Hash::Fnv1a(std::string_view(digits + first, sizeof(digits) - first), hash);
+            hash = Core::Hash::Fnv1a("]", hash);
+            if (!member.empty()) {
+                hash = Core::Hash::Fnv1a(".", hash);
+                hash = Core::Hash::Fnv1a(member, hash);
+            }
+            UniformId id;
+            id.Hash = hash;
+            return id;
+        }
+
+        constexpr bool operator==(const UniformId &) const = default;
+
+    private:
+        constexpr UniformId() = default;
+    };
+}
@@ -0,0 +1,83 @@
+#include "UniformRing.hpp"
+#include "RenderState.hpp"
+#include "Log.hpp"
+#include <algorithm>
+
+namespace Graphics {
+
+    UniformRing &UniformRing::Shared() {
+        static UniformRing ring;
+        return ring;
+    }
+
+    void UniformRing::BeginFrame() {
+        if (_buffer == 0) {
+            GLint alignment = 0;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            _alignment = static_cast<std::size_t>(std::max(alignment, 1));
+            Allocate(MinSegmentSize);
+        }
+        if (!_retired.empty()) {
+            for (const auto buffer: _retired)
+                RenderState::Shared().DeleteBuffer(buffer);
+            _retired.clear();
+        }
+
+        _frame = (_frame + 1) % FrameCount;
+        _head = 0;
+        if (auto &fence = _fences[_frame]) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    void UniformRing::EndFrame() {
+        if (_buffer == 0)
+            return;
+        if (_fences[_frame])
+            glDeleteSync(_fences[_frame]);
+        _fences[_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void UniformRing::Bind(GLuint binding, const void *data, std::size_t size) {
+        if (_buffer == 0)
+            BeginFrame();
+        if (_head + size > _segmentSize) {
+            auto segmentSize = _segmentSize * 2;
+            while (segmentSize < size)
+                segmentSize *= 2;
+            Log::Information(fmt::format("UNIFORM_RING::GROW {} KiB per frame", segmentSize / 1024));
+            Allocate(segmentSize);
+        }
+
+        const auto offset = _frame * _segmentSize + _head;
+        RenderState::Shared().BindBuffer(GL_UNIFORM_BUFFER, _buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, _buffer, static_cast<GLintptr>(offset),
+                          static_cast<GLsizeiptr>(size));
+        _head += (size + _alignment - 1) / _alignment * _alignment;
+    }
+
+    std::size_t UniformRing::Used() const {
+        return _head;
+    }
+
+    void UniformRing::Allocate(std::size_t segmentSize) {
+        if (_buffer != 0)
+            _retired.push_back(_buffer);
+        glGenBuffers(1, &_buffer);
+
+        _segmentSize = (segmentSize + _alignment - 1) / _alignment * _alignment;
+        RenderState::Shared().BindBuffer(GL_UNIFORM_BUFFER, _buffer);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(_segmentSize * FrameCount), nullptr, GL_STREAM_DRAW);
+
+        // Fresh storage has nothing in flight.
+        for (auto &fence: _fences) {
+            if (fence)
+                glDeleteSync(fence);
+            fence = nullptr;
+        }
+        _head = 0;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Graphics {
+    // Streams uniform blocks through one buffer split into a segment per frame in flight. Each bind copies the block
+    // to the head of the current segment and binds that range, so blocks are never rewritten while a queued draw
+    // may still read them; a fence per segment holds the CPU back when it runs FrameCount frames ahead. A segment
+    // that fills up mid-frame doubles the buffer. GL thread only.
+    class UniformRing {
+    public:
+        static constexpr std::size_t FrameCount = 3;
+
+        UniformRing(const UniformRing &) = delete;
+
+        UniformRing &operator=(const UniformRing &) = delete;
+
+        static UniformRing &Shared();
+
+        // Waits until the GPU is done with the segment this frame reuses.
+        void BeginFrame();
+
+        void EndFrame();
+
+        void Bind(GLuint binding, const void *data, std::size_t size);
+
+        template<typename Block>
+        void Bind(const Block &block) {
+            Bind(Block::Binding, &block, sizeof(Block));
+        }
+
+        // Binds the leading elements only, for blocks ending in an array sized per shader.
+        template<typename Element>
+        void Bind(GLuint binding, std::span<const Element> elements) {
+            Bind(binding, elements.data(), elements.size_bytes());
+        }
+
+        // Bytes bound so far this frame.
+        [[nodiscard]] std::size_t Used() const;
+
+    private:
+        static constexpr std::size_t MinSegmentSize = 64 * 1024;
+
+        GLuint _buffer{};
+        std::size_t _alignment = 256;
+        std::size_t _segmentSize = 0;
+        std::size_t _frame = 0;
+        std::size_t _head = 0;
+        std::array<GLsync, FrameCount> _fences{};
+        // Replaced buffers stay alive until the frame that still has ranges of them bound is over.
+        std::vector<GLuint> _retired;
+
+        UniformRing() = default;
+
+        // Moves to a new buffer; blocks bound earlier this frame keep pointing at the old one.
+        void Allocate(std::size_t segmentSize);
+    };
+}
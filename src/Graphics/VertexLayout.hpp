@@ -0,0 +1,99 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace Graphics {
+
+    // IEEE 754 binary16, stored for GL_HALF_FLOAT attributes.
+    struct Half {
+        std::uint16_t Bits{};
+
+        // Defined in Mesh.cpp, so glm's packing header stays out of every includer.
+        static Half FromFloat(float value);
+    };
+
+    template<typename T>
+    struct AttributeComponent;
+
+    template<>
+    struct AttributeComponent<float> {
+        static constexpr GLenum Type = GL_FLOAT;
+    };
+
+    template<>
+    struct AttributeComponent<Half> {
+        static constexpr GLenum Type = GL_HALF_FLOAT;
+    };
+
+    template<>
+    struct AttributeComponent<std::int8_t> {
+        static constexpr GLenum Type = GL_BYTE;
+    };
+
+    template<>
+    struct AttributeComponent<std::uint8_t> {
+        static constexpr GLenum Type = GL_UNSIGNED_BYTE;
+    };
+
+    template<>
+    struct AttributeComponent<std::int16_t> {
+        static constexpr GLenum Type = GL_SHORT;
+    };
+
+    template<>
+    struct AttributeComponent<std::uint16_t> {
+        static constexpr GLenum Type = GL_UNSIGNED_SHORT;
+    };
+
+    template<typename T>
+    struct AttributeTraits;
+
+    template<glm::length_t N, typename T, glm::qualifier Q>
+    struct AttributeTraits<glm::vec<N, T, Q>> {
+        using Component = T;
+        static constexpr GLint Count = N;
+    };
+
+    template<typename T, std::size_t N>
+    struct AttributeTraits<std::array<T, N>> {
+        using Component = T;
+        static constexpr GLint Count = static_cast<GLint>(N);
+    };
+
+    // One shader input bound to a vertex struct member; component type, count and offset come from the member.
+    template<GLuint Location, auto Member, bool Normalized = false>
+    struct Attribute;
+
+    template<GLuint Location, typename V, typename M, M V::*Member, bool Normalized>
+    struct Attribute<Location, Member, Normalized> {
+        using VertexType = V;
+
+        static void Apply() {
+            using Traits = AttributeTraits<M>;
+            static const V probe{};
+            const auto offset = reinterpret_cast<const char *>(&(probe.*Member)) -
+                                reinterpret_cast<const char *>(&probe);
+
+            glEnableVertexAttribArray(Location);
+            glVertexAttribPointer(Location, Traits::Count, AttributeComponent<typename Traits::Component>::Type,
+                                  Normalized ? GL_TRUE : GL_FALSE, sizeof(V), reinterpret_cast<const void *>(offset));
+        }
+    };
+
+    // Applies every attribute to the bound VAO and GL_ARRAY_BUFFER, with the vertex struct as the stride.
+    template<typename First, typename... Rest>
+    struct VertexLayout {
+        using VertexType = typename First::VertexType;
+        static_assert((std::is_same_v<VertexType, typename Rest::VertexType> && ...),
+                      "All attributes of a layout must describe the same vertex type");
+
+        static void Apply() {
+            First::Apply();
+            (Rest::Apply(), ...);
+        }
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Core/Entity.hpp"
+#include "Graphics/Mesh.hpp"
+#include "Graphics/RenderState.hpp"
 #include "Graphics/Shader.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "Core/PointLight.hpp"
@@ -21,33 +23,24 @@ public:
 
 
         glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(LightCube::Vertices), LightCube::Vertices, GL_DYNAMIC_DRAW);
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), nullptr);
-        glEnableVertexAttribArray(0);
+        Graphics::StandardLayout::Apply();
 
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(5 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
     }
 
     void Render(Graphics::Shader &shader) override {
         shader.Use();
         shader.SetMat4("model", Model);
 
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glBindVertexArray(0);
     }
 
     constexpr const static float Vertices[288] = {
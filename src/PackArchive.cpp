@@ -0,0 +1,103 @@
+#include "PackArchive.hpp"
+#include "Core/Lz4.hpp"
+#include "Log.hpp"
+#include <cstring>
+#include <vector>
+
+std::shared_ptr<PackArchive> PackArchive::Load(const std::string &packPath) {
+    std::shared_ptr<PackArchive> pack(new PackArchive());
+    pack->_file = FileView::Map(packPath);
+    if (!pack->_file.IsOpen())
+        return nullptr;
+    if (!pack->Parse()) {
+        Log::Error("PACK::INVALID {}", packPath);
+        return nullptr;
+    }
+    Log::Information(fmt::format("PACK {} entries {}", packPath, pack->_entries.size()));
+    return pack;
+}
+
+bool PackArchive::Parse() {
+    using namespace PackFormat;
+    const auto bytes = _file.Data();
+    if (bytes.size() < sizeof(Header))
+        return false;
+
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    const auto fits = [&](std::uint64_t offset, std::uint64_t count, std::size_t size) {
+        return offset <= bytes.size() && count <= (bytes.size() - offset) / size;
+    };
+    if (header.Magic != Magic || header.Version != Version || header.BucketCount == 0 ||
+        (header.BucketCount & (header.BucketCount - 1)) != 0 || header.BucketCount < header.EntryCount ||
+        header.EntriesOffset % alignof(Entry) != 0 || header.BucketsOffset % alignof(std::uint32_t) != 0 ||
+        !fits(header.EntriesOffset, header.EntryCount, sizeof(Entry)) ||
+        !fits(header.BucketsOffset, header.BucketCount, sizeof(std::uint32_t)) ||
+        !fits(header.NamesOffset, header.NamesSize, 1))
+        return false;
+
+    _entries = {reinterpret_cast<const Entry *>(bytes.data() + header.EntriesOffset), header.EntryCount};
+    _buckets = {reinterpret_cast<const std::uint32_t *>(bytes.data() + header.BucketsOffset), header.BucketCount};
+    _names = {reinterpret_cast<const char *>(bytes.data() + header.NamesOffset),
+              static_cast<std::size_t>(header.NamesSize)};
+
+    for (const auto &entry: _entries) {
+        if (!fits(entry.Offset, entry.StoredSize, 1) || entry.NameOffset > _names.size() ||
+            entry.NameLength > _names.size() - entry.NameOffset ||
+            (entry.Compression == Codec::None && entry.StoredSize != entry.Size) ||
+            (entry.Compression != Codec::None && entry.Compression != Codec::Lz4))
+            return false;
+    }
+    for (const auto bucket: _buckets) {
+        if (bucket > _entries.size())
+            return false;
+    }
+    return true;
+}
+
+FileView PackArchive::Open(const std::string &path) const {
+    const auto *entry = Find(path);
+    return entry ? Open(*entry) : FileView{};
+}
+
+FileView PackArchive::Open(const PackFormat::Entry &entry) const {
+    const auto stored = _file.Slice(entry.Offset, entry.StoredSize);
+    if (entry.Compression == PackFormat::Codec::None)
+        return stored;
+
+    auto bytes = std::make_shared<std::vector<std::byte>>(entry.Size);
+    if (!Core::Lz4::Decompress(stored.Data(), *bytes)) {
+        const auto name = Name(entry);
+        Log::Error("PACK::CORRUPT_ENTRY {}", name);
+        return {};
+    }
+    const std::span<const std::byte> data(*bytes);
+    return {std::move(bytes), data};
+}
+
+bool PackArchive::Exists(const std::string &path) const {
+    return Find(path) != nullptr;
+}
+
+std::span<const PackFormat::Entry> PackArchive::Entries() const {
+    return _entries;
+}
+
+std::string_view PackArchive::Name(const PackFormat::Entry &entry) const {
+    return _names.substr(entry.NameOffset, entry.NameLength);
+}
+
+const PackFormat::Entry *PackArchive::Find(std::string_view path) const {
+    const auto hash = PackFormat::HashPath(path);
+    const auto mask = _buckets.size() - 1;
+    for (auto bucket = hash & mask, probes = std::uint64_t{0}; probes < _buckets.size();
+         bucket = (bucket + 1) & mask, probes++) {
+        const auto slot = _buckets[bucket];
+        if (slot == 0)
+            return nullptr;
+        const auto &entry = _entries[slot - 1];
+        if (entry.PathHash == hash && Name(entry) == path)
+            return &entry;
+    }
+    return nullptr;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FileSystem.hpp"
+#include "Core/Hash.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Resource pack layout: a header, entry data in load order (each entry 16-byte aligned), then the entry table,
+// an open-addressed hash table over it and the entry names. Written by tools/pack.
+namespace PackFormat {
+    constexpr std::uint32_t Magic = 0x4b415043; // "CPAK"
+    constexpr std::uint32_t Version = 1;
+    constexpr std::size_t Alignment = 16;
+
+    enum class Codec : std::uint32_t {
+        None,
+        Lz4
+    };
+
+    struct Header {
+        std::uint32_t Magic;
+        std::uint32_t Version;
+        std::uint32_t EntryCount;
+        // Power of two; each bucket holds an entry index plus one, zero when empty, probed linearly.
+        std::uint32_t BucketCount;
+        std::uint64_t EntriesOffset;
+        std::uint64_t BucketsOffset;
+        std::uint64_t NamesOffset;
+        std::uint64_t NamesSize;
+    };
+
+    struct Entry {
+        std::uint64_t PathHash;
+        std::uint64_t Offset;
+        std::uint64_t StoredSize;
+        std::uint64_t Size;
+        std::uint32_t NameOffset;
+        std::uint32_t NameLength;
+        Codec Compression;
+        std::uint32_t Reserved;
+    };
+
+    inline std::uint64_t HashPath(std::string_view path) {
+        return Core::Hash::Fnv1a(path);
+    }
+}
+
+// A pack mapped once; stored entries are views into the mapping, compressed ones are inflated per open.
+class PackArchive final : public FileSource {
+public:
+    // Returns nullptr when the file is missing; logs PACK::INVALID when it is not a readable pack.
+    static std::shared_ptr<PackArchive> Load(const std::string &packPath);
+
+    [[nodiscard]] FileView Open(const std::string &path) const override;
+
+    [[nodiscard]] bool Exists(const std::string &path) const override;
+
+    [[nodiscard]] std::span<const PackFormat::Entry> Entries() const;
+
+    [[nodiscard]] std::string_view Name(const PackFormat::Entry &entry) const;
+
+    [[nodiscard]] FileView Open(const PackFormat::Entry &entry) const;
+
+private:
+    FileView _file;
+    std::span<const PackFormat::Entry> _entries;
+    std::span<const std::uint32_t> _buckets;
+    std::string_view _names;
+
+    PackArchive() = default;
+
+    bool Parse();
+
+    [[nodiscard]] const PackFormat::Entry *Find(std::string_view path) const;
+};
@@ -5,6 +5,8 @@
 #include "LightCube.hpp"
 
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Core/Skybox.hpp"
 #include "Graphics/Model.hpp"
 #include "Cube.hpp"
@@ -70,10 +72,10 @@ public:
         LitShader->Use();
 
         glGenVertexArrays(1, &VegetationVAO);
-        glBindVertexArray(VegetationVAO);
+        Graphics::RenderState::Shared().BindVertexArray(VegetationVAO);
 
         glGenBuffers(1, &VegetationVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VegetationVBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VegetationVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(VegetationVertices), &VegetationVertices[0], GL_DYNAMIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
@@ -84,7 +86,7 @@ public:
 
         glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void *) (sizeof(float) * 5));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
 
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -105,19 +107,15 @@ public:
         Skybox.Render();
 
         LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
+        uniforms.Bind(Graphics::MaterialBlock{32.0f});
 
         LitShader->SetTexture("material.texture_diffuse1", TerrainGrassTexture);
         GrassPlane.Update(deltaTime);
         GrassPlane.Render(*LitShader);
 
-        glBindVertexArray(VegetationVAO);
+        Graphics::RenderState::Shared().BindVertexArray(VegetationVAO);
         LitShader->SetTexture("material.texture_diffuse1", GrassTexture);
         for (auto i: vegetation) {
             auto model = glm::mat4(1.0f);
@@ -125,7 +123,6 @@ public:
             LitShader->SetMat4("model", model);
             glDrawArrays(GL_TRIANGLES, 0, 6);
         }
-        glBindVertexArray(0);
 
 
         ReflectionShader->Use();
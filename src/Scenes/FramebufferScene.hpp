@@ -6,6 +6,8 @@
 #include <sstream>
 
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Plane.hpp"
 #include "Cube.hpp"
 #include <memory>
@@ -53,10 +55,10 @@ public:
     FramebufferScene() {
         DirectionalLight.Ambient = glm::vec3(0.2, 0.2, 0.2);
         glGenVertexArrays(1, &VegetationVAO);
-        glBindVertexArray(VegetationVAO);
+        Graphics::RenderState::Shared().BindVertexArray(VegetationVAO);
 
         glGenBuffers(1, &VegetationVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VegetationVBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VegetationVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vegetationVertices), &vegetationVertices[0], GL_DYNAMIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
@@ -67,7 +69,7 @@ public:
 
         glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void *) (sizeof(float) * 5));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
 
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -82,10 +84,10 @@ public:
         }
 
         glGenFramebuffers(1, &FBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, FBO);
 
         glGenTextures(1, &TexColorBuffer);
-        glBindTexture(GL_TEXTURE_2D, TexColorBuffer);
+        Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_2D, TexColorBuffer);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2560, 1440, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -99,43 +101,39 @@ public:
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
             Log::Information("FRAMEBUFFER: Framebuffer is not complete!");
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
         glGenVertexArrays(1, &ScreenVAO);
         glGenBuffers(1, &ScreenVBO);
-        glBindVertexArray(ScreenVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(ScreenVertices), &ScreenVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *) (2 * sizeof(float)));
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
     }
 
     void Show(const float deltaTime, [[maybe_unused]] const float currentTime, Camera &camera) {
         DirectionalLight.UIRender();
 
         // first pass
-        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, FBO);
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
+        Graphics::RenderState::Shared().Enable(GL_DEPTH_TEST);
 
         LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
+        uniforms.Bind(Graphics::MaterialBlock{32.0f});
 
         LitShader->SetTexture("material.texture_diffuse1", TerrainGrassTexture);
         Plane.Update(deltaTime);
         Plane.Render(*LitShader);
 
-        glBindVertexArray(VegetationVAO);
+        Graphics::RenderState::Shared().BindVertexArray(VegetationVAO);
         LitShader->SetTexture("material.texture_diffuse1", GrassTexture);
         for (auto i: vegetation) {
             auto model = glm::mat4(1.0f);
@@ -143,20 +141,18 @@ public:
             LitShader->SetMat4("model", model);
             glDrawArrays(GL_TRIANGLES, 0, 6);
         }
-        glBindVertexArray(0);
 
         // second pass
-        glBindFramebuffer(GL_FRAMEBUFFER, 0); // back to default
-        glDisable(GL_DEPTH_TEST);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0); // back to default
+        Graphics::RenderState::Shared().Disable(GL_DEPTH_TEST);
 
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glBindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
         Shader->Use();
         Shader->SetInt("screenTexture", 0);
-        glBindTexture(GL_TEXTURE_2D, TexColorBuffer);
+        Graphics::RenderState::Shared().BindTexture(0, GL_TEXTURE_2D, TexColorBuffer);
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
     }
 };
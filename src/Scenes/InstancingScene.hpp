@@ -5,8 +5,15 @@
 #include "LightCube.hpp"
 
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Core/Skybox.hpp"
 #include "Graphics/Model.hpp"
+#include "Core/OcclusionBuffer.hpp"
+#include "Graphics/DepthPyramid.hpp"
+#include "Graphics/InstanceLodBatch.hpp"
+#include "Graphics/RenderView.hpp"
+#include "Graphics/ShaderVariants.hpp"
 #include "PerlinNoise.hpp"
 
 #include <sstream>
@@ -17,15 +24,7 @@
 class InstancingScene {
 public:
     Core::DirectionalLight DirectionalLight;
-    std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
-            "VertexShader.vert",
-            "LitShader.frag"
-    );
-
-    std::shared_ptr<Graphics::Shader> InstancingLitShader = std::make_shared<Graphics::Shader>(
-            "InstancingShader.vert",
-            "LitShader.frag"
-    );
+    Graphics::ShaderVariants LitShaders = Graphics::ShaderVariants("VertexShader.vert", "LitShader.frag");
 
     Core::Skybox Skybox = Core::Skybox(std::vector<std::string>{
             "resources/textures/skybox/space/right.png",
@@ -46,6 +45,12 @@ public:
     const siv::PerlinNoise perlin{seed};
 
     unsigned int VBO{};
+    Graphics::InstanceLodBatch RockLods;
+
+    // Last frame's depth of the planet, reprojected each frame to cull the planet on the GPU and the rocks on the
+    // CPU. The rocks orbit, so they are drawn after the capture and never occlude.
+    Graphics::DepthPyramid Pyramid;
+    Core::OcclusionBuffer Occlusion;
 
     InstancingScene() {
         DirectionalLight.Direction = glm::vec3(-0.2, -1, -1);
@@ -55,30 +60,8 @@ public:
         srand(glfwGetTime());
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, Amount * sizeof(glm::mat4), &ModelMatrices[0], GL_DYNAMIC_DRAW);
-
-        for (auto &Mesh: Rock.Meshes) {
-            unsigned int VAO = Mesh.VAO;
-            glBindVertexArray(VAO);
-
-            std::size_t vec4Size = sizeof(glm::vec4);
-            glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, nullptr);
-            glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *) (1 * vec4Size));
-            glEnableVertexAttribArray(5);
-            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *) (2 * vec4Size));
-            glEnableVertexAttribArray(6);
-            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *) (3 * vec4Size));
-
-            glVertexAttribDivisor(3, 1);
-            glVertexAttribDivisor(4, 1);
-            glVertexAttribDivisor(5, 1);
-            glVertexAttribDivisor(6, 1);
-
-            glBindVertexArray(0);
-        }
     }
 
     void Show(const float deltaTime, [[maybe_unused]] const float currentTime, Camera &camera) {
@@ -86,27 +69,26 @@ public:
 
         Skybox.Render();
 
-        LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
+        auto view = Graphics::RenderView::FromCamera(camera);
+        const auto viewProjection = camera.GetCameraMatrix();
+        if (Pyramid.Reproject(viewProjection))
+            view.Pyramid = &Pyramid;
+        if (Pyramid.ReprojectInto(Occlusion, viewProjection))
+            view.Occluders = &Occlusion;
+
+        auto &litShader = LitShaders.Get({});
+        auto &instancedLitShader = LitShaders.Get({.Instanced = true});
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
+        uniforms.Bind(Graphics::MaterialBlock{32.0f});
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
         model = glm::scale(model, glm::vec3(4.0f, 4.0f, 4.0f));
-        LitShader->SetMat4("model", model);
-        Planet.Draw(*LitShader);
-
-        InstancingLitShader->Use();
-        InstancingLitShader->SetVec3("cameraPos", camera.Position);
-        InstancingLitShader->SetFloat("material.shininess", 32.0f);
-        InstancingLitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        InstancingLitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        InstancingLitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        InstancingLitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
+        litShader.Use();
+        litShader.SetMat4("model", model);
+        Planet.Draw(litShader, view, model);
+        Pyramid.Capture(viewProjection);
 
         float radius = 100.0;
         float offset = 25.0f;
@@ -139,20 +121,25 @@ public:
                     ModelMatrices[i] = model;
                 });
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        const auto sorted = RockLods.Sort(
+                view,
+                std::span(ModelMatrices, Amount),
+                Rock.BoundsCenter(),
+                Rock.BoundsRadius()
+        );
+
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferSubData(
                 GL_ARRAY_BUFFER,
                 0,
-                Amount * sizeof(glm::mat4),
-                &ModelMatrices[0]
+                static_cast<GLsizeiptr>(sorted.size_bytes()),
+                sorted.data()
         );
 
-        InstancingLitShader->Use();
+        instancedLitShader.Use();
         for (auto &Meshe: Rock.Meshes) {
-            glBindVertexArray(Meshe.VAO);
-            glDrawElementsInstanced(
-                    GL_TRIANGLES, Meshe.Indices.size(), GL_UNSIGNED_INT, 0, Amount
-            );
+            Rock.Materials[Meshe.MaterialIndex].Bind(instancedLitShader);
+            RockLods.Draw(Meshe, VBO);
         }
 //
 //        for (unsigned int i = 0; i < Amount; i++) {
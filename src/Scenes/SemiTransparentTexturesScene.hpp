@@ -6,22 +6,27 @@
 #include <sstream>
 
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Plane.hpp"
 #include <memory>
 #include <random>
-#include <map>
 
 class SemiTransparentTexturesScene {
 public:
     unsigned int VAO{}, VBO{};
     Core::DirectionalLight DirectionalLight;
-    std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>("VertexShader.vert",
-                                                                                     "LitShader.frag");
+    std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
+            "VertexShader.vert", "LitShader.frag", Graphics::ShaderPermutation{.AlphaTest = true});
     Graphics::Texture TerrainGrassTexture = Graphics::Texture("resources/textures/TerrainGrassTexture.jpg", GL_RGB, GL_TEXTURE0);
     Graphics::Texture WindowTexture = Graphics::Texture("resources/textures/blending_transparent_window.png", GL_RGBA, GL_TEXTURE1);
+    Graphics::Material TerrainGrassMaterial = Graphics::Material({TerrainGrassTexture.GetId()});
+    Graphics::Material WindowMaterial = Graphics::Material({WindowTexture.GetId()});
 
     Plane Plane;
     std::vector<glm::vec3> Windows;
+    Graphics::RenderQueue Queue;
 
     float Vertices[48] = {
             0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0, 1,
@@ -34,18 +39,18 @@ public:
     };
 
     SemiTransparentTexturesScene() {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        Graphics::RenderState::Shared().Enable(GL_BLEND);
+        Graphics::RenderState::Shared().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         DirectionalLight.Ambient = glm::vec3(0.2, 0.2, 0.2);
 
         LitShader->Use();
 
         glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
+        Graphics::RenderState::Shared().BindVertexArray(VAO);
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(Vertices), &Vertices[0], GL_DYNAMIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
@@ -56,7 +61,7 @@ public:
 
         glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void *) (sizeof(float) * 5));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        Graphics::RenderState::Shared().BindVertexArray(0);
 
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -70,43 +75,31 @@ public:
             Windows.emplace_back(randomX, 0.0f, randomZ);
         }
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        Graphics::RenderState::Shared().Enable(GL_BLEND);
+        Graphics::RenderState::Shared().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
 
     void Show(const float deltaTime, [[maybe_unused]] const float currentTime, Camera &camera) {
         DirectionalLight.UIRender();
 
         LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
 
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
-
-        LitShader->SetTexture("material.texture_diffuse1", TerrainGrassTexture);
+        Queue.Reset(camera.Position);
         Plane.Update(deltaTime);
-        Plane.Render(*LitShader);
-
-        std::map<float, glm::vec3> sortedWindows;
-        for (auto Window: Windows) {
-            float distance = glm::length(camera.Position - Window);
-            sortedWindows[distance] = Window;
+        auto plane = Plane.Packet();
+        plane.Program = LitShader.get();
+        plane.Material = &TerrainGrassMaterial;
+        Queue.Submit(plane);
+
+        for (const auto &window: Windows) {
+            Queue.Submit({.Pass = Graphics::RenderPass::Transparent, .Program = LitShader.get(),
+                          .Material = &WindowMaterial, .VertexArray = VAO, .Count = 6,
+                          .Transform = glm::translate(glm::mat4(1.0f), window)});
         }
 
-        glBindVertexArray(VAO);
-        LitShader->SetTexture("material.texture_diffuse1", WindowTexture);
-        for (auto it = sortedWindows.rbegin(); it != sortedWindows.rend(); ++it) {
-            float distance = it->first;
-            glm::vec3 window = it->second;
-
-            auto model = glm::mat4(1.0f);
-            model = glm::translate(model, window);
-            LitShader->SetMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-        }
-        glBindVertexArray(0);
+        Queue.Execute(Graphics::RenderPass::Opaque);
+        Queue.Execute(Graphics::RenderPass::Transparent);
     }
 };
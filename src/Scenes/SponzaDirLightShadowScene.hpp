@@ -3,7 +3,11 @@
 #include "LightCube.hpp"
 #include "Camera.hpp"
 #include "Graphics/Model.hpp"
+#include "Graphics/RenderView.hpp"
+#include "Graphics/ShaderVariants.hpp"
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
 #include <sstream>
@@ -14,11 +18,10 @@ public:
 
     std::shared_ptr<Graphics::Shader> LightSourceShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert", "LightSourceShader.frag");
-    std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
-            "VertexShader.vert", "LitShader.frag");
+    Graphics::ShaderVariants LitShaders = Graphics::ShaderVariants("VertexShader.vert", "LitShader.frag");
 
 
-    Graphics::Model Sponza = Graphics::Model("resources/models/sponza/sponza.obj");
+    std::shared_ptr<Graphics::Model> Sponza = Graphics::Model::LoadAsync("resources/models/sponza/sponza.obj");
 
     const unsigned int SHADOW_WIDTH = 2560, SHADOW_HEIGHT = 1440;
     const unsigned int WINDOW_WIDTH = 2560, WINDOW_HEIGHT = 1440;
@@ -43,6 +46,7 @@ public:
     Graphics::Model SunModel = Graphics::Model("resources/models/Sun.glb");
 
     SponzaDirLightShadowScene() {
+        Sponza->Shininess = 2.0f;
         DirectionalLight.Ambient = {0.1, 0.1, 0.1};
         DirectionalLight.Diffuse = {0.7, 0.7, 0.7};
         DirectionalLight.Specular = {0.5, 0.5, 0.5};
@@ -50,7 +54,7 @@ public:
         glGenFramebuffers(1, &depthMapFBO);
 
         glGenTextures(1, &depthMapTexture);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
+        Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_2D, depthMapTexture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT,
                      nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -60,16 +64,16 @@ public:
         float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
         glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMapTexture, 0);
         glDrawBuffer(GL_NONE);
         glReadBuffer(GL_NONE);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
         glGenVertexArrays(1, &ScreenVAO);
         glGenBuffers(1, &ScreenVBO);
-        glBindVertexArray(ScreenVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(ScreenVertices), &ScreenVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), nullptr);
@@ -77,14 +81,14 @@ public:
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) (3 * sizeof(float)));
     }
 
-    void RenderScene(float deltaTime, [[maybe_unused]]float currentTime, Graphics::Shader &shader) {
+    void RenderScene(float deltaTime, [[maybe_unused]]float currentTime, Graphics::Shader &shader,
+                     const Graphics::RenderView &view) {
         shader.Use();
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::scale(model, glm::vec3(0.1f));
         shader.SetMat4("model", model);
-        shader.SetFloat("material.shininess", 2.0f);
-        Sponza.Draw(*LitShader);
+        Sponza->Draw(shader, view, model);
     }
 
 
@@ -118,30 +122,33 @@ public:
         glm::mat4 lightView = glm::lookAt(eyePosition, glm::vec3(0), glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 lightSpaceMatrix = lightProjection * lightView;
 
+        const auto view = Graphics::RenderView::FromCamera(camera);
+        auto shadowView = view;
+        shadowView.Frustum = Core::Frustum::FromMatrix(lightSpaceMatrix);
+        shadowView.BackfaceCulling = false;
+
         DepthShader->Use();
         DepthShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        Graphics::RenderState::Shared().Viewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glClear(GL_DEPTH_BUFFER_BIT);
-        glCullFace(GL_FRONT);
-        RenderScene(deltaTime, currentTime, *DepthShader);
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().CullFace(GL_FRONT);
+        RenderScene(deltaTime, currentTime, *DepthShader, shadowView);
+        Graphics::RenderState::Shared().CullFace(GL_BACK);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
-        glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Graphics::RenderState::Shared().Viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         DebugQuadShader->Use();
         DebugQuadShader->SetFloat("near_plane", near_plane);
         DebugQuadShader->SetFloat("far_plane", far_plane);
-        glActiveTexture(GL_TEXTURE1);
         DebugQuadShader->SetInt("depthMap", 1);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-        glBindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindTexture(1, GL_TEXTURE_2D, depthMapTexture);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, eyePosition);
@@ -150,20 +157,16 @@ public:
         SunModel.Draw(*LightSourceShader);
 
 
-        LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
-        LitShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
+        auto &litShader = LitShaders.Get({.Shadows = true, .AlphaTest = true,
+                                          .MaterialTextures = Sponza->MaterialTextures()});
+        litShader.Use();
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
+        litShader.SetMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-        glActiveTexture(GL_TEXTURE1);
-        LitShader->SetInt("shadowMap", 1);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-        RenderScene(deltaTime, currentTime, *LitShader);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        litShader.SetInt("shadowMap", 1);
+        Graphics::RenderState::Shared().BindTexture(1, GL_TEXTURE_2D, depthMapTexture);
+        RenderScene(deltaTime, currentTime, litShader, view);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 };
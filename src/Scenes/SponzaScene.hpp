@@ -2,10 +2,16 @@
 
 #include "LightCube.hpp"
 #include "Camera.hpp"
+#include "Core/Bvh.hpp"
+#include "Core/OcclusionBuffer.hpp"
 #include "Graphics/Model.hpp"
+#include "Graphics/ShaderVariants.hpp"
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/UniformRing.hpp"
+#include <algorithm>
+#include <array>
+#include <numeric>
 
-#include <sstream>
 
 class SponzaScene {
 public:
@@ -13,10 +19,10 @@ public:
 
     std::shared_ptr<Graphics::Shader> LightSourceShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert", "LightSourceShader.frag");
-    std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
-            "VertexShader.vert", "LitShader.frag");
+    static constexpr std::uint32_t LightCount = 4;
+    Graphics::ShaderVariants LitShaders = Graphics::ShaderVariants("VertexShader.vert", "LitShader.frag");
 
-    LightCube LightCubes[4] = {
+    LightCube LightCubes[LightCount] = {
             LightCube(LightSourceShader, glm::vec3(-50, 50, -50), glm::vec3(0), glm::vec3(30)),
             LightCube(LightSourceShader, glm::vec3(-40, 50, 50), glm::vec3(0), glm::vec3(30)),
             LightCube(LightSourceShader, glm::vec3(55, 50, -50), glm::vec3(0), glm::vec3(30)),
@@ -27,11 +33,40 @@ public:
     float Amplitude = 3.6;
     float Freq = 0.05;
 
+    // Sponza's meshes first, by index, then the light cubes.
+    Core::Bvh SceneBvh;
+    std::vector<std::uint32_t> VisibleProxies;
+    std::vector<std::uint8_t> VisibleMeshes;
+
+    // The largest meshes, drawn at a coarse level into a CPU depth buffer that hides the rest before submission.
+    static constexpr std::size_t OccluderCount = 24;
+    // Occluders use the coarsest level whose error stays within this fraction of the mesh radius, so their
+    // simplified surface cannot hide much that the real one shows.
+    static constexpr float OccluderMaxError = 0.02f;
+    Core::OcclusionBuffer Occlusion;
+    std::vector<std::uint32_t> Occluders;
+
 
     SponzaScene() {
         for (int i = 0; i < sizeof(LightCubes) / sizeof(LightCube); i++) {
             LightCubes[i].Id = "Point Light " + std::to_string(i);
         }
+
+        // Sponza draws untransformed, so its mesh boxes are already in world space.
+        for (const auto &mesh: Sponza.Meshes)
+            SceneBvh.Add({mesh.BoundsMin, mesh.BoundsMax});
+        for (auto &lightCube: LightCubes) {
+            lightCube.Update(0.0f);
+            SceneBvh.Add(lightCube.WorldBounds());
+        }
+        SceneBvh.Build();
+
+        Occluders.resize(Sponza.Meshes.size());
+        std::iota(Occluders.begin(), Occluders.end(), 0u);
+        std::sort(Occluders.begin(), Occluders.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return SceneBvh.ProxyBounds(a).SurfaceArea() > SceneBvh.ProxyBounds(b).SurfaceArea();
+        });
+        Occluders.resize(std::min(Occluders.size(), OccluderCount));
     }
 
     void Show(const float deltaTime, const float currentTime, Camera &camera) {
@@ -53,50 +88,73 @@ public:
         glClearColor(0, 0, 0, 1);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-        LitShader->SetFloat("material.shininess", 32.0f);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
-
-
-        LitShader->SetInt("pointLightCount", sizeof(LightCubes) / sizeof(LightCube));
         const auto offset = glm::sin(2 * glm::pi<float>() * Freq * currentTime) * Amplitude;
-        for (int i = 0; i < sizeof(LightCubes) / sizeof(LightCube); i++) {
+        const auto meshCount = static_cast<std::uint32_t>(Sponza.Meshes.size());
+        std::array<Graphics::PointLightData, LightCount> pointLights{};
+        for (std::uint32_t i = 0; i < LightCount; i++) {
             LightCubes[i].Position.x += offset;
             LightCubes[i].Update(deltaTime);
-            LightCubes[i].Render(*LightSourceShader);
-
-            std::ostringstream name;
-            name << "pointLights[" << i << "].";
-            auto nameStr = name.str();
-
-            LitShader->Use();
-            LitShader->SetVec3(nameStr + "position", LightCubes[i].Position);
-            LitShader->SetVec3(nameStr + "ambient", LightCubes[i].Ambient);
-            LitShader->SetVec3(nameStr + "diffuse", LightCubes[i].Diffuse);
-            LitShader->SetVec3(nameStr + "specular", LightCubes[i].Specular);
-            LitShader->SetFloat(nameStr + "constant", LightCubes[i].Constant);
-            LitShader->SetFloat(nameStr + "linear", LightCubes[i].Linear);
-            LitShader->SetFloat(nameStr + "quadratic", LightCubes[i].Quadratic);
+            SceneBvh.Update(meshCount + i, LightCubes[i].WorldBounds());
+            pointLights[i] = LightCubes[i].Data();
+        }
+        SceneBvh.Refit();
+
+        // Every light still shines; only the cubes marking them are culled.
+        const auto view = Graphics::RenderView::FromCamera(camera);
+        VisibleProxies.clear();
+        SceneBvh.Query(view.Frustum, VisibleProxies);
+        VisibleMeshes.assign(meshCount, 0);
+        for (const auto proxy: VisibleProxies) {
+            if (proxy < meshCount)
+                VisibleMeshes[proxy] = 1;
+            else
+                LightCubes[proxy - meshCount].Render(*LightSourceShader);
         }
+        CullOccluded(camera);
+
+        Graphics::SpotLightData spotLight{};
+        spotLight.Position = camera.Position;
+        spotLight.Direction = camera.Front;
+        spotLight.CutOff = glm::cos(glm::radians(12.5f));
+        spotLight.OuterCutOff = glm::cos(glm::radians(15.0f));
+        spotLight.Constant = 1.0f;
+        spotLight.Linear = 0.09f;
+        spotLight.Quadratic = 0.032f;
+        spotLight.Ambient = glm::vec3(0.0f);
+        spotLight.Diffuse = glm::vec3(1.0f);
+        spotLight.Specular = glm::vec3(1.0f);
+
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{camera.Position, DirectionalLight.Data(), spotLight});
+        uniforms.Bind<Graphics::PointLightData>(Graphics::LightBlock::Binding, pointLights);
+
+        auto &litShader = LitShaders.Get({.SpotLight = true, .AlphaTest = true, .PointLightCount = LightCount,
+                                          .MaterialTextures = Sponza.MaterialTextures()});
+        litShader.Use();
+        constexpr glm::mat4 model = glm::mat4(1.0f);
+        litShader.SetMat4("model", model);
+        Sponza.Draw(litShader, view, model, VisibleMeshes);
+    }
 
-        LitShader->SetVec3("spotLight.position", camera.Position);
-        LitShader->SetVec3("spotLight.direction", camera.Front);
-        LitShader->SetVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        LitShader->SetVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        LitShader->SetVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        LitShader->SetFloat("spotLight.constant", 1.0f);
-        LitShader->SetFloat("spotLight.linear", 0.09f);
-        LitShader->SetFloat("spotLight.quadratic", 0.032f);
-        LitShader->SetFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        LitShader->SetFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+    void CullOccluded(const Camera &camera) {
+        Occlusion.Begin(camera.GetCameraMatrix());
+        for (const auto index: Occluders) {
+            if (!VisibleMeshes[index])
+                continue;
+            const auto &mesh = Sponza.Meshes[index];
+            std::size_t lod = 0;
+            while (lod + 1 < mesh.Lods.size() && mesh.Lods[lod + 1].Error <= OccluderMaxError * mesh.BoundsRadius())
+                lod++;
+            const auto &level = mesh.Lods[lod];
+            Occlusion.AddOccluder(std::span(mesh.Vertices), std::span(mesh.Indices).subspan(level.FirstIndex,
+                                                                                             level.IndexCount),
+                                  glm::mat4(1.0f));
+        }
+        Occlusion.Rasterize();
 
-        constexpr glm::mat4 model = glm::mat4(1.0f);
-        LitShader->SetMat4("model", model);
-        Sponza.Draw(*LitShader);
+        for (std::uint32_t i = 0; i < VisibleMeshes.size(); i++) {
+            if (VisibleMeshes[i] && !Occlusion.IsVisible(SceneBvh.ProxyBounds(i)))
+                VisibleMeshes[i] = 0;
+        }
     }
 };
@@ -2,20 +2,23 @@
 
 #include "LightCube.hpp"
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Floor.hpp"
 #include "Camera.hpp"
 
 
-#include <sstream>
+#include <array>
 #include <memory>
 #include <random>
 
 class WoodFloorWithCubesScene {
 public:
     Core::DirectionalLight DirectionalLight;
+    static constexpr std::uint32_t LightCount = 1;
     std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert",
-            "LitShader.frag"
+            "LitShader.frag",
+            Graphics::ShaderPermutation{.PointLightCount = LightCount}
     );
 
     Floor Floor;
@@ -27,7 +30,7 @@ public:
     std::shared_ptr<Graphics::Shader> LightSourceShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert", "LightSourceShader.frag"
     );
-    LightCube LightCubes[1] = {
+    LightCube LightCubes[LightCount] = {
             LightCube(LightSourceShader, {5, 2, 0})
     };
 
@@ -44,37 +47,20 @@ public:
     void Show(const float deltaTime, [[maybe_unused]] const float currentTime, Camera &camera) {
         DirectionalLight.UIRender();
 
-        LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
-
-        LitShader->SetInt("pointLightCount", sizeof(LightCubes) / sizeof(LightCube));
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
 
         float yoffset = glm::sin(currentTime) * 0.1;
+        std::array<Graphics::PointLightData, LightCount> pointLights{};
         for (int i = 0; i < sizeof(LightCubes) / sizeof(LightCube); i++) {
             LightCubes[i].UIRender();
 
             LightCubes[i].Position.y += yoffset;
             LightCubes[i].Update(deltaTime);
             LightCubes[i].Render(*LightSourceShader);
-
-            std::ostringstream name;
-            name << "pointLights[" << i << "].";
-            auto nameStr = name.str();
-
-            LitShader->Use();
-            LitShader->SetVec3(nameStr + "position", LightCubes[i].Position);
-            LitShader->SetVec3(nameStr + "ambient", LightCubes[i].Ambient);
-            LitShader->SetVec3(nameStr + "diffuse", LightCubes[i].Diffuse);
-            LitShader->SetVec3(nameStr + "specular", LightCubes[i].Specular);
-            LitShader->SetFloat(nameStr + "constant", LightCubes[i].Constant);
-            LitShader->SetFloat(nameStr + "linear", LightCubes[i].Linear);
-            LitShader->SetFloat(nameStr + "quadratic", LightCubes[i].Quadratic);
+            pointLights[i] = LightCubes[i].Data();
         }
+        uniforms.Bind<Graphics::PointLightData>(Graphics::LightBlock::Binding, pointLights);
 
 //        LitShader->SetVec3("spotLight.position", camera.Position);
 //        LitShader->SetVec3("spotLight.direction", camera.Front);
@@ -88,8 +74,9 @@ public:
 //        LitShader->SetFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
 
 
+        LitShader->Use();
         LitShader->SetTexture("material.texture_diffuse1", WoodFloorTexture);
-        LitShader->SetFloat("material.shininess", 2.0f);
+        uniforms.Bind(Graphics::MaterialBlock{2.0f});
         Floor.Update(deltaTime);
         Floor.Render(*LitShader);
     }
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "LightCube.hpp"
+#include "Core/Bvh.hpp"
 #include "Core/DirectionalLight.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Floor.hpp"
 #include "Camera.hpp"
 
@@ -14,7 +18,8 @@ public:
     Core::DirectionalLight DirectionalLight;
     std::shared_ptr<Graphics::Shader> LitShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert",
-            "LitShader.frag"
+            "LitShader.frag",
+            Graphics::ShaderPermutation{.Shadows = true}
     );
 
     Floor Floor;
@@ -22,6 +27,7 @@ public:
             "resources/textures/wood_floor_deck/wood_floor_deck_diff.jpg",
             GL_TEXTURE0, GL_REPEAT, true
     );
+    Graphics::Material WoodFloorMaterial = Graphics::Material({WoodFloorTexture.GetId()}, {}, 2.0f);
 
     std::shared_ptr<Graphics::Shader> LightSourceShader = std::make_shared<Graphics::Shader>(
             "VertexShader.vert", "LightSourceShader.frag"
@@ -31,6 +37,7 @@ public:
     };
 
     Graphics::Model SunModel = Graphics::Model("resources/models/Sun.glb");
+    Graphics::RenderQueue Queue;
 
     Cube Cubes[9] = {
             Cube({3, 3, 0}),
@@ -44,6 +51,10 @@ public:
             Cube({-15, 4.5, 0}),
     };
 
+    // Proxy 0 is the floor and proxy i + 1 is Cubes[i].
+    Core::Bvh SceneBvh;
+    std::vector<std::uint32_t> VisibleProxies;
+
     const unsigned int SHADOW_WIDTH = 2560, SHADOW_HEIGHT = 1440;
     const unsigned int WINDOW_WIDTH = 2560, WINDOW_HEIGHT = 1440;
     unsigned int depthMapFBO{};
@@ -76,10 +87,20 @@ public:
             LightCubes[i].Id = "Point Light " + std::to_string(i);
         }
 
+        Floor.Position.z = round(Floor.Scale.z / 2);
+        Floor.Position.x = round(Floor.Scale.x / 2);
+        Floor.Update(0.0f);
+        SceneBvh.Add(Floor.WorldBounds());
+        for (auto &cube: Cubes) {
+            cube.Update(0.0f);
+            SceneBvh.Add(cube.WorldBounds());
+        }
+        SceneBvh.Build();
+
         glGenFramebuffers(1, &depthMapFBO);
 
         glGenTextures(1, &depthMapTexture);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
+        Graphics::RenderState::Shared().BindTexture(GL_TEXTURE_2D, depthMapTexture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT,
                      nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -89,16 +110,16 @@ public:
         float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
         glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMapTexture, 0);
         glDrawBuffer(GL_NONE);
         glReadBuffer(GL_NONE);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
         glGenVertexArrays(1, &ScreenVAO);
         glGenBuffers(1, &ScreenVBO);
-        glBindVertexArray(ScreenVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindBuffer(GL_ARRAY_BUFFER, ScreenVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(ScreenVertices), &ScreenVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), nullptr);
@@ -106,24 +127,54 @@ public:
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) (3 * sizeof(float)));
     }
 
-    void RenderScene(float deltaTime, [[maybe_unused]]float currentTime, Graphics::Shader &shader) {
-        shader.Use();
+    // Updates the entities once, refits the hierarchy to where they moved and queues what the camera sees for the
+    // opaque pass and what the light sees for the shadow pass.
+    void SubmitScene(float deltaTime, float currentTime, glm::vec3 eye, const Core::Frustum &cameraFrustum,
+                     const Core::Frustum &lightFrustum) {
+        for (std::uint32_t i = 0; i < sizeof(Cubes) / sizeof(Cube); ++i) {
+            Cubes[i].Position.z += glm::sin(currentTime * 0.2 + i) * 0.02;
+            Cubes[i].Update(deltaTime);
+            SceneBvh.Update(i + 1, Cubes[i].WorldBounds());
+        }
+        SceneBvh.Refit();
+
+        Queue.Reset(eye);
+        VisibleProxies.clear();
+        SceneBvh.Query(lightFrustum, VisibleProxies);
+        for (const auto proxy: VisibleProxies) {
+            auto packet = PacketOf(proxy);
+            packet.Pass = Graphics::RenderPass::Shadow;
+            packet.Program = DepthShader.get();
+            Queue.Submit(packet);
+        }
 
-        shader.SetTexture("material.texture_diffuse1", WoodFloorTexture);
-        shader.SetFloat("material.shininess", 2.0f);
-        Floor.Position.z = round(Floor.Scale.z / 2);
-        Floor.Position.x = round(Floor.Scale.x / 2);
-        Floor.Update(deltaTime);
-        Floor.Render(shader);
+        VisibleProxies.clear();
+        SceneBvh.Query(cameraFrustum, VisibleProxies);
+        for (const auto proxy: VisibleProxies) {
+            auto packet = PacketOf(proxy);
+            packet.Pass = Graphics::RenderPass::Opaque;
+            packet.Program = LitShader.get();
+            packet.Material = &WoodFloorMaterial;
+            Queue.Submit(packet);
+        }
+    }
 
-        shader.SetTexture("material.texture_diffuse1", WoodFloorTexture);
-        shader.SetFloat("material.shininess", 2.0f);
+    [[nodiscard]] Graphics::DrawPacket PacketOf(std::uint32_t proxy) const {
+        return proxy == 0 ? Floor.Packet() : Cubes[proxy - 1].Packet();
+    }
 
-        for (int i = 0; i < sizeof(Cubes) / sizeof(Cube); ++i) {
-            Cubes[i].Position.z += glm::sin(currentTime * 0.2 + i) * 0.01;
-            Cubes[i].Update(deltaTime);
-            Cubes[i].Render(shader);
-        }
+    // Names the entity under the screen center, through the hierarchy.
+    void ShowPicked(const Camera &camera) const {
+        const auto ray = Core::Ray::FromScreen(glm::inverse(camera.GetCameraMatrix()), glm::vec2(0.0f));
+        const auto hit = SceneBvh.Raycast(ray);
+        ImGui::Begin("Picking");
+        if (!hit)
+            ImGui::Text("Looking at nothing");
+        else if (hit->Proxy == 0)
+            ImGui::Text("Looking at the floor, %.1f units away", hit->Distance);
+        else
+            ImGui::Text("Looking at cube %u, %.1f units away", hit->Proxy - 1, hit->Distance);
+        ImGui::End();
     }
 
     void Show(const float deltaTime, [[maybe_unused]] const float currentTime, Camera &camera) {
@@ -146,32 +197,34 @@ public:
         glm::mat4 lightView = glm::lookAt(eyePosition, glm::vec3(0), glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 lightSpaceMatrix = lightProjection * lightView;
 
+        SubmitScene(deltaTime, currentTime, camera.Position, Core::Frustum::FromMatrix(camera.GetCameraMatrix()),
+                    Core::Frustum::FromMatrix(lightSpaceMatrix));
+        ShowPicked(camera);
+
         DepthShader->Use();
         DepthShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        Graphics::RenderState::Shared().Viewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glClear(GL_DEPTH_BUFFER_BIT);
-        glCullFace(GL_FRONT);
-        RenderScene(deltaTime, currentTime, *DepthShader);
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().CullFace(GL_FRONT);
+        Queue.Execute(Graphics::RenderPass::Shadow);
+        Graphics::RenderState::Shared().CullFace(GL_BACK);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 // 2. then render scene as normal with shadow mapping (using depth map)
-        glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Graphics::RenderState::Shared().Viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         DebugQuadShader->Use();
         DebugQuadShader->SetFloat("near_plane", near_plane);
         DebugQuadShader->SetFloat("far_plane", far_plane);
-        glActiveTexture(GL_TEXTURE1);
         DebugQuadShader->SetInt("depthMap", 1);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-        glBindVertexArray(ScreenVAO);
+        Graphics::RenderState::Shared().BindTexture(1, GL_TEXTURE_2D, depthMapTexture);
+        Graphics::RenderState::Shared().BindVertexArray(ScreenVAO);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
 
-        glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Graphics::RenderState::Shared().Viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 //        glClear(GL_COLOR_BUFFER_BIT);
 
         glm::mat4 model = glm::mat4(1.0f);
@@ -181,12 +234,8 @@ public:
         SunModel.Draw(*LightSourceShader);
 
         LitShader->Use();
-        LitShader->SetVec3("cameraPos", camera.Position);
-
-        LitShader->SetVec3("dirLight.direction", DirectionalLight.Direction);
-        LitShader->SetVec3("dirLight.ambient", DirectionalLight.Ambient);
-        LitShader->SetVec3("dirLight.diffuse", DirectionalLight.Diffuse);
-        LitShader->SetVec3("dirLight.specular", DirectionalLight.Specular);
+        auto &uniforms = Graphics::UniformRing::Shared();
+        uniforms.Bind(Graphics::FrameBlock{.CameraPosition = camera.Position, .DirLight = DirectionalLight.Data()});
         LitShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
 
 //        LitShader->SetInt("pointLightCount", sizeof(LightCubes) / sizeof(LightCube));
@@ -224,10 +273,9 @@ public:
 //        LitShader->SetFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
 //        LitShader->SetFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
 
-        glActiveTexture(GL_TEXTURE1);
         LitShader->SetInt("shadowMap", 1);
-        glBindTexture(GL_TEXTURE_2D, depthMapTexture);
-        RenderScene(deltaTime, currentTime, *LitShader);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Graphics::RenderState::Shared().BindTexture(1, GL_TEXTURE_2D, depthMapTexture);
+        Queue.Execute(Graphics::RenderPass::Opaque);
+        Graphics::RenderState::Shared().BindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 };
@@ -6,6 +6,13 @@
 #include "backends/imgui_impl_opengl3.h"
 #include "Camera.hpp"
 #include "Core/DirectionalLight.hpp"
+#include "Core/Scheduler.hpp"
+#include "FileSystem.hpp"
+#include "PackArchive.hpp"
+#include "Graphics/GLExtensions.hpp"
+#include "Graphics/Model.hpp"
+#include "Graphics/RenderState.hpp"
+#include "Graphics/UniformRing.hpp"
 #include "Scenes/DenseGrassScene.hpp"
 #include "Scenes/SemiTransparentTexturesScene.hpp"
 #include "Scenes/FramebufferScene.hpp"
@@ -20,6 +27,7 @@
 
 #include <memory>
 #include <sstream>
+#include <utility>
 
 constexpr int WINDOW_WIDTH = 2560, WINDOW_HEIGHT = 1440;
 auto MainCamera = Camera(glm::vec3(0, 15, -15));
@@ -31,7 +39,7 @@ void GLFWWindowDeleter(GLFWwindow *window) {
 }
 
 void FramebufferSizeCallback([[maybe_unused]] GLFWwindow *windowPtr, const int width, const int height) {
-    glViewport(0, 0, width, height);
+    Graphics::RenderState::Shared().Viewport(0, 0, width, height);
 }
 
 void HandleInputCallback(GLFWwindow *windowPtr, const int key, [[maybe_unused]] int scanCode, const int action,
@@ -48,18 +56,24 @@ void HandleInputCallback(GLFWwindow *windowPtr, const int key, [[maybe_unused]]
 
 std::shared_ptr<GLFWwindow> CreateWindow() {
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_SAMPLES, 4);
 
-    GLFWwindow *windowPtr = glfwCreateWindow(
-            WINDOW_WIDTH,
-            WINDOW_HEIGHT,
-            "Caruti Engine",
-            nullptr,
-            nullptr
-    );
+    // Compute culling needs 4.3; older drivers get the newest context they accept and cull on the CPU.
+    GLFWwindow *windowPtr = nullptr;
+    for (const auto &[major, minor]: {std::pair{4, 6}, std::pair{4, 5}, std::pair{4, 3}, std::pair{4, 2}}) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+        windowPtr = glfwCreateWindow(
+                WINDOW_WIDTH,
+                WINDOW_HEIGHT,
+                "Caruti Engine",
+                nullptr,
+                nullptr
+        );
+        if (windowPtr != nullptr)
+            break;
+    }
 
     if (windowPtr == nullptr) {
         Log::Error("Failed to create GLFW window");
@@ -73,11 +87,12 @@ std::shared_ptr<GLFWwindow> CreateWindow() {
         Log::Error("Failed to init GLAD");
         exit(-1);
     }
+    Graphics::GLExtensions::Load(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    Graphics::RenderState::Shared().Viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     glfwSetFramebufferSizeCallback(window.get(), FramebufferSizeCallback);
     glfwSetKeyCallback(window.get(), HandleInputCallback);
-    glEnable(GL_DEPTH_TEST);
+    Graphics::RenderState::Shared().Enable(GL_DEPTH_TEST);
     //    glDepthFunc(GL_LESS);
     //    glEnable(GL_MULTISAMPLE);
 
@@ -136,10 +151,26 @@ void ShowFPS() {
     auto framerate = ImGui::GetIO().Framerate;
     ImGui::Begin("FPS", nullptr, fpsWindowFlags);
     ImGui::Text("%.1d fps %.3f ms/frame", (int) framerate, 1 / framerate * 1000);
+    auto &state = Graphics::RenderState::Shared();
+    const auto counters = state.Counters();
+    ImGui::Text("%llu state calls, %llu elided", static_cast<unsigned long long>(counters.Issued),
+                static_cast<unsigned long long>(counters.Elided));
+    state.ResetCounters();
+    const auto culling = Graphics::Model::CullCounters();
+    ImGui::Text("%llu meshes drawn, %llu culled", static_cast<unsigned long long>(culling.Visible),
+                static_cast<unsigned long long>(culling.Culled));
+    Graphics::Model::ResetCullCounters();
     ImGui::End();
 }
 
 int main() {
+    // Packed builds read resources from a single mapping. A loose resources directory is mounted over it, so
+    // edited files win and the pack serves everything else.
+    if (auto pack = PackArchive::Load("resources.cpak")) {
+        FileSystem::Shared().Mount("resources/", std::move(pack));
+        FileSystem::Shared().Mount("resources/", std::make_shared<const DirectorySource>("resources"));
+    }
+
     const auto window = CreateWindow();
 
 //     SponzaScene sponzaScene{};
@@ -156,7 +187,7 @@ int main() {
 
     unsigned int matricesUBO, matricesBindingPort = 0;
     glGenBuffers(1, &matricesUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+    Graphics::RenderState::Shared().BindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
     glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_UNIFORM_BUFFER, matricesBindingPort, matricesUBO);
     glBufferSubData(
@@ -165,7 +196,6 @@ int main() {
             sizeof(glm::mat4),
             glm::value_ptr(Camera::GetProjectionMatrix())
     );
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
     float lastTime = glfwGetTime();
 
@@ -184,9 +214,11 @@ int main() {
 
         HandleInput(window, MainCamera, deltaTime);
 
-        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+        Core::Scheduler::Pump();
+        Graphics::UniformRing::Shared().BeginFrame();
+
+        Graphics::RenderState::Shared().BindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(MainCamera.GetViewMatrix()));
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
         glClearColor(0, 0, 0, 1);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -204,6 +236,9 @@ int main() {
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        // The ImGui backend sets and restores GL state directly.
+        Graphics::RenderState::Shared().Invalidate();
+        Graphics::UniformRing::Shared().EndFrame();
 
         glfwPollEvents();
         glfwSwapBuffers(window.get());
@@ -0,0 +1,255 @@
+// Rasterizes random occluders and checks OcclusionBuffer against a brute-force reference that tests every triangle
+// at every pixel center, then compares the boxes both call visible. Runs inline and on a pool, which must agree.
+#include "Core/OcclusionBuffer.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    struct Vertex {
+        glm::vec3 Position;
+    };
+
+    struct ReferenceTriangle {
+        glm::vec3 V0, V1, V2;
+    };
+
+    // The same pixel mapping, near clipping and plane setup as OcclusionBuffer, without bands, bins or lanes.
+    class ReferenceBuffer {
+    public:
+        ReferenceBuffer(int width, int height, const glm::mat4 &viewProjection)
+                : _width(width), _height(height), _viewProjection(viewProjection),
+                  _depth(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 0.0f) {}
+
+        void AddOccluder(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                         const glm::mat4 &model) {
+            const auto matrix = _viewProjection * model;
+            for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+                const std::array<glm::vec4, 3> clip = {
+                        matrix * glm::vec4(vertices[indices[i]].Position, 1.0f),
+                        matrix * glm::vec4(vertices[indices[i + 1]].Position, 1.0f),
+                        matrix * glm::vec4(vertices[indices[i + 2]].Position, 1.0f)
+                };
+                std::vector<glm::vec4> polygon;
+                for (std::size_t j = 0; j < 3; j++) {
+                    const auto &current = clip[j];
+                    const auto &next = clip[(j + 1) % 3];
+                    const float currentDistance = current.z + current.w;
+                    const float nextDistance = next.z + next.w;
+                    if (currentDistance >= 0.0f)
+                        polygon.push_back(current);
+                    if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                        polygon.push_back(glm::mix(current, next, currentDistance / (currentDistance - nextDistance)));
+                }
+                for (std::size_t j = 2; j < polygon.size(); j++) {
+                    if (polygon[0].w > 0.0f && polygon[j - 1].w > 0.0f && polygon[j].w > 0.0f)
+                        _triangles.push_back({ToScreen(polygon[0]), ToScreen(polygon[j - 1]), ToScreen(polygon[j])});
+                }
+            }
+        }
+
+        void Rasterize() {
+            for (int y = 0; y < _height; y++) {
+                for (int x = 0; x < _width; x++) {
+                    for (const auto &triangle: _triangles)
+                        RasterizePixel(triangle, x, y);
+                }
+            }
+        }
+
+        [[nodiscard]] bool IsVisible(const Core::Bounds &bounds) const {
+            glm::vec2 screenMin(std::numeric_limits<float>::max());
+            glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+            float nearest = 0.0f;
+            for (int corner = 0; corner < 8; corner++) {
+                const glm::vec3 point(corner & 1 ? bounds.Max.x : bounds.Min.x,
+                                      corner & 2 ? bounds.Max.y : bounds.Min.y,
+                                      corner & 4 ? bounds.Max.z : bounds.Min.z);
+                const auto clip = _viewProjection * glm::vec4(point, 1.0f);
+                if (clip.z < -clip.w || clip.w <= 0.0f)
+                    return true;
+                const auto screen = ToScreen(clip);
+                screenMin = glm::min(screenMin, glm::vec2(screen));
+                screenMax = glm::max(screenMax, glm::vec2(screen));
+                nearest = std::max(nearest, screen.z);
+            }
+
+            for (int y = 0; y < _height; y++) {
+                for (int x = 0; x < _width; x++) {
+                    const bool touched = static_cast<float>(x + 1) > screenMin.x &&
+                                         static_cast<float>(x) <= screenMax.x &&
+                                         static_cast<float>(y + 1) > screenMin.y &&
+                                         static_cast<float>(y) <= screenMax.y;
+                    if (touched && Depth(x, y) <= nearest)
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] float Depth(int x, int y) const {
+            return _depth[static_cast<std::size_t>(y) * static_cast<std::size_t>(_width) + static_cast<std::size_t>(x)];
+        }
+
+    private:
+        int _width;
+        int _height;
+        glm::mat4 _viewProjection;
+        std::vector<float> _depth;
+        std::vector<ReferenceTriangle> _triangles;
+
+        [[nodiscard]] glm::vec3 ToScreen(glm::vec4 clip) const {
+            const float inverseW = 1.0f / clip.w;
+            return {(clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(_width),
+                    (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(_height),
+                    inverseW};
+        }
+
+        void RasterizePixel(ReferenceTriangle triangle, int x, int y) {
+            auto &[v0, v1, v2] = triangle;
+            float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+            if (area == 0.0f || !std::isfinite(area))
+                return;
+            if (area < 0.0f) {
+                std::swap(v1, v2);
+                area = -area;
+            }
+
+            const float centerX = static_cast<float>(x) + 0.5f;
+            const float centerY = static_cast<float>(y) + 0.5f;
+            const std::array<glm::vec3, 3> vertices = {v0, v1, v2};
+            for (std::size_t i = 0; i < 3; i++) {
+                const auto &from = vertices[i];
+                const auto &to = vertices[(i + 1) % 3];
+                const float a = from.y - to.y;
+                const float b = to.x - from.x;
+                const float c = -(a * from.x + b * from.y);
+                if (a * centerX + (b * centerY + c) < 0.0f)
+                    return;
+            }
+            const float depthX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+            const float depthY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+            const float depthZ = v0.z - depthX * v0.x - depthY * v0.y;
+            auto &pixel = _depth[static_cast<std::size_t>(y) * static_cast<std::size_t>(_width) +
+                                 static_cast<std::size_t>(x)];
+            pixel = std::max(pixel, depthX * centerX + (depthY * centerY + depthZ));
+        }
+    };
+
+    int failures = 0;
+
+    void Expect(bool condition, const char *what) {
+        if (!condition) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    std::vector<bool> VisibleSet(const auto &buffer, const std::vector<Core::Bounds> &boxes) {
+        std::vector<bool> visible;
+        visible.reserve(boxes.size());
+        for (const auto &box: boxes)
+            visible.push_back(buffer.IsVisible(box));
+        return visible;
+    }
+
+    void RunScene(unsigned int seed, Core::ThreadPool &pool) {
+        constexpr int width = 157;
+        constexpr int height = 93;
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        const auto viewProjection = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / height,
+                                                     0.5f, 200.0f) *
+                                    glm::lookAt(glm::vec3(0.0f, 2.0f, 12.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+
+        // Occluder soups spread through the view, some reaching past the camera to exercise near clipping, with
+        // enough triangles in total for the pool to take bands.
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        for (int i = 0; i < 400; i++) {
+            const glm::vec3 center(unit(random) * 10.0f, unit(random) * 6.0f, unit(random) * 12.0f);
+            const float size = 0.5f + 3.0f * (unit(random) * 0.5f + 0.5f);
+            for (int corner = 0; corner < 3; corner++) {
+                indices.push_back(static_cast<unsigned int>(vertices.size()));
+                vertices.push_back({center + size * glm::vec3(unit(random), unit(random), unit(random))});
+            }
+        }
+        const auto model = glm::rotate(glm::mat4(1.0f), 0.3f, glm::vec3(0, 1, 0));
+
+        std::vector<Core::Bounds> boxes;
+        for (int i = 0; i < 600; i++) {
+            const glm::vec3 center(unit(random) * 14.0f, unit(random) * 8.0f, unit(random) * 20.0f - 6.0f);
+            const glm::vec3 extent = 0.05f + 1.5f * glm::abs(glm::vec3(unit(random), unit(random), unit(random)));
+            boxes.push_back({center - extent, center + extent});
+        }
+
+        ReferenceBuffer reference(width, height, viewProjection);
+        reference.AddOccluder(vertices, indices, model);
+        reference.Rasterize();
+        const auto expected = VisibleSet(reference, boxes);
+
+        Core::OcclusionBuffer inlined(width, height);
+        inlined.Begin(viewProjection);
+        inlined.AddOccluder<Vertex>(vertices, indices, model);
+        inlined.Rasterize(nullptr);
+
+        Core::OcclusionBuffer pooled(width, height);
+        pooled.Begin(viewProjection);
+        pooled.AddOccluder<Vertex>(vertices, indices, model);
+        pooled.Rasterize(&pool);
+
+        int depthMismatches = 0;
+        int covered = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                depthMismatches += inlined.Depth(x, y) != reference.Depth(x, y);
+                depthMismatches += pooled.Depth(x, y) != reference.Depth(x, y);
+                covered += reference.Depth(x, y) > 0.0f;
+            }
+        }
+        Expect(depthMismatches == 0, "depth matches the reference at every pixel");
+        Expect(covered > 0 && covered < width * height, "the scene covers part of the screen");
+
+        const auto inlineVisible = VisibleSet(inlined, boxes);
+        const auto pooledVisible = VisibleSet(pooled, boxes);
+        Expect(inlineVisible == expected, "inline visible set matches the reference");
+        Expect(pooledVisible == expected, "pooled visible set matches the reference");
+
+        const auto visibleCount = std::count(expected.begin(), expected.end(), true);
+        Expect(visibleCount > 0 && visibleCount < static_cast<long>(boxes.size()), "some boxes are culled");
+    }
+
+    // A box straight behind a wall is hidden, one in front of it and one beside it are not.
+    void RunWall() {
+        const auto viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+                                    glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+        const std::vector<Vertex> wall = {{{-3, -3, 0}}, {{3, -3, 0}}, {{3, 3, 0}}, {{-3, 3, 0}}};
+        const std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+
+        Core::OcclusionBuffer buffer;
+        buffer.Begin(viewProjection);
+        buffer.AddOccluder<Vertex>(wall, indices, glm::mat4(1.0f));
+        buffer.Rasterize(nullptr);
+
+        Expect(!buffer.IsVisible({{-1, -1, -4}, {1, 1, -2}}), "a box behind the wall is hidden");
+        Expect(buffer.IsVisible({{-1, -1, 2}, {1, 1, 4}}), "a box in front of the wall is visible");
+        Expect(buffer.IsVisible({{6, -1, -4}, {8, 1, -2}}), "a box beside the wall is visible");
+        Expect(buffer.IsVisible({{-1, -1, 9}, {1, 1, 11}}), "a box crossing the near plane is visible");
+        Expect(!buffer.IsVisible({}), "an empty box is not visible");
+    }
+}
+
+int main() {
+    Core::ThreadPool pool(3);
+    for (unsigned int seed = 1; seed <= 8; seed++)
+        RunScene(seed, pool);
+    RunWall();
+
+    if (failures != 0)
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
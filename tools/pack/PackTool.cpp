@@ -0,0 +1,193 @@
+#include "File.hpp"
+#include "Log.hpp"
+#include "PackArchive.hpp"
+#include "Core/Lz4.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Packs a resource directory: caruti_pack [--compression none|lz4] <source directory> <pack file>
+
+namespace {
+    // Compressed entries must save at least this fraction, otherwise they are stored.
+    constexpr double MinSaving = 0.1;
+
+    // Already compressed formats are stored without trying.
+    constexpr std::array StoredExtensions = {".png", ".jpg", ".jpeg"};
+
+    // Within a directory, files are laid out in the order a load touches them: the source mesh, its .mtl or .bin,
+    // then the textures it names.
+    int LoadRank(const std::filesystem::path &path) {
+        const auto extension = path.extension().string();
+        if (extension == ".obj" || extension == ".gltf" || extension == ".glb" || extension == ".fbx")
+            return 0;
+        if (extension == ".mtl" || extension == ".bin")
+            return 1;
+        return 2;
+    }
+
+    struct SourceFile {
+        std::filesystem::path Path;
+        std::string Name;
+    };
+
+    std::uint64_t Align(std::uint64_t offset) {
+        return (offset + PackFormat::Alignment - 1) & ~static_cast<std::uint64_t>(PackFormat::Alignment - 1);
+    }
+
+    bool Verify(const std::string &packPath, const std::vector<SourceFile> &files) {
+        const auto pack = PackArchive::Load(packPath);
+        if (!pack || pack->Entries().size() != files.size())
+            return false;
+        for (const auto &file: files) {
+            const MappedFile source(file.Path.string());
+            const auto packed = pack->Open(file.Name);
+            if (!packed.IsOpen() || packed.Data().size() != source.Data().size() ||
+                !std::equal(packed.Data().begin(), packed.Data().end(), source.Data().begin())) {
+                Log::Error("PACK::VERIFY_FAILED {}", file.Name);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    auto compression = PackFormat::Codec::Lz4;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--compression") == 0 && i + 1 < argc) {
+            const std::string codec = argv[++i];
+            if (codec == "none") {
+                compression = PackFormat::Codec::None;
+            } else if (codec != "lz4") {
+                Log::Error("PACK::UNKNOWN_CODEC {}", codec);
+                return 1;
+            }
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.size() != 2) {
+        Log::Error("Usage: caruti_pack [--compression none|lz4] <source directory> <pack file>");
+        return 1;
+    }
+
+    const std::filesystem::path root = arguments[0];
+    const auto &packPath = arguments[1];
+    std::vector<SourceFile> files;
+    std::error_code error;
+    for (const auto &item: std::filesystem::recursive_directory_iterator(root, error)) {
+        if (item.is_regular_file())
+            files.push_back({item.path(), item.path().lexically_relative(root).generic_string()});
+    }
+    if (error) {
+        const auto directory = root.string();
+        Log::Error("PACK::READ_FAILED {}", directory);
+        return 1;
+    }
+
+    std::sort(files.begin(), files.end(), [](const SourceFile &a, const SourceFile &b) {
+        const auto directoryA = a.Path.parent_path().generic_string();
+        const auto directoryB = b.Path.parent_path().generic_string();
+        if (directoryA != directoryB)
+            return directoryA < directoryB;
+        const auto rankA = LoadRank(a.Path);
+        const auto rankB = LoadRank(b.Path);
+        return rankA != rankB ? rankA < rankB : a.Name < b.Name;
+    });
+
+    std::ofstream out(packPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        Log::Error("PACK::WRITE_FAILED {}", packPath);
+        return 1;
+    }
+    const auto writeAt = [&out](std::uint64_t offset, const void *source, std::size_t size) {
+        static constexpr char padding[PackFormat::Alignment]{};
+        const auto position = static_cast<std::uint64_t>(out.tellp());
+        out.write(padding, static_cast<std::streamsize>(offset - position));
+        out.write(static_cast<const char *>(source), static_cast<std::streamsize>(size));
+    };
+
+    PackFormat::Header header{};
+    header.Magic = PackFormat::Magic;
+    header.Version = PackFormat::Version;
+    header.EntryCount = static_cast<std::uint32_t>(files.size());
+    writeAt(0, &header, sizeof(header));
+
+    std::vector<PackFormat::Entry> entries;
+    entries.reserve(files.size());
+    std::string names;
+    std::uint64_t offset = Align(sizeof(header));
+    std::uint64_t totalSize = 0;
+    for (const auto &file: files) {
+        const MappedFile source(file.Path.string());
+        const auto data = source.Data();
+
+        PackFormat::Entry entry{};
+        entry.PathHash = PackFormat::HashPath(file.Name);
+        entry.Offset = offset;
+        entry.Size = data.size();
+        entry.StoredSize = data.size();
+        entry.NameOffset = static_cast<std::uint32_t>(names.size());
+        entry.NameLength = static_cast<std::uint32_t>(file.Name.size());
+        names += file.Name;
+
+        const auto extension = file.Path.extension().string();
+        const bool tryCompression = compression == PackFormat::Codec::Lz4 && !data.empty() &&
+                                    std::find(StoredExtensions.begin(), StoredExtensions.end(), extension) ==
+                                    StoredExtensions.end();
+        std::vector<std::byte> compressed;
+        if (tryCompression) {
+            compressed = Core::Lz4::Compress(data);
+            if (static_cast<double>(compressed.size()) <= static_cast<double>(data.size()) * (1.0 - MinSaving)) {
+                entry.Compression = PackFormat::Codec::Lz4;
+                entry.StoredSize = compressed.size();
+            }
+        }
+        if (entry.Compression == PackFormat::Codec::Lz4)
+            writeAt(offset, compressed.data(), compressed.size());
+        else
+            writeAt(offset, data.data(), data.size());
+
+        offset = Align(offset + entry.StoredSize);
+        totalSize += entry.Size;
+        entries.push_back(entry);
+    }
+
+    header.BucketCount = 1;
+    while (header.BucketCount < entries.size() * 2)
+        header.BucketCount <<= 1;
+    std::vector<std::uint32_t> buckets(header.BucketCount, 0);
+    for (std::uint32_t i = 0; i < entries.size(); i++) {
+        auto bucket = entries[i].PathHash & (header.BucketCount - 1);
+        while (buckets[bucket] != 0)
+            bucket = (bucket + 1) & (header.BucketCount - 1);
+        buckets[bucket] = i + 1;
+    }
+
+    header.EntriesOffset = offset;
+    header.BucketsOffset = Align(header.EntriesOffset + entries.size() * sizeof(PackFormat::Entry));
+    header.NamesOffset = Align(header.BucketsOffset + buckets.size() * sizeof(std::uint32_t));
+    header.NamesSize = names.size();
+    writeAt(header.EntriesOffset, entries.data(), entries.size() * sizeof(PackFormat::Entry));
+    writeAt(header.BucketsOffset, buckets.data(), buckets.size() * sizeof(std::uint32_t));
+    writeAt(header.NamesOffset, names.data(), names.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out.good()) {
+        Log::Error("PACK::WRITE_FAILED {}", packPath);
+        return 1;
+    }
+
+    if (!Verify(packPath, files))
+        return 1;
+    Log::Information(fmt::format("PACK {} entries {} bytes {} -> {}", packPath, entries.size(), totalSize,
+                                 header.NamesOffset + header.NamesSize));
+    return 0;
+}